@@ -1,25 +1,72 @@
 #include "camera_setting.h"
 #include "color_detection.hpp"
 #include "iic_data_send.hpp"
+#include "spi_data_send.hpp"
+#include "stream_server.hpp"
+#include "fps_stat.h"
+#include "power_governor.hpp"
+#include "deferred_log.hpp"
+#include <WiFi.h>
+
+/* 1: 结果通过SPI帧发送（Arduino端 hw_esp32cam_ctl.h 中 ESP32CAM_USE_SPI 也要设为1）  0: IIC寄存器 */
+#define RESULT_USE_SPI 0
+/* 1: 开启WiFi热点，在 http://192.168.5.1:81/stream 推送检测用的画面（与图像回传固件地址相同），http://192.168.5.1/status 为各任务帧率 */
+#define STREAM_ENABLE 0
+#define STREAM_SSID "uHand-ESP32Cam"
+#define STREAM_PASSWORD ""
+/* 1: 画面长时间不变时降低CPU频率、摄像头帧率和检测频率 */
+#define POWER_GOVERNOR_ENABLE 1
 
 static QueueHandle_t xQueueAIFrame = NULL;
 static QueueHandle_t xQueueIICData = NULL;
+static QueueHandle_t xQueueStreamFrame = NULL;
+static dlog_tag_t LOG_FPS = DLOG_TAG("fps", DLOG_INFO, 0);
 
 void setup() {
+  Serial.begin(115200);
+  /* 注册日志输出任务，各任务的日志在核心0上输出，不阻塞检测 */
+  register_deferred_log();
   /* 创建图像传输队列 */
   xQueueAIFrame = xQueueCreate(2, sizeof(camera_fb_t *)); 
   /* 创建IIC数据传输队列 */
-  xQueueIICData = xQueueCreate(2, sizeof(send_color_data_t *) * COLOR_NUM);
+  xQueueIICData = xQueueCreate(2, sizeof(color_result_t));
 
-  /* 注册摄像头处理任务 */
+  /* 注册摄像头处理任务，也可用PIXFORMAT_JPEG采集，检测任务会逐块解码到固定缓冲 */
   register_camera(PIXFORMAT_RGB565, FRAMESIZE_240X240, 4, xQueueAIFrame);
+#if POWER_GOVERNOR_ENABLE
+  /* 注册功耗调节任务 */
+  register_power_governor(xQueueAIFrame);
+#endif
+#if STREAM_ENABLE
+  /* 推流队列长度为1，检测任务不等待推流 */
+  xQueueStreamFrame = xQueueCreate(1, sizeof(camera_fb_t *));
+  WiFi.softAPConfig(IPAddress(192, 168, 5, 1), IPAddress(192, 168, 5, 1), IPAddress(255, 255, 255, 0));
+  WiFi.softAP(STREAM_SSID, STREAM_PASSWORD);
+  /* 注册推流任务 */
+  register_stream_server(xQueueStreamFrame, true);
+#endif
   /* 注册人脸检测任务 */
-  register_color_detection(xQueueAIFrame, NULL, xQueueIICData, NULL, true);
+  register_color_detection(xQueueAIFrame, NULL, xQueueIICData, xQueueStreamFrame, true);
+#if RESULT_USE_SPI
+  /* 注册SPI数据传输任务 */
+  register_spi_data_send(xQueueIICData, NULL);
+#else
   /* 注册IIC数据传输任务 */
   register_iic_data_send(xQueueIICData, NULL);
+#endif
 
 }
 
 void loop() 
 {
+  /* 每2秒打印一次各任务帧率 */
+  delay(2000);
+  fps_stat_update();
+  char line[128];
+  int len = 0;
+  for (int i = 0; i < FPS_STAT_NUM; ++i)
+  {
+    len += snprintf(line + len, sizeof(line) - len, " %s:%.1f", fps_stat_name((fps_stat_id_t)i), fps_stat_rate((fps_stat_id_t)i));
+  }
+  DLOG_I(&LOG_FPS, "%s", line);
 }
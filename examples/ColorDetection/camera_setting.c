@@ -1,11 +1,73 @@
 #include "camera_setting.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "esp_timer.h"
+#include "fps_stat.h"
 
 static const char *TAG = "camera";
 
 static QueueHandle_t xQueueFrameO = NULL;
 
+/* 帧缓冲循环使用，按 camera_fb_t 指针记录每一帧的追踪信息 */
+#define TRACE_SLOT_NUM 8
+static struct
+{
+    const camera_fb_t *frame;
+    frame_trace_t trace;
+} trace_slots[TRACE_SLOT_NUM];
+static uint16_t frame_seq = 0;
+
+static void frame_trace_set(const camera_fb_t *frame)
+{
+    static int next = 0;
+    int slot = -1;
+    for (int i = 0; i < TRACE_SLOT_NUM; ++i)
+    {
+        if (trace_slots[i].frame == frame)
+        {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0)
+    {
+        slot = next;
+        next = (next + 1) % TRACE_SLOT_NUM;
+    }
+    /* 序号跳过0，0表示未知 */
+    if (++frame_seq == 0)
+    {
+        frame_seq = 1;
+    }
+    trace_slots[slot].frame = frame;
+    trace_slots[slot].trace.seq = frame_seq;
+    trace_slots[slot].trace.capture_us = (int64_t)frame->timestamp.tv_sec * 1000000 + frame->timestamp.tv_usec;
+}
+
+void camera_frame_trace(const camera_fb_t *frame, frame_trace_t *trace)
+{
+    for (int i = 0; i < TRACE_SLOT_NUM; ++i)
+    {
+        if (trace_slots[i].frame == frame)
+        {
+            *trace = trace_slots[i].trace;
+            return;
+        }
+    }
+    trace->seq = 0;
+    trace->capture_us = esp_timer_get_time();
+}
+
+bool camera_set_xclk(int xclk_hz)
+{
+    sensor_t *s = esp_camera_sensor_get();
+    if (!s || !s->set_xclk)
+    {
+        return false;
+    }
+    return s->set_xclk(s, LEDC_TIMER_0, xclk_hz / 1000000) == 0;
+}
+
 static void task_process_handler(void *arg)
 {
     while (true)
@@ -13,6 +75,8 @@ static void task_process_handler(void *arg)
         camera_fb_t *frame = esp_camera_fb_get();
         if (frame)
         {
+            frame_trace_set(frame);
+            fps_stat_tick(FPS_CAMERA);
             xQueueSend(xQueueFrameO, &frame, portMAX_DELAY);
         }
     }
@@ -329,6 +329,13 @@
 
 #define XCLK_FREQ_HZ 15000000
 
+/* 帧追踪信息：采集任务为每一帧分配序号，后续各阶段据此统计延时 */
+typedef struct
+{
+    uint16_t seq;       /* 帧序号 */
+    int64_t capture_us; /* 采集时间 (esp_timer_get_time) */
+} frame_trace_t;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -375,6 +382,22 @@ extern "C"
                          const uint8_t fb_count,
                          const QueueHandle_t frame_o);
 
+    /**
+     * @brief Get the trace of a frame taken from the camera queue
+     *
+     * @param frame  frame received from frame_o
+     * @param trace  sequence number and capture time, seq is 0 if unknown
+     */
+    void camera_frame_trace(const camera_fb_t *frame, frame_trace_t *trace);
+
+    /**
+     * @brief Change the sensor clock at runtime, the frame rate scales with it
+     *
+     * @param xclk_hz  new XCLK frequency
+     * @return true if the sensor supports it
+     */
+    bool camera_set_xclk(int xclk_hz);
+
 
 #ifdef __cplusplus
 }
@@ -1,15 +1,38 @@
 #include "color_detection.hpp"
 #include "esp_log.h"
 #include "esp_camera.h"
+#include "esp_timer.h"
+#include "camera_setting.h"
 #include "dl_image.hpp"
 #include "fb_gfx.h"
 #include "color_detector.hpp"
 #include "who_ai_utils.hpp"
+#include "frame_tiles.hpp"
+#include "motion_gate.hpp"
+#include "fps_stat.h"
+#include "power_governor.hpp"
+#include "deferred_log.hpp"
+#include <algorithm>
+#include <stdlib.h>
+
+/* 1: 按条带把帧从PSRAM拷入内部SRAM后检测  0: 直接在PSRAM帧上检测 */
+#define COLOR_DETECT_TILED 1
+/* 条带接缝两侧允许的间隙（行/列），ColorDetector 的形态学处理会让色块边缘离开条带边界几行 */
+#define TILE_SEAM_ROWS 3
+/* 1: 每帧同时运行两种检测方式并周期打印平均耗时，用于对比 */
+#define COLOR_DETECT_BENCHMARK 0
+#define COLOR_DETECT_BENCHMARK_FRAMES 50
+/* 1: RGB565帧先用逐像素分类查找表统计各颜色的像素数，没有颜色可能达到面积阈值时跳过检测 */
+#define COLOR_DETECT_PRECHECK 1
+/* 预检查每隔几行几列取一个像素，2 时只查 120x120 个像素 */
+#define COLOR_PRECHECK_STRIDE 2
 
 using namespace std;
 using namespace dl;
 
 static const char *TAG = "color_detection";
+/* 每帧都可能输出，限制为每秒5条 */
+static dlog_tag_t LOG_COLOR = DLOG_TAG("color", DLOG_INFO, 5);
 
 static QueueHandle_t xQueueFrameI = NULL;
 static QueueHandle_t xQueueEvent = NULL;
@@ -19,6 +42,8 @@ static QueueHandle_t xQueueResult = NULL;
 static bool gReturnFB = true;
 static int g_max_color_area = 0;
 color_data_t color_data[5];
+static color_result_t color_result;
+static color_tracker_t color_trackers[COLOR_NUM];
 
 
 
@@ -101,6 +126,149 @@ static void get_color_detection_result(uint16_t *image_ptr, int image_height, in
   }
 }
 
+/* 采样像素数按步长放大后估计面积；查找表的HSV换算与ColorDetector内部可能有舍入差异，
+ * 采样也可能漏掉细长色块的一部分，估计面积不到面积阈值的 1/4 才认为没有该颜色 */
+static bool color_pixels_present(camera_fb_t *frame, const decode_option_t *opt, decode_buffer_t *mask)
+{
+  if (frame->format != PIXFORMAT_RGB565 || opt->lut == NULL || std_color_info.size() > 8 ||
+      !app_camera_decode_into(frame, opt, mask))
+  {
+    return true;
+  }
+  int count[8] = {0};
+  int n = mask->height * mask->width;
+  for (int p = 0; p < n; ++p)
+  {
+    for (uint8_t m = mask->data[p], i = 0; m; m >>= 1, ++i)
+    {
+      count[i] += m & 1;
+    }
+  }
+  for (int i = 0; i < std_color_info.size(); ++i)
+  {
+    if (count[i] * COLOR_PRECHECK_STRIDE * COLOR_PRECHECK_STRIDE * 4 >= std_color_info[i].area_thresh)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* 条带边界两侧几行内都有边缘且横向重叠的色块属于同一个色块 */
+static bool tile_blob_touch(const color_detect_result_t &a, const color_detect_result_t &b, int boundary)
+{
+  return a.box[3] >= boundary - 1 - TILE_SEAM_ROWS && b.box[1] <= boundary + TILE_SEAM_ROWS &&
+         a.box[0] <= b.box[2] + TILE_SEAM_ROWS && b.box[0] <= a.box[2] + TILE_SEAM_ROWS;
+}
+
+/* 两个色块框的各边相差不超过 tol 像素 */
+static bool blob_box_close(const color_detect_result_t &a, const color_detect_result_t &b, int tol)
+{
+  for (int k = 0; k < 4; ++k)
+  {
+    if (abs(a.box[k] - b.box[k]) > tol)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* 每种颜色的色块数相同、最大色块的框相差不超过 tol 像素时认为两种检测结果一致 */
+static bool blobs_agree(vector<vector<color_detect_result_t>> &a, vector<vector<color_detect_result_t>> &b, int tol)
+{
+  for (int i = 0; i < a.size() && i < b.size(); ++i)
+  {
+    if (a[i].size() != b[i].size())
+    {
+      return false;
+    }
+    if (a[i].empty())
+    {
+      continue;
+    }
+    auto by_area = [](const color_detect_result_t &x, const color_detect_result_t &y) { return x.area < y.area; };
+    if (!blob_box_close(*max_element(a[i].begin(), a[i].end(), by_area), *max_element(b[i].begin(), b[i].end(), by_area), tol))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void tile_blob_merge(color_detect_result_t &a, const color_detect_result_t &b)
+{
+  int area = a.area + b.area;
+  a.center[0] = (a.center[0] * a.area + b.center[0] * b.area) / area;
+  a.center[1] = (a.center[1] * a.area + b.center[1] * b.area) / area;
+  a.box[0] = min(a.box[0], b.box[0]);
+  a.box[1] = min(a.box[1], b.box[1]);
+  a.box[2] = max(a.box[2], b.box[2]);
+  a.box[3] = max(a.box[3], b.box[3]);
+  a.area = area;
+}
+
+/* 分条带检测：条带在内部SRAM中，检测当前条带时下一条带在核心0上拷贝
+ * 跨条带的色块按边界合并后再用原面积阈值过滤 */
+static bool detect_tiled(ColorDetector &detector, const decode_buffer_t *image, vector<vector<color_detect_result_t>> &merged)
+{
+  if (!frame_tiles_begin((const uint16_t *)image->data, image->height, image->width))
+  {
+    return false;
+  }
+  merged.assign(std_color_info.size(), vector<color_detect_result_t>());
+  int row, rows;
+  const uint16_t *tile;
+  while ((tile = frame_tiles_next(&row, &rows)) != NULL)
+  {
+    vector<vector<color_detect_result_t>> &results = detector.detect((uint16_t *)tile, {rows, image->width, 3});
+    for (int i = 0; i < results.size() && i < merged.size(); ++i)
+    {
+      /* 之前条带的色块数，新色块只和这些色块合并 */
+      int prev_end = merged[i].size();
+      for (auto &blob : results[i])
+      {
+        blob.center[1] += row;
+        blob.box[1] += row;
+        blob.box[3] += row;
+        /* 一个新色块可能连起上一条带中的几个色块（如U形），全部并入第一个相接的色块 */
+        int joined = -1;
+        for (int k = 0; k < prev_end && row > 0; ++k)
+        {
+          if (!tile_blob_touch(merged[i][k], blob, row))
+          {
+            continue;
+          }
+          if (joined < 0)
+          {
+            tile_blob_merge(merged[i][k], blob);
+            joined = k;
+          }
+          else
+          {
+            tile_blob_merge(merged[i][joined], merged[i][k]);
+            merged[i].erase(merged[i].begin() + k);
+            --prev_end;
+            --k;
+          }
+        }
+        if (joined < 0)
+        {
+          merged[i].push_back(blob);
+        }
+      }
+    }
+  }
+  for (int i = 0; i < merged.size(); ++i)
+  {
+    int area_thresh = std_color_info[i].area_thresh;
+    merged[i].erase(remove_if(merged[i].begin(), merged[i].end(),
+                              [area_thresh](const color_detect_result_t &r) { return r.area < area_thresh; }),
+                    merged[i].end());
+  }
+  return true;
+}
+
 static void task_process_handler(void *arg)
 {
   camera_fb_t *frame = NULL;
@@ -110,6 +278,31 @@ static void task_process_handler(void *arg)
   {
     detector.register_color(std_color_info[i].color_thresh, std_color_info[i].area_thresh, std_color_info[i].name);
   }
+#if COLOR_DETECT_TILED || COLOR_DETECT_BENCHMARK
+  /* 条带中的色块可能被边界截断，条带检测使用较小的面积阈值，合并后再按原阈值过滤 */
+  ColorDetector tile_detector;
+  for (int i = 0; i < std_color_info.size(); ++i)
+  {
+    tile_detector.register_color(std_color_info[i].color_thresh, max(std_color_info[i].area_thresh / 4, 1), std_color_info[i].name);
+  }
+  bool tiled = frame_tiles_init(240, TILE_ROWS);
+  vector<vector<color_detect_result_t>> tile_results;
+#endif
+#if COLOR_DETECT_PRECHECK
+  vector<vector<uint8_t>> color_thresh;
+  for (int i = 0; i < std_color_info.size(); ++i)
+  {
+    color_thresh.push_back(std_color_info[i].color_thresh);
+  }
+  decode_option_t class_opt = {DECODE_CLASS, COLOR_PRECHECK_STRIDE, 0, 0, 0, 0, decode_class_lut_create(color_thresh)};
+  decode_buffer_t class_image;
+  decode_buffer_init(&class_image, (240 / COLOR_PRECHECK_STRIDE) * (240 / COLOR_PRECHECK_STRIDE));
+#endif
+  vector<vector<color_detect_result_t>> no_results(std_color_info.size());
+#if COLOR_DETECT_BENCHMARK
+  int64_t bench_tiled_us = 0, bench_direct_us = 0, bench_precheck_us = 0;
+  int bench_frames = 0, bench_skipped = 0, bench_agree = 0;
+#endif
   vector<uint16_t> draw_colors = {
     COLOR_RED,
     COLOR_YELLOW,
@@ -118,11 +311,62 @@ static void task_process_handler(void *arg)
     COLOR_PURPLE,
   };
   int draw_colors_num = draw_colors.size();
+  /* RGB565采集时直接使用帧缓冲；JPEG采集时逐块解码到这块固定缓冲，不再每帧分配 */
+  decode_buffer_t image;
+  decode_buffer_init(&image, 240 * 240 * 2);
   while (true)
   {
-    if (xQueueReceive(xQueueFrameI, &frame, portMAX_DELAY))
+    /* 画面没有变化时跳过检测，重发上一次的结果 */
+    if (xQueueReceive(xQueueFrameI, &frame, portMAX_DELAY) &&
+        app_camera_decode_into(frame, NULL, &image) &&
+        motion_gate_check((const uint16_t *)image.data, image.height, image.width))
     {
-      std::vector<std::vector<color_detect_result_t>> &results = detector.detect((uint16_t *)frame->buf, {(int)frame->height, (int)frame->width, 3});
+      color_result.unchanged = 0;
+      fps_stat_tick(FPS_DETECT);
+      if (motion_gate_changed())
+      {
+        power_governor_activity();
+      }
+      frame_trace_t trace;
+      camera_frame_trace(frame, &trace);
+      color_result.seq = trace.seq;
+      color_result.capture_us = trace.capture_us;
+      color_result.detect_start_us = esp_timer_get_time();
+#if COLOR_DETECT_PRECHECK
+      int64_t t_pre = esp_timer_get_time();
+      bool present = color_pixels_present(frame, &class_opt, &class_image);
+      t_pre = esp_timer_get_time() - t_pre;
+#else
+      bool present = true;
+      int64_t t_pre = 0;
+#endif
+#if COLOR_DETECT_BENCHMARK
+      /* 预检查开启时每帧多花 precheck，跳过的帧省下一次检测 */
+      int64_t t0 = esp_timer_get_time();
+      vector<vector<color_detect_result_t>> &direct_results = detector.detect((uint16_t *)image.data, {image.height, image.width, 3});
+      int64_t t1 = esp_timer_get_time();
+      detect_tiled(tile_detector, &image, tile_results);
+      bench_agree += blobs_agree(direct_results, tile_results, 4);
+      bench_direct_us += t1 - t0;
+      bench_tiled_us += esp_timer_get_time() - t1;
+      bench_precheck_us += t_pre;
+      bench_skipped += !present;
+      if (++bench_frames == COLOR_DETECT_BENCHMARK_FRAMES)
+      {
+        DLOG_I(&LOG_COLOR, "detect direct:%lldus tiled:%lldus agree:%d/%d precheck:%lldus skipped:%d/%d", bench_direct_us / bench_frames,
+               bench_tiled_us / bench_frames, bench_agree, bench_frames, bench_precheck_us / bench_frames, bench_skipped, bench_frames);
+        bench_direct_us = bench_tiled_us = bench_precheck_us = 0;
+        bench_frames = bench_skipped = bench_agree = 0;
+      }
+#else
+      (void)t_pre;
+#endif
+#if COLOR_DETECT_TILED
+      bool use_tiles = present && tiled && detect_tiled(tile_detector, &image, tile_results);
+#else
+      bool use_tiles = false;
+#endif
+      std::vector<std::vector<color_detect_result_t>> &results = !present ? no_results : use_tiles ? tile_results : detector.detect((uint16_t *)image.data, {image.height, image.width, 3});
       for(int i = 0; i < COLOR_NUM; ++i)
       {
         if(results[i].size() == 0)
@@ -132,18 +376,40 @@ static void task_process_handler(void *arg)
           color_data[i].width = 0;
           color_data[i].length = 0;
         }else{
-          printf("Color:[%d] \r\n", i);
+          DLOG_I(&LOG_COLOR, "Color:[%d]", i);
         }
       }
       
       for (int i = 0; i < results.size(); ++i)
       {
-        get_color_detection_result((uint16_t *)frame->buf, (int)frame->height, (int)frame->width, results[i], draw_colors[i % draw_colors_num]);
+        get_color_detection_result((uint16_t *)image.data, image.height, image.width, results[i], draw_colors[i % draw_colors_num]);
       }
+      /* 所有色块参与跟踪，按采集时间计算速度 */
+      color_result.track_us = trace.capture_us ? trace.capture_us : color_result.detect_start_us;
+      for (int i = 0; i < COLOR_NUM && i < results.size(); ++i)
+      {
+        color_tracker_update(&color_trackers[i], results[i], color_result.track_us);
+      }
+      color_result.detect_end_us = esp_timer_get_time();
+    }
+    else
+    {
+      color_result.unchanged = 1;
+      fps_stat_tick(FPS_DETECT_SKIP);
+      color_result.track_us = esp_timer_get_time();
+      for (int i = 0; i < COLOR_NUM; ++i)
+      {
+        color_tracker_hold(&color_trackers[i], color_result.track_us);
+      }
+    }
+    for (int i = 0; i < COLOR_NUM; ++i)
+    {
+      color_result.track_num[i] = color_tracker_top(&color_trackers[i], color_result.track[i], TRACK_TOP_K, color_result.track_us);
     }
-    if (xQueueFrameO)
+    /* 输出队列（如推流）已满时不等待，直接归还帧，检测不会被下游拖慢 */
+    if (xQueueFrameO && xQueueSend(xQueueFrameO, &frame, 0) == pdTRUE)
     {
-      xQueueSend(xQueueFrameO, &frame, portMAX_DELAY);
+      /* 帧已交给下游，由下游归还 */
     }
     else if (gReturnFB)
     {
@@ -155,7 +421,8 @@ static void task_process_handler(void *arg)
     }
     if (xQueueResult)
     {
-      xQueueSend(xQueueResult, &color_data, portMAX_DELAY);             
+      memcpy(color_result.color, color_data, sizeof(color_data));
+      xQueueSend(xQueueResult, &color_result, portMAX_DELAY);             
     }          
   }
 }
@@ -4,6 +4,7 @@
 #include "freertos/queue.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "color_tracker.hpp"
 
 #define COLOR_RED 0x00F8
 #define COLOR_YELLOW 0xE0FF
@@ -21,6 +22,31 @@ typedef struct
   uint8_t length;
 }color_data_t;
 
+/**
+ * @brief Color detection result with frame trace
+ *
+ * @param seq              frame sequence number from register_camera, 0 if unknown
+ * @param capture_us       frame capture time
+ * @param detect_start_us  time the detection task took the frame
+ * @param detect_end_us    time the detection finished
+ * @param unchanged        1 if the scene did not change and the result (with its trace) is repeated from an earlier frame
+ * @param track            top TRACK_TOP_K tracked objects of each color, largest first
+ * @param track_num        number of valid entries in track
+ * @param track_us         time the track positions refer to
+ */
+typedef struct
+{
+  color_data_t color[COLOR_NUM];
+  uint16_t seq;
+  int64_t capture_us;
+  int64_t detect_start_us;
+  int64_t detect_end_us;
+  uint8_t unchanged;
+  track_info_t track[COLOR_NUM][TRACK_TOP_K];
+  uint8_t track_num[COLOR_NUM];
+  int64_t track_us;
+}color_result_t;
+
 /**
  * @brief Color detection result
  * 
@@ -0,0 +1,231 @@
+#include "color_tracker.hpp"
+#include <algorithm>
+#include <math.h>
+
+using namespace std;
+
+typedef struct
+{
+  float score;
+  int track;
+  int blob;
+} track_pair_t;
+
+/* 按速度预测到 now_us 时刻的中心 */
+static void track_predict(const color_track_t &t, int64_t now_us, float *x, float *y)
+{
+  float dt = (now_us - t.update_us) / 1000000.0f;
+  *x = t.x + t.vx * dt;
+  *y = t.y + t.vy * dt;
+}
+
+/* 预测框与色块框的关联得分：交并比，交并比不足时按中心距离给出低于 TRACK_IOU_MIN 的得分，不能关联返回0 */
+static float track_score(const color_track_t &t, const color_detect_result_t &b, int64_t now_us)
+{
+  float px, py;
+  track_predict(t, now_us, &px, &py);
+  float ax0 = px - t.w / 2.0f, ay0 = py - t.h / 2.0f;
+  float ax1 = ax0 + t.w, ay1 = ay0 + t.h;
+  float iw = min(ax1, (float)b.box[2]) - max(ax0, (float)b.box[0]);
+  float ih = min(ay1, (float)b.box[3]) - max(ay0, (float)b.box[1]);
+  if (iw > 0 && ih > 0)
+  {
+    float inter = iw * ih;
+    float uni = (float)t.w * t.h + (float)(b.box[2] - b.box[0]) * (b.box[3] - b.box[1]) - inter;
+    float iou = inter / max(uni, 1.0f);
+    if (iou >= TRACK_IOU_MIN)
+    {
+      return iou;
+    }
+  }
+  float dist = hypotf(b.center[0] - px, b.center[1] - py);
+  if (dist < TRACK_GATE_PX)
+  {
+    return TRACK_IOU_MIN * (1.0f - dist / TRACK_GATE_PX);
+  }
+  return 0;
+}
+
+static void track_set(color_track_t &t, const color_detect_result_t &b, int64_t now_us)
+{
+  t.x = b.center[0];
+  t.y = b.center[1];
+  t.w = b.box[2] - b.box[0];
+  t.h = b.box[3] - b.box[1];
+  t.area = b.area;
+  t.update_us = now_us;
+}
+
+void color_tracker_update(color_tracker_t *tracker, const vector<color_detect_result_t> &blobs, int64_t now_us)
+{
+  /* 所有可关联的 (目标, 色块) 按得分从高到低贪心匹配 */
+  vector<track_pair_t> pairs;
+  for (int i = 0; i < TRACK_MAX; ++i)
+  {
+    if (tracker->track[i].id == 0)
+    {
+      continue;
+    }
+    for (int j = 0; j < blobs.size(); ++j)
+    {
+      float score = track_score(tracker->track[i], blobs[j], now_us);
+      if (score > 0)
+      {
+        pairs.push_back({score, i, j});
+      }
+    }
+  }
+  sort(pairs.begin(), pairs.end(), [](const track_pair_t &a, const track_pair_t &b) { return a.score > b.score; });
+
+  bool track_used[TRACK_MAX] = {false};
+  vector<bool> blob_used(blobs.size(), false);
+  for (auto &p : pairs)
+  {
+    if (track_used[p.track] || blob_used[p.blob])
+    {
+      continue;
+    }
+    track_used[p.track] = true;
+    blob_used[p.blob] = true;
+
+    color_track_t &t = tracker->track[p.track];
+    const color_detect_result_t &b = blobs[p.blob];
+    float dt = (now_us - t.update_us) / 1000000.0f;
+    if (dt > 0)
+    {
+      float vx = (b.center[0] - t.x) / dt;
+      float vy = (b.center[1] - t.y) / dt;
+      /* 第二次关联时直接使用测量速度，之后做一阶滤波 */
+      t.vx = t.hits > 1 ? t.vx * 0.5f + vx * 0.5f : vx;
+      t.vy = t.hits > 1 ? t.vy * 0.5f + vy * 0.5f : vy;
+    }
+    track_set(t, b, now_us);
+    t.hits = t.hits < 255 ? t.hits + 1 : 255;
+    t.misses = 0;
+  }
+
+  /* 没有关联到的目标：未确认或丢失过久则删除，否则保持速度继续预测 */
+  for (int i = 0; i < TRACK_MAX; ++i)
+  {
+    color_track_t &t = tracker->track[i];
+    if (t.id == 0 || track_used[i])
+    {
+      continue;
+    }
+    if (t.hits < TRACK_CONFIRM_HITS || ++t.misses > TRACK_MAX_MISSES)
+    {
+      t.id = 0;
+    }
+  }
+
+  /* 没有关联到的色块建立新目标，没有空位时丢弃 */
+  for (int j = 0; j < blobs.size(); ++j)
+  {
+    if (blob_used[j])
+    {
+      continue;
+    }
+    for (int i = 0; i < TRACK_MAX; ++i)
+    {
+      color_track_t &t = tracker->track[i];
+      if (t.id != 0)
+      {
+        continue;
+      }
+      if (++tracker->next_id == 0)
+      {
+        tracker->next_id = 1;
+      }
+      t.id = tracker->next_id;
+      t.hits = 1;
+      t.misses = 0;
+      t.vx = 0;
+      t.vy = 0;
+      track_set(t, blobs[j], now_us);
+      break;
+    }
+  }
+}
+
+void color_tracker_hold(color_tracker_t *tracker, int64_t now_us)
+{
+  for (int i = 0; i < TRACK_MAX; ++i)
+  {
+    color_track_t &t = tracker->track[i];
+    if (t.id == 0)
+    {
+      continue;
+    }
+    float x, y;
+    track_predict(t, now_us, &x, &y);
+    if (t.misses > 0)
+    {
+      t.x = x;
+      t.y = y;
+    }
+    t.vx = 0;
+    t.vy = 0;
+    t.update_us = now_us;
+  }
+}
+
+static uint8_t clamp_u8(float v)
+{
+  return v < 0 ? 0 : (v > 255 ? 255 : (uint8_t)(v + 0.5f));
+}
+
+static int16_t clamp_i16(float v)
+{
+  return v < -32768 ? -32768 : (v > 32767 ? 32767 : (int16_t)v);
+}
+
+static int8_t clamp_i8(float v)
+{
+  return v < -128 ? -128 : (v > 127 ? 127 : (int8_t)v);
+}
+
+void track_info_pack(const track_info_t *track, int64_t dt_us, uint8_t *out)
+{
+  float dt = dt_us / 1000000.0f;
+  out[0] = track->id;
+  out[1] = clamp_u8(track->x + track->vx * dt);
+  out[2] = clamp_u8(track->y + track->vy * dt);
+  out[3] = track->w;
+  out[4] = track->h;
+  out[5] = (uint8_t)clamp_i8(track->vx / 10.0f);
+  out[6] = (uint8_t)clamp_i8(track->vy / 10.0f);
+  out[7] = track->lost;
+}
+
+int color_tracker_top(const color_tracker_t *tracker, track_info_t *out, int k, int64_t now_us)
+{
+  /* 已确认的目标，包括丢失中按速度预测的目标 */
+  const color_track_t *list[TRACK_MAX];
+  int num = 0;
+  for (int i = 0; i < TRACK_MAX; ++i)
+  {
+    const color_track_t &t = tracker->track[i];
+    if (t.id != 0 && t.hits >= TRACK_CONFIRM_HITS)
+    {
+      list[num++] = &t;
+    }
+  }
+  sort(list, list + num, [](const color_track_t *a, const color_track_t *b) { return a->area > b->area; });
+
+  num = min(num, k);
+  for (int i = 0; i < num; ++i)
+  {
+    const color_track_t &t = *list[i];
+    float x, y;
+    track_predict(t, now_us, &x, &y);
+    out[i].id = t.id;
+    out[i].lost = t.misses;
+    out[i].x = clamp_u8(x);
+    out[i].y = clamp_u8(y);
+    out[i].w = clamp_u8(t.w);
+    out[i].h = clamp_u8(t.h);
+    out[i].vx = clamp_i16(t.vx);
+    out[i].vy = clamp_i16(t.vy);
+  }
+  return num;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "color_detector.hpp"
+
+/* 每种颜色通过IIC输出的目标数，1 + 8 * TRACK_TOP_K 字节不能超过 Arduino Wire 的 32 字节缓冲 */
+#define TRACK_TOP_K 3
+/* 每种颜色同时跟踪的目标数 */
+#define TRACK_MAX 8
+/* 预测框与色块框的交并比达到该值即可关联 */
+#define TRACK_IOU_MIN 0.1f
+/* 交并比不足时，中心距离小于该值(像素)也可关联 */
+#define TRACK_GATE_PX 40
+/* 检测到该次数后才确认并输出，未确认的目标丢失一次即删除，过滤闪烁的噪点 */
+#define TRACK_CONFIRM_HITS 2
+/* 连续丢失超过该帧数后删除，丢失期间按速度预测位置 */
+#define TRACK_MAX_MISSES 5
+
+typedef struct
+{
+  uint8_t id;          // 0 表示空位
+  uint8_t hits;        // 关联次数（封顶255）
+  uint8_t misses;      // 连续丢失帧数
+  int16_t x, y, w, h;  // 最后一次检测的中心与尺寸
+  int area;
+  float vx, vy;        // 速度，像素/秒
+  int64_t update_us;   // 最后一次检测的时间
+} color_track_t;
+
+typedef struct
+{
+  color_track_t track[TRACK_MAX];
+  uint8_t next_id;
+} color_tracker_t;
+
+/**
+ * @brief Tracked object reported to the IIC master
+ *
+ * @param id      persistent id (1~255, per color)
+ * @param lost    frames since the object was last detected, 0 if seen in this frame
+ * @param x,y     center predicted to the frame time
+ * @param w,h     box size
+ * @param vx,vy   velocity in pixels per second
+ */
+typedef struct
+{
+  uint8_t id;
+  uint8_t lost;
+  uint8_t x, y, w, h;
+  int16_t vx, vy;
+} track_info_t;
+
+/**
+ * @brief Associate the blobs of one color in a new frame with the existing tracks
+ *
+ * @param tracker  tracker of this color
+ * @param blobs    all blobs of this color in the frame
+ * @param now_us   frame time
+ */
+void color_tracker_update(color_tracker_t *tracker, const std::vector<color_detect_result_t> &blobs, int64_t now_us);
+
+/**
+ * @brief Frame skipped because the scene did not change: stop all tracks where they are
+ *
+ * @param tracker  tracker of this color
+ * @param now_us   frame time
+ */
+void color_tracker_hold(color_tracker_t *tracker, int64_t now_us);
+
+/**
+ * @brief Confirmed tracks sorted by area, largest first
+ *
+ * @param tracker  tracker of this color
+ * @param out      output array
+ * @param k        size of out
+ * @param now_us   time the positions are predicted to
+ * @return number of tracks written
+ */
+int color_tracker_top(const color_tracker_t *tracker, track_info_t *out, int k, int64_t now_us);
+
+/**
+ * @brief Pack a track into the 8-byte wire format: id x y w h vx vy lost, velocity in 10 pixels per second
+ *
+ * @param track  tracked object
+ * @param dt_us  time to extrapolate the center by
+ * @param out    8 bytes
+ */
+void track_info_pack(const track_info_t *track, int64_t dt_us, uint8_t *out);
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+/* 每个任务一个环形缓冲，写日志只格式化并拷贝，由核心0上的低优先级任务输出到串口 */
+#define DLOG_RING_SIZE 1024
+#define DLOG_MAX_RINGS 8
+#define DLOG_MAX_TAGS 16
+#define DLOG_LINE_MAX 120
+/* 输出任务的周期，同时每秒汇总一次被限流丢弃的条数 */
+#define DLOG_FLUSH_MS 20
+
+typedef enum
+{
+  DLOG_NONE,
+  DLOG_ERROR,
+  DLOG_WARN,
+  DLOG_INFO,
+  DLOG_DEBUG,
+} dlog_level_t;
+
+/**
+ * @brief Log tag: runtime level and token bucket rate limit, define one static per module
+ *
+ * @param name        printed before each line, also used to set the level
+ * @param level       lines above this level are dropped
+ * @param rate        lines per second, 0 for no limit
+ */
+typedef struct
+{
+  const char *name;
+  volatile uint8_t level;
+  uint16_t rate;
+  float tokens;
+  int64_t refill_us;
+  volatile uint32_t suppressed;  // 被限流丢弃的条数
+  bool registered;
+} dlog_tag_t;
+
+#define DLOG_TAG(name, level, rate) {name, level, rate, (float)(rate), 0, 0, false}
+
+/**
+ * @brief Format a line into the calling task's ring, never blocks
+ */
+void dlog_write(dlog_tag_t *tag, dlog_level_t level, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+#define DLOG_E(tag, fmt, ...) dlog_write(tag, DLOG_ERROR, fmt, ##__VA_ARGS__)
+#define DLOG_W(tag, fmt, ...) dlog_write(tag, DLOG_WARN, fmt, ##__VA_ARGS__)
+#define DLOG_I(tag, fmt, ...) dlog_write(tag, DLOG_INFO, fmt, ##__VA_ARGS__)
+#define DLOG_D(tag, fmt, ...) dlog_write(tag, DLOG_DEBUG, fmt, ##__VA_ARGS__)
+
+/**
+ * @brief Set the level of a tag by name, "*" for all tags
+ *
+ * @return number of tags changed
+ */
+int dlog_set_level(const char *name, uint8_t level);
+
+/**
+ * @brief Start the flush task on core 0, it also reads "log <tag|*> <level>" lines from the serial port
+ */
+void register_deferred_log(void);
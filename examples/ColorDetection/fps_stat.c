@@ -0,0 +1,37 @@
+#include "fps_stat.h"
+#include "esp_timer.h"
+
+static volatile uint32_t counts[FPS_STAT_NUM];
+static uint32_t last_counts[FPS_STAT_NUM];
+static float rates[FPS_STAT_NUM];
+static int64_t last_us = 0;
+
+static const char *names[FPS_STAT_NUM] = {"camera", "detect", "detect_skip", "stream", "stream_drop"};
+
+void fps_stat_tick(fps_stat_id_t id)
+{
+    counts[id]++;
+}
+
+void fps_stat_update(void)
+{
+    int64_t now = esp_timer_get_time();
+    float dt = (now - last_us) / 1000000.0f;
+    for (int i = 0; i < FPS_STAT_NUM; ++i)
+    {
+        uint32_t c = counts[i];
+        rates[i] = (last_us && dt > 0) ? (c - last_counts[i]) / dt : 0;
+        last_counts[i] = c;
+    }
+    last_us = now;
+}
+
+float fps_stat_rate(fps_stat_id_t id)
+{
+    return rates[id];
+}
+
+const char *fps_stat_name(fps_stat_id_t id)
+{
+    return names[id];
+}
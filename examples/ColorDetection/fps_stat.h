@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+
+/* 各任务的帧计数，由各自的任务累加，读取时按时间间隔换算成帧率 */
+typedef enum
+{
+    FPS_CAMERA,       // 摄像头采集
+    FPS_DETECT,       // 完成检测
+    FPS_DETECT_SKIP,  // 画面没有变化跳过检测
+    FPS_STREAM,       // 推流发送
+    FPS_STREAM_DROP,  // 有推流连接时没有编码而直接归还的帧（限帧率或上一张还未发出）
+    FPS_STAT_NUM,
+} fps_stat_id_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+    /**
+     * @brief Count one frame
+     *
+     * @param id  counter, each counter must only be counted by one task
+     */
+    void fps_stat_tick(fps_stat_id_t id);
+
+    /**
+     * @brief Compute the frame rates since the previous update, called periodically by one task
+     */
+    void fps_stat_update(void);
+
+    /**
+     * @brief Frame rate of a counter computed by the last update
+     */
+    float fps_stat_rate(fps_stat_id_t id);
+
+    /**
+     * @brief Name of a counter
+     */
+    const char *fps_stat_name(fps_stat_id_t id);
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,106 @@
+#include "frame_tiles.hpp"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+
+static const char *TAG = "frame_tiles";
+
+typedef struct
+{
+  uint16_t *dst;
+  const uint16_t *src;
+  size_t bytes;
+  int buf;
+} copy_request_t;
+
+static uint16_t *tile_buf[2] = {NULL, NULL};
+static SemaphoreHandle_t tile_ready[2];
+static QueueHandle_t xQueueCopy = NULL;
+
+static const uint16_t *g_frame = NULL;
+static int g_height = 0;
+static int g_width = 0;
+static int g_rows = TILE_ROWS;
+static int g_max_width = 0;
+static int g_next_row = 0;
+static int g_cur = 0;
+
+/* 拷贝任务运行在核心0，检测任务在核心1处理当前条带的同时，把下一条带从PSRAM拷入内部SRAM */
+static void task_copy_handler(void *arg)
+{
+  copy_request_t req;
+  while (true)
+  {
+    if (xQueueReceive(xQueueCopy, &req, portMAX_DELAY))
+    {
+      memcpy(req.dst, req.src, req.bytes);
+      xSemaphoreGive(tile_ready[req.buf]);
+    }
+  }
+}
+
+static void request_copy(int buf, int row)
+{
+  int rows = g_height - row < g_rows ? g_height - row : g_rows;
+  copy_request_t req = {tile_buf[buf], g_frame + row * g_width, (size_t)rows * g_width * sizeof(uint16_t), buf};
+  xQueueSend(xQueueCopy, &req, portMAX_DELAY);
+}
+
+bool frame_tiles_init(int max_width, int rows)
+{
+  if (xQueueCopy)
+  {
+    return true;
+  }
+  for (int i = 0; i < 2; ++i)
+  {
+    tile_buf[i] = (uint16_t *)heap_caps_malloc(max_width * rows * sizeof(uint16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!tile_buf[i])
+    {
+      ESP_LOGE(TAG, "no internal memory for %d x %d strips", max_width, rows);
+      return false;
+    }
+    tile_ready[i] = xSemaphoreCreateBinary();
+  }
+  g_max_width = max_width;
+  g_rows = rows;
+  xQueueCopy = xQueueCreate(2, sizeof(copy_request_t));
+  xTaskCreatePinnedToCore(task_copy_handler, TAG, 2 * 1024, NULL, 5, NULL, 0);
+  return true;
+}
+
+bool frame_tiles_begin(const uint16_t *frame, int height, int width)
+{
+  if (!xQueueCopy || width > g_max_width)
+  {
+    return false;
+  }
+  g_frame = frame;
+  g_height = height;
+  g_width = width;
+  g_next_row = 0;
+  g_cur = 0;
+  request_copy(0, 0);
+  return true;
+}
+
+const uint16_t *frame_tiles_next(int *row, int *rows)
+{
+  if (g_next_row >= g_height)
+  {
+    return NULL;
+  }
+  xSemaphoreTake(tile_ready[g_cur], portMAX_DELAY);
+  *row = g_next_row;
+  *rows = g_height - g_next_row < g_rows ? g_height - g_next_row : g_rows;
+  g_next_row += *rows;
+
+  const uint16_t *tile = tile_buf[g_cur];
+  /* 另一块缓冲中的条带已处理完，开始预取下一条带 */
+  g_cur ^= 1;
+  if (g_next_row < g_height)
+  {
+    request_copy(g_cur, g_next_row);
+  }
+  return tile;
+}
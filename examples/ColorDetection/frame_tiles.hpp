@@ -0,0 +1,37 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+/* 每个条带的行数，两块条带缓冲共占用 2 * 宽度 * TILE_ROWS * 2 字节内部SRAM */
+#define TILE_ROWS 40
+
+/**
+ * @brief Allocate two strip buffers in internal SRAM and start the copy task on core 0
+ *
+ * @param max_width  widest frame that will be processed
+ * @param rows       rows per strip
+ * @return true on success
+ */
+bool frame_tiles_init(int max_width, int rows);
+
+/**
+ * @brief Start reading a RGB565 frame (usually in PSRAM) strip by strip, the first strip is copied immediately
+ *
+ * @param frame   frame buffer
+ * @param height  frame height
+ * @param width   frame width
+ * @return false if the frame is wider than max_width
+ */
+bool frame_tiles_begin(const uint16_t *frame, int height, int width);
+
+/**
+ * @brief Wait for the next strip and start copying the one after it into the other buffer
+ *
+ * @param row   first frame row of the returned strip
+ * @param rows  number of rows in the returned strip
+ * @return strip in internal SRAM, valid until the next call; NULL when the frame is done
+ */
+const uint16_t *frame_tiles_next(int *row, int *rows);
@@ -1,4 +1,8 @@
 #include "iic_data_send.hpp"
+#include "color_detection.hpp"
+#include "esp_timer.h"
+#include "power_governor.hpp"
+#include "deferred_log.hpp"
 #include "Wire.h"
 
 #define I2C_SLAVE_ADDRESS 0x52
@@ -11,23 +15,111 @@ static const int sdaPin = 47;
 static const int sclPin = 48;
 static const uint32_t i2cFrequency = 100000;
 
+/* 任务写入的最新结果，请求回调在同一把锁内整体拷贝一份再使用，不会读到两帧混在一起的数据 */
+static portMUX_TYPE result_mux = portMUX_INITIALIZER_UNLOCKED;
+static send_color_data_t shared_color_data[5];
+static color_result_t shared_result;
+/* 请求回调使用的副本 */
 static send_color_data_t color_data[5];
+static color_result_t color_result;
 
 static uint8_t rec = 0xFF;
-static uint8_t send_data[4] = {0};
+/* 最长的是跟踪寄存器：目标数(1) + 每个目标8字节 */
+static uint8_t send_data[1 + 8 * TRACK_TOP_K] = {0};
+/* 带追踪信息的寄存器：色块数据(4) + 追踪信息(8) */
+#define TRACE_REG_LEN (4 + 8)
+static_assert(sizeof(send_data) >= TRACE_REG_LEN, "trace registers need 12 bytes");
 
 static void iic_receive(int len)
 {
-  while(Wire.available())
+  if(Wire.available())
   {
     rec = Wire.read();
-  }  
+  }
+  /* 写寄存器 0x30：功耗模式 */
+  if(rec == 0x30 && Wire.available())
+  {
+    power_governor_set_mode(Wire.read());
+  }
+  /* 写寄存器 0x31：所有日志标签的等级 */
+  if(rec == 0x31 && Wire.available())
+  {
+    dlog_set_level("*", Wire.read());
+  }
+  while(Wire.available())
+  {
+    Wire.read();
+  }
+}
+
+/* 写入16位小端数据，超出范围时限幅 */
+static void put_u16(uint8_t *p, int64_t v)
+{
+  if (v < 0) v = 0;
+  if (v > 0xFFFF) v = 0xFFFF;
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+/* 跟踪寄存器 0x20~0x24：红 黄 绿 蓝 紫
+ * data[0] 目标数，之后每个目标8字节：编号 中心X 中心Y 宽 高 X速度 Y速度 丢失帧数
+ * 中心按速度预测到本次读取的时刻，速度单位 10像素/秒 */
+static uint8_t track_block(uint8_t color)
+{
+  int64_t dt = esp_timer_get_time() - color_result.track_us;
+  int num = color_result.track_num[color];
+  send_data[0] = num;
+  for (int i = 0; i < num; ++i)
+  {
+    track_info_pack(&color_result.track[color][i], dt, &send_data[1 + i * 8]);
+  }
+  return 1 + num * 8;
 }
 
 static void iic_request()
 {
+  uint8_t reg = rec;
+  uint8_t len = 4;
+  portENTER_CRITICAL(&result_mux);
+  color_result = shared_result;
+  memcpy(color_data, shared_color_data, sizeof(color_data));
+  portEXIT_CRITICAL(&result_mux);
+  /* 功耗状态：模式 档位 CPU频率/2(MHz) */
+  if(rec == 0x30)
+  {
+    send_data[0] = power_governor_mode();
+    send_data[1] = power_governor_level();
+    send_data[2] = power_governor_cpu_mhz() / 2;
+    Wire.slaveWrite(send_data, 3);
+    return;
+  }
+  /* 状态寄存器 0x03：bit0 画面没有变化，结果是重发的 */
+  if(rec == 0x03)
+  {
+    send_data[0] = color_result.unchanged ? IIC_STATUS_UNCHANGED : 0;
+    Wire.slaveWrite(send_data, 1);
+    return;
+  }
+  if(rec >= 0x20 && rec < 0x20 + COLOR_NUM)
+  {
+    len = track_block(rec - 0x20);
+    Wire.slaveWrite(send_data, len);
+    return;
+  }
+  /* 带追踪信息的寄存器 0x10~0x12：色块数据后接
+   * 帧序号(2) 采集->开始检测(2) 检测耗时(2) 检测完成->本次读取(2)，单位ms */
+  if(rec >= 0x10 && rec <= 0x12)
+  {
+    int64_t now = esp_timer_get_time();
+    put_u16(&send_data[4], color_result.seq);
+    put_u16(&send_data[6], (color_result.detect_start_us - color_result.capture_us) / 1000);
+    put_u16(&send_data[8], (color_result.detect_end_us - color_result.detect_start_us) / 1000);
+    put_u16(&send_data[10], (now - color_result.detect_end_us) / 1000);
+    reg = rec - 0x10;
+    len = TRACE_REG_LEN;
+  }
   /* 红色色块数据 */
-  if(rec == 0x00) 
+  if(reg == 0x00) 
   {
     send_data[0] = color_data[0].center_x;
     send_data[1] = color_data[0].center_y;
@@ -35,7 +127,7 @@ static void iic_request()
     send_data[3] = color_data[0].length;
   }
   /* 绿色色块数据 */
-  else if(rec == 0x01)
+  else if(reg == 0x01)
   {
     send_data[0] = color_data[2].center_x;
     send_data[1] = color_data[2].center_y;
@@ -43,7 +135,7 @@ static void iic_request()
     send_data[3] = color_data[2].length;
   }
   /* 蓝色色块数据 */
-  else if(rec == 0x02)
+  else if(reg == 0x02)
   {
     send_data[0] = color_data[3].center_x;
     send_data[1] = color_data[3].center_y;
@@ -52,7 +144,7 @@ static void iic_request()
   }
 
   /* 发送色块数据 */
-  Wire.slaveWrite(send_data, sizeof(send_data));
+  Wire.slaveWrite(send_data, len);
 
 }
 
@@ -65,11 +157,17 @@ static void task_process_handler(void *arg)
   /* 注册请求数据的回调函数 */
   Wire.onRequest(iic_request);
 
+  /* 先收到任务自己的缓冲里，再在锁内整体替换共享结果 */
+  static color_result_t incoming;
   while (true)
   {
 
-    if (xQueueReceive(xQueueResultI, &color_data, portMAX_DELAY))
+    if (xQueueReceive(xQueueResultI, &incoming, portMAX_DELAY))
     {
+      portENTER_CRITICAL(&result_mux);
+      shared_result = incoming;
+      memcpy(shared_color_data, incoming.color, sizeof(shared_color_data));
+      portEXIT_CRITICAL(&result_mux);
     //  switch(rec){
     //   case 0x00:
     //     printf("red:%d",rec);
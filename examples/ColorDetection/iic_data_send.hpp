@@ -14,6 +14,9 @@ typedef struct
   uint8_t length;
 }send_color_data_t;
 
+/* 状态寄存器 0x03 的位：1 表示画面没有变化，当前发布的结果是上一次结果的重发 */
+#define IIC_STATUS_UNCHANGED 0x01
+
 /**
  * @brief Color detection result
  * 
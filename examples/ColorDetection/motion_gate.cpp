@@ -0,0 +1,76 @@
+/* ColorDetection 与 FaceDetection 各有一份，两份内容保持一致，修改时同步 */
+#include "motion_gate.hpp"
+#include "esp_timer.h"
+#include <stdlib.h>
+#include <string.h>
+
+static uint8_t g_signature[MOTION_GRID * MOTION_GRID];
+static bool g_valid = false;
+static int64_t g_last_run_us = 0;
+static bool g_changed = false;
+static volatile uint32_t g_max_age_ms = MOTION_MAX_AGE_MS;
+
+/* RGB565 帧缓冲为大端，先交换字节再换算亮度 Y = 0.30R + 0.59G + 0.11B */
+static inline int pixel_luma(uint16_t p)
+{
+  uint16_t v = (p >> 8) | (p << 8);
+  int r = (v >> 8) & 0xF8;
+  int g = (v >> 3) & 0xFC;
+  int b = (v << 3) & 0xF8;
+  return (r * 77 + g * 150 + b * 29) >> 8;
+}
+
+static void motion_signature(const uint16_t *frame, int height, int width, uint8_t *signature)
+{
+  int cell_h = height / MOTION_GRID;
+  int cell_w = width / MOTION_GRID;
+  for (int gy = 0; gy < MOTION_GRID; ++gy)
+  {
+    /* 取格子内 1/4 和 3/4 处的行列 */
+    const uint16_t *row0 = frame + (gy * cell_h + cell_h / 4) * width;
+    const uint16_t *row1 = frame + (gy * cell_h + cell_h * 3 / 4) * width;
+    for (int gx = 0; gx < MOTION_GRID; ++gx)
+    {
+      int x0 = gx * cell_w + cell_w / 4;
+      int x1 = gx * cell_w + cell_w * 3 / 4;
+      int sum = pixel_luma(row0[x0]) + pixel_luma(row0[x1]) + pixel_luma(row1[x0]) + pixel_luma(row1[x1]);
+      signature[gy * MOTION_GRID + gx] = sum >> 2;
+    }
+  }
+}
+
+bool motion_gate_check(const uint16_t *frame, int height, int width)
+{
+  uint8_t signature[MOTION_GRID * MOTION_GRID];
+  motion_signature(frame, height, width, signature);
+
+  int changed = 0;
+  for (int i = 0; i < MOTION_GRID * MOTION_GRID && changed < MOTION_CELLS; ++i)
+  {
+    if (abs((int)signature[i] - (int)g_signature[i]) > MOTION_CELL_THRESH)
+    {
+      ++changed;
+    }
+  }
+  int64_t now = esp_timer_get_time();
+  g_changed = g_valid && changed >= MOTION_CELLS;
+  if (g_valid && !g_changed && now - g_last_run_us < g_max_age_ms * 1000LL)
+  {
+    return false;
+  }
+  /* 只在检测时更新参考特征，缓慢变化累积到阈值后也会触发检测 */
+  memcpy(g_signature, signature, sizeof(g_signature));
+  g_valid = true;
+  g_last_run_us = now;
+  return true;
+}
+
+bool motion_gate_changed(void)
+{
+  return g_changed;
+}
+
+void motion_gate_set_max_age(uint32_t ms)
+{
+  g_max_age_ms = ms;
+}
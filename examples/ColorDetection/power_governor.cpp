@@ -0,0 +1,121 @@
+#include "power_governor.hpp"
+#include "camera_setting.h"
+#include "motion_gate.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp32-hal-cpu.h"
+
+static const char *TAG = "power_governor";
+
+typedef struct
+{
+  uint32_t cpu_mhz;
+  int xclk_hz;
+  uint32_t detect_max_age_ms;
+} power_level_config_t;
+
+static const power_level_config_t level_config[POWER_LEVEL_NUM] = {
+    {240, XCLK_FREQ_HZ, MOTION_MAX_AGE_MS},
+    {160, 10000000, 1000},
+    {80, 6000000, 3000},
+};
+
+static QueueHandle_t xQueueFrame = NULL;
+static TaskHandle_t governor_task = NULL;
+
+static volatile power_mode_t g_mode = POWER_MODE_AUTO;
+static volatile power_level_t g_level = POWER_ACTIVE;
+static volatile int64_t g_activity_us = 0;
+
+static void apply_level(power_level_t level)
+{
+  const power_level_config_t &c = level_config[level];
+  /* 升档先提高CPU频率再加快摄像头，降档相反 */
+  if (level < g_level)
+  {
+    setCpuFrequencyMhz(c.cpu_mhz);
+    camera_set_xclk(c.xclk_hz);
+  }
+  else
+  {
+    camera_set_xclk(c.xclk_hz);
+    setCpuFrequencyMhz(c.cpu_mhz);
+  }
+  motion_gate_set_max_age(c.detect_max_age_ms);
+  ESP_LOGI(TAG, "level %d -> %d, cpu %dMHz", g_level, level, (int)c.cpu_mhz);
+  g_level = level;
+}
+
+static void task_process_handler(void *arg)
+{
+  float backlog = 0;
+  while (true)
+  {
+    /* 有活动时立即被唤醒 */
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(POWER_PERIOD_MS));
+
+    /* 检测跟不上（队列中帧积压）与画面变化同样处理，回到最高档 */
+    if (xQueueFrame)
+    {
+      backlog = backlog * 0.8f + uxQueueMessagesWaiting(xQueueFrame) * 0.2f;
+      if (backlog >= 1.0f && g_level != POWER_ACTIVE)
+      {
+        g_activity_us = esp_timer_get_time();
+        backlog = 0;
+      }
+    }
+
+    int64_t idle_ms = (esp_timer_get_time() - g_activity_us) / 1000;
+    power_level_t target = POWER_ACTIVE;
+    if (g_mode == POWER_MODE_AUTO)
+    {
+      target = idle_ms < POWER_IDLE_AFTER_MS ? POWER_ACTIVE : (idle_ms < POWER_SLEEP_AFTER_MS ? POWER_IDLE : POWER_SLEEP);
+    }
+
+    if (target != g_level)
+    {
+      apply_level(target);
+    }
+  }
+}
+
+void register_power_governor(const QueueHandle_t frame_queue)
+{
+  xQueueFrame = frame_queue;
+  g_activity_us = esp_timer_get_time();
+  xTaskCreatePinnedToCore(task_process_handler, TAG, 3 * 1024, NULL, 3, &governor_task, 0);
+}
+
+void power_governor_activity(void)
+{
+  g_activity_us = esp_timer_get_time();
+  if (g_level != POWER_ACTIVE && governor_task)
+  {
+    xTaskNotifyGive(governor_task);
+  }
+}
+
+void power_governor_set_mode(uint8_t mode)
+{
+  g_mode = mode == POWER_MODE_ACTIVE ? POWER_MODE_ACTIVE : POWER_MODE_AUTO;
+  g_activity_us = esp_timer_get_time();
+  if (governor_task)
+  {
+    xTaskNotifyGive(governor_task);
+  }
+}
+
+power_mode_t power_governor_mode(void)
+{
+  return g_mode;
+}
+
+power_level_t power_governor_level(void)
+{
+  return g_level;
+}
+
+int power_governor_cpu_mhz(void)
+{
+  return level_config[g_level].cpu_mhz;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+/* 没有画面变化超过该时间降到空闲档，再超过 POWER_SLEEP_AFTER_MS 降到休眠档 */
+#define POWER_IDLE_AFTER_MS 3000
+#define POWER_SLEEP_AFTER_MS 20000
+/* 调速周期 */
+#define POWER_PERIOD_MS 100
+
+typedef enum
+{
+  POWER_ACTIVE,  // 240MHz，XCLK 15MHz，静止画面每 0.5s 检测一次
+  POWER_IDLE,    // 160MHz，XCLK 10MHz，每 1s
+  POWER_SLEEP,   // 80MHz，XCLK 6MHz，每 3s
+  POWER_LEVEL_NUM,
+} power_level_t;
+
+typedef enum
+{
+  POWER_MODE_AUTO = 0,    // 按画面变化与队列占用自动调速
+  POWER_MODE_ACTIVE = 1,  // 保持最高档，如游戏进行中
+} power_mode_t;
+
+/**
+ * @brief Start the governor task on core 0
+ *
+ * @param frame_queue  camera to detection queue, a backlog raises the level
+ */
+void register_power_governor(const QueueHandle_t frame_queue);
+
+/**
+ * @brief Report activity (scene changed), jumps to POWER_ACTIVE at once
+ */
+void power_governor_activity(void);
+
+/**
+ * @brief Set the mode (IIC register 0x30), any write also jumps to POWER_ACTIVE
+ *
+ * @param mode  power_mode_t
+ */
+void power_governor_set_mode(uint8_t mode);
+
+power_mode_t power_governor_mode(void);
+
+power_level_t power_governor_level(void);
+
+/**
+ * @brief CPU frequency of the current level in MHz
+ */
+int power_governor_cpu_mhz(void);
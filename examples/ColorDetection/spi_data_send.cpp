@@ -0,0 +1,165 @@
+#include "spi_data_send.hpp"
+#include "color_detection.hpp"
+#include "result_frame.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_idf_version.h"
+#include "driver/gpio.h"
+#include "driver/spi_slave.h"
+#include <string.h>
+
+#define SPI_SLAVE_HOST SPI2_HOST
+
+static QueueHandle_t xQueueResultI = NULL;
+static QueueHandle_t xQueueResultO = NULL;
+
+static const char *TAG = "spi_data_send";
+/* 避开摄像头和IIC(47/48)使用的引脚
+ * 输入引脚只能承受3.3V，5V主机（Arduino）的 SCLK MOSI CS 要经电平转换或电阻分压后接入 */
+static const int mosiPin = 1;
+static const int misoPin = 2;
+static const int sclkPin = 42;
+static const int csPin = 41;
+static const int handshakePin = 14;
+
+static color_result_t color_result;
+
+/* 事务已装入SPI硬件，通知主机可以读取 */
+static void IRAM_ATTR spi_post_setup(spi_slave_transaction_t *trans)
+{
+  gpio_set_level((gpio_num_t)handshakePin, 1);
+}
+
+static void IRAM_ATTR spi_post_trans(spi_slave_transaction_t *trans)
+{
+  gpio_set_level((gpio_num_t)handshakePin, 0);
+}
+
+static void put_u16(uint8_t *p, int64_t v)
+{
+  if (v < 0) v = 0;
+  if (v > 0xFFFF) v = 0xFFFF;
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+/* 把检测结果打包成一帧 */
+static void pack_frame(uint8_t *frame, const color_result_t *result)
+{
+  uint8_t *payload = frame + RESULT_FRAME_HEAD;
+  memset(payload, 0, RESULT_PAYLOAD_MAX);
+  for (int i = 0; i < COLOR_NUM; ++i)
+  {
+    uint8_t *p = &payload[RESULT_OFS_COLOR + i * 4];
+    p[0] = result->color[i].center_x;
+    p[1] = result->color[i].center_y;
+    p[2] = result->color[i].width;
+    p[3] = result->color[i].length;
+  }
+  /* 目标位置预测到组帧时刻，帧在下一次主机读取前发出 */
+  int64_t dt = esp_timer_get_time() - result->track_us;
+  for (int i = 0; i < COLOR_NUM; ++i)
+  {
+    payload[RESULT_OFS_TRACK_NUM + i] = result->track_num[i];
+    for (int k = 0; k < result->track_num[i]; ++k)
+    {
+      track_info_pack(&result->track[i][k], dt, &payload[RESULT_OFS_TRACK + (i * RESULT_TRACK_K + k) * 8]);
+    }
+  }
+  put_u16(&payload[RESULT_OFS_TIMING], (result->detect_start_us - result->capture_us) / 1000);
+  put_u16(&payload[RESULT_OFS_TIMING + 2], (result->detect_end_us - result->detect_start_us) / 1000);
+  result_frame_seal(frame, result->seq, RESULT_PAYLOAD_LEN, result->unchanged ? RESULT_FLAG_UNCHANGED : 0);
+}
+
+static void task_process_handler(void *arg)
+{
+  static_assert(COLOR_NUM == RESULT_COLOR_NUM && TRACK_TOP_K == RESULT_TRACK_K, "result_frame.h layout");
+
+  gpio_config_t io = {};
+  io.pin_bit_mask = 1ULL << handshakePin;
+  io.mode = GPIO_MODE_OUTPUT;
+  gpio_config(&io);
+  gpio_set_level((gpio_num_t)handshakePin, 0);
+
+  spi_bus_config_t bus = {};
+  bus.mosi_io_num = mosiPin;
+  bus.miso_io_num = misoPin;
+  bus.sclk_io_num = sclkPin;
+  bus.quadwp_io_num = -1;
+  bus.quadhd_io_num = -1;
+  spi_slave_interface_config_t slave = {};
+  slave.spics_io_num = csPin;
+  slave.mode = 0;
+  slave.queue_size = 1;
+  slave.post_setup_cb = spi_post_setup;
+  slave.post_trans_cb = spi_post_trans;
+  /* 主机CS未接时保持空闲 */
+  gpio_set_pull_mode((gpio_num_t)csPin, GPIO_PULLUP_ONLY);
+  gpio_set_pull_mode((gpio_num_t)sclkPin, GPIO_PULLDOWN_ONLY);
+  if (spi_slave_initialize(SPI_SLAVE_HOST, &bus, &slave, SPI_DMA_CH_AUTO) != ESP_OK)
+  {
+    ESP_LOGE(TAG, "spi slave init failed");
+    vTaskDelete(NULL);
+  }
+
+  /* DMA缓冲，主机发送的数据不使用 */
+  uint8_t *tx = (uint8_t *)heap_caps_malloc(RESULT_FRAME_SIZE, MALLOC_CAP_DMA);
+  uint8_t *rx = (uint8_t *)heap_caps_malloc(RESULT_FRAME_SIZE, MALLOC_CAP_DMA);
+  spi_slave_transaction_t trans = {};
+  spi_slave_transaction_t *done;
+  bool pending = false;
+  bool fresh = false; /* color_result 里有还没装入SPI的结果 */
+
+  while (true)
+  {
+    /* 有结果在等时只短暂阻塞，旧帧一被读走就装入最新结果 */
+    if (xQueueReceive(xQueueResultI, &color_result, fresh ? pdMS_TO_TICKS(2) : portMAX_DELAY))
+    {
+      fresh = true;
+    }
+    if (!fresh)
+    {
+      continue;
+    }
+    if (pending && spi_slave_get_trans_result(SPI_SLAVE_HOST, &done, 0) == ESP_OK)
+    {
+      pending = false;
+    }
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+    /* 撤回还没被读走的旧帧，换成最新结果；撤回时正被读的半帧过不了CRC，主机会丢弃 */
+    if (pending)
+    {
+      gpio_set_level((gpio_num_t)handshakePin, 0);
+      if (spi_slave_queue_reset(SPI_SLAVE_HOST) == ESP_OK)
+      {
+        pending = false;
+      }
+      else
+      {
+        gpio_set_level((gpio_num_t)handshakePin, 1);
+      }
+    }
+#endif
+    /* 不能撤回时旧帧读走前缓冲不能改动，期间的中间结果被新结果覆盖 */
+    if (pending)
+    {
+      continue;
+    }
+    pack_frame(tx, &color_result);
+    trans.length = RESULT_FRAME_SIZE * 8;
+    trans.tx_buffer = tx;
+    trans.rx_buffer = rx;
+    pending = spi_slave_queue_trans(SPI_SLAVE_HOST, &trans, 0) == ESP_OK;
+    fresh = !pending;
+  }
+}
+
+void register_spi_data_send(const QueueHandle_t result_i,
+                            const QueueHandle_t result_o)
+{
+  xQueueResultI = result_i;
+  xQueueResultO = result_o;
+
+  xTaskCreatePinnedToCore(task_process_handler, TAG, 4 * 1024, NULL, 5, NULL, 1);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+/**
+ * @brief Send color results to the Arduino as fixed-size SPI frames (see result_frame.h)
+ *
+ * The ESP32 is the SPI slave with DMA. A frame is queued for every new result and the
+ * handshake pin goes high while it is waiting for the master, so the master only clocks
+ * out fresh frames.
+ *
+ * @param result_i  queue of color_result_t
+ * @param result_o  unused
+ */
+void register_spi_data_send(const QueueHandle_t result_i,
+                            const QueueHandle_t result_o);
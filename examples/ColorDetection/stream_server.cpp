@@ -0,0 +1,184 @@
+#include "stream_server.hpp"
+#include "fps_stat.h"
+#include "esp_log.h"
+#include "esp_camera.h"
+#include "esp_timer.h"
+#include "esp_http_server.h"
+#include "img_converters.h"
+#include <stdio.h>
+
+#define PART_BOUNDARY "123456789000000000000987654321"
+static const char *STREAM_CONTENT_TYPE = "multipart/x-mixed-replace;boundary=" PART_BOUNDARY;
+static const char *STREAM_BOUNDARY = "\r\n--" PART_BOUNDARY "\r\n";
+static const char *STREAM_PART = "Content-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n";
+
+static const char *TAG = "stream_server";
+
+static QueueHandle_t xQueueFrameI = NULL;
+static bool gReturnFB = true;
+
+typedef struct
+{
+  uint8_t *buf;
+  size_t len;
+} jpeg_frame_t;
+
+/* 编码任务与HTTP连接之间用长度为1的队列传JPEG，缓冲随队列元素一起转交，由取出的一方释放 */
+static QueueHandle_t xQueueJpeg = NULL;
+static volatile bool client_active = false;
+
+static void return_frame(camera_fb_t *frame)
+{
+  if (gReturnFB)
+  {
+    esp_camera_fb_return(frame);
+  }
+  else
+  {
+    free(frame);
+  }
+}
+
+static void task_process_handler(void *arg)
+{
+  camera_fb_t *frame = NULL;
+  int64_t last_frame_us = 0;
+  while (true)
+  {
+    if (xQueueReceive(xQueueFrameI, &frame, portMAX_DELAY))
+    {
+      int64_t now = esp_timer_get_time();
+      /* 有连接、上一张已取走且到了发送时间才编码，直接读取帧缓冲，不额外拷贝 */
+      if (client_active && uxQueueSpacesAvailable(xQueueJpeg) && now - last_frame_us >= 1000000 / STREAM_MAX_FPS)
+      {
+        jpeg_frame_t jpeg = {};
+        bool ok = frame2jpg(frame, STREAM_JPEG_QUALITY, &jpeg.buf, &jpeg.len);
+        return_frame(frame);
+        if (ok)
+        {
+          last_frame_us = now;
+          if (xQueueSend(xQueueJpeg, &jpeg, 0) != pdTRUE)
+          {
+            free(jpeg.buf);
+          }
+        }
+      }
+      else
+      {
+        return_frame(frame);
+        if (client_active)
+        {
+          fps_stat_tick(FPS_STREAM_DROP);
+        }
+      }
+    }
+  }
+}
+
+/* 释放队列里没有发出的JPEG，可能是上一个连接断开后编码任务才放进来的 */
+static void jpeg_drain(void)
+{
+  jpeg_frame_t jpeg;
+  while (xQueueReceive(xQueueJpeg, &jpeg, 0))
+  {
+    free(jpeg.buf);
+  }
+}
+
+/* 推流在81端口单独的httpd里循环发送，同一时间只有一个推流连接，后来的连接排队到前一个关闭 */
+static esp_err_t stream_handler(httpd_req_t *req)
+{
+  esp_err_t res = httpd_resp_set_type(req, STREAM_CONTENT_TYPE);
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  jpeg_drain();
+  client_active = true;
+
+  char part[64];
+  jpeg_frame_t jpeg;
+  while (res == ESP_OK)
+  {
+    if (!xQueueReceive(xQueueJpeg, &jpeg, pdMS_TO_TICKS(1000)))
+    {
+      continue;
+    }
+    size_t hlen = snprintf(part, sizeof(part), STREAM_PART, (unsigned)jpeg.len);
+    res = httpd_resp_send_chunk(req, STREAM_BOUNDARY, strlen(STREAM_BOUNDARY));
+    if (res == ESP_OK)
+    {
+      res = httpd_resp_send_chunk(req, part, hlen);
+    }
+    if (res == ESP_OK)
+    {
+      res = httpd_resp_send_chunk(req, (const char *)jpeg.buf, jpeg.len);
+    }
+    free(jpeg.buf);
+    fps_stat_tick(FPS_STREAM);
+  }
+  client_active = false;
+  jpeg_drain();
+  ESP_LOGI(TAG, "stream closed");
+  return res;
+}
+
+static esp_err_t status_handler(httpd_req_t *req)
+{
+  char json[160];
+  int len = snprintf(json, sizeof(json), "{");
+  for (int i = 0; i < FPS_STAT_NUM; ++i)
+  {
+    len += snprintf(json + len, sizeof(json) - len, "%s\"%s\":%.1f", i ? "," : "", fps_stat_name((fps_stat_id_t)i), fps_stat_rate((fps_stat_id_t)i));
+  }
+  snprintf(json + len, sizeof(json) - len, "}");
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+  return httpd_resp_sendstr(req, json);
+}
+
+static esp_err_t index_handler(httpd_req_t *req)
+{
+  static const char *html = "<html><body><img id=\"s\"><script>"
+                            "document.getElementById('s').src='http://'+location.hostname+':%d/stream';"
+                            "</script></body></html>";
+  char page[160];
+  snprintf(page, sizeof(page), html, STREAM_PORT);
+  httpd_resp_set_type(req, "text/html");
+  return httpd_resp_sendstr(req, page);
+}
+
+void register_stream_server(const QueueHandle_t frame_i,
+                            const bool camera_fb_return)
+{
+  xQueueFrameI = frame_i;
+  gReturnFB = camera_fb_return;
+  xQueueJpeg = xQueueCreate(1, sizeof(jpeg_frame_t));
+
+  /* HTTP服务与编码都在核心0上，优先级低于核心1上的检测任务 */
+  httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+  config.server_port = CTRL_PORT;
+  config.core_id = 0;
+  config.task_priority = 2;
+  httpd_handle_t ctrl_server = NULL;
+  if (httpd_start(&ctrl_server, &config) != ESP_OK)
+  {
+    ESP_LOGE(TAG, "httpd start failed");
+    return;
+  }
+  httpd_uri_t index_uri = {"/", HTTP_GET, index_handler, NULL};
+  httpd_uri_t status_uri = {"/status", HTTP_GET, status_handler, NULL};
+  httpd_register_uri_handler(ctrl_server, &index_uri);
+  httpd_register_uri_handler(ctrl_server, &status_uri);
+
+  /* 推流的handler一直占着所在的httpd任务，放在第二个httpd里，与 CameraWebServer 相同 */
+  config.server_port = STREAM_PORT;
+  config.ctrl_port += 1;
+  httpd_handle_t stream_server = NULL;
+  if (httpd_start(&stream_server, &config) != ESP_OK)
+  {
+    ESP_LOGE(TAG, "stream httpd start failed");
+    return;
+  }
+  httpd_uri_t stream_uri = {"/stream", HTTP_GET, stream_handler, NULL};
+  httpd_register_uri_handler(stream_server, &stream_uri);
+
+  xTaskCreatePinnedToCore(task_process_handler, TAG, 4 * 1024, NULL, 2, NULL, 0);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+/* 推流的最高帧率，编码在核心0上低优先级运行，超出的帧直接归还 */
+#define STREAM_MAX_FPS 8
+#define STREAM_JPEG_QUALITY 60
+#define STREAM_PORT 81
+#define CTRL_PORT 80
+
+/**
+ * @brief Serve the frames after detection as MJPEG at http://<ip>:81/stream, the fps_stat rates as JSON at
+ *        http://<ip>/status and a page showing the stream at http://<ip>/
+ *
+ * Frames are taken from frame_i and encoded straight from the camera frame buffer on core 0,
+ * only while a client is connected and at most STREAM_MAX_FPS; all other frames are returned at once.
+ * The stream runs in its own httpd on port 81 so that / and /status on port 80 stay responsive.
+ *
+ * @param frame_i           frames from the detection task, created with length 1
+ * @param camera_fb_return  return the frames to the camera driver, otherwise free them
+ */
+void register_stream_server(const QueueHandle_t frame_i,
+                            const bool camera_fb_return);
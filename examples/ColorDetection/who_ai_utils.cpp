@@ -3,6 +3,9 @@
 #include "esp_log.h"
 #include "esp_camera.h"
 
+#include "esp_heap_caps.h"
+#include "esp_jpg_decode.h"
+
 #include "dl_image.hpp"
 
 static const char *TAG = "ai_utils";
@@ -100,7 +103,7 @@ void *app_camera_decode(camera_fb_t *fb)
             else
             {
                 ESP_LOGE(TAG, "fmt2rgb888 failed");
-                dl::tool::free_aligned(image_ptr);
+                free(image_ptr);
             }
         }
         else
@@ -109,4 +112,253 @@ void *app_camera_decode(camera_fb_t *fb)
         }
     }
     return NULL;
+}
+
+static inline void decode_put_pixel(uint8_t *dst, decode_format_t format, const uint8_t *lut, uint8_t r, uint8_t g, uint8_t b)
+{
+    switch (format)
+    {
+    case DECODE_CLASS:
+        dst[0] = lut[((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)];
+        break;
+    case DECODE_RGB565:
+        dst[0] = (r & 0xF8) | (g >> 5);
+        dst[1] = ((g & 0x1C) << 3) | (b >> 3);
+        break;
+    case DECODE_RGB888:
+        dst[0] = b;
+        dst[1] = g;
+        dst[2] = r;
+        break;
+    default:
+        dst[0] = (uint8_t)((r * 77 + g * 150 + b * 29) >> 8);
+        break;
+    }
+}
+
+static inline int decode_pixel_bytes(decode_format_t format)
+{
+    return format == DECODE_RGB565 ? 2 : (format == DECODE_RGB888 ? 3 : 1);
+}
+
+void decode_buffer_init(decode_buffer_t *out, size_t capacity)
+{
+    memset(out, 0, sizeof(decode_buffer_t));
+    out->capacity = capacity;
+}
+
+uint8_t *decode_class_lut_create(const std::vector<std::vector<uint8_t>> &color_thresh)
+{
+    // looked up once per pixel, keep it in internal SRAM so it does not compete with the PSRAM frame for the cache
+    uint8_t *lut = (uint8_t *)heap_caps_malloc(65536, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (lut == NULL)
+    {
+        lut = (uint8_t *)heap_caps_malloc(65536, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    }
+    if (lut == NULL)
+    {
+        ESP_LOGE(TAG, "malloc memory for class lut failed");
+        return NULL;
+    }
+    int num = DL_MIN((int)color_thresh.size(), 8);
+    for (int v565 = 0; v565 < 65536; ++v565)
+    {
+        int r = ((v565 >> 8) & 0xF8) | (v565 >> 13);
+        int g = ((v565 >> 3) & 0xFC) | ((v565 >> 9) & 0x03);
+        int b = ((v565 << 3) & 0xF8) | ((v565 >> 2) & 0x07);
+        // same scale as OpenCV 8-bit HSV: h 0~180, s and v 0~255
+        int max = DL_MAX(r, DL_MAX(g, b)), min = DL_MIN(r, DL_MIN(g, b)), diff = max - min;
+        int s = max ? diff * 255 / max : 0;
+        int h = 0;
+        if (diff)
+        {
+            h = max == r ? 60 * (g - b) / diff : (max == g ? 120 + 60 * (b - r) / diff : 240 + 60 * (r - g) / diff);
+            h = (h < 0 ? h + 360 : h) / 2;
+        }
+        uint8_t mask = 0;
+        for (int i = 0; i < num; ++i)
+        {
+            const std::vector<uint8_t> &t = color_thresh[i];
+            bool in_h = t[0] <= t[1] ? (h >= t[0] && h <= t[1]) : (h >= t[0] || h <= t[1]);
+            if (in_h && s >= t[2] && s <= t[3] && max >= t[4] && max <= t[5])
+            {
+                mask |= 1 << i;
+            }
+        }
+        lut[v565] = mask;
+    }
+    return lut;
+}
+
+static bool decode_buffer_prepare(decode_buffer_t *out, decode_format_t format, int height, int width)
+{
+    size_t size = (size_t)height * width * decode_pixel_bytes(format);
+    if (size > out->capacity)
+    {
+        ESP_LOGE(TAG, "decode output %dx%d needs %u bytes, buffer has %u", width, height, (unsigned)size, (unsigned)out->capacity);
+        return false;
+    }
+    if (out->buf == NULL)
+    {
+        out->buf = (uint8_t *)heap_caps_malloc(out->capacity, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (out->buf == NULL)
+        {
+            out->buf = (uint8_t *)malloc(out->capacity);
+        }
+        if (out->buf == NULL)
+        {
+            ESP_LOGE(TAG, "malloc memory for decode buffer failed");
+            return false;
+        }
+    }
+    out->data = out->buf;
+    out->format = format;
+    out->height = height;
+    out->width = width;
+    return true;
+}
+
+typedef struct
+{
+    const camera_fb_t *fb;
+    decode_buffer_t *out;
+    const uint8_t *lut;
+    int x0; // ROI in decoded (scaled) pixels
+    int y0;
+} jpg_decode_ctx_t;
+
+static size_t jpg_decode_read(void *arg, size_t index, uint8_t *buf, size_t len)
+{
+    jpg_decode_ctx_t *ctx = (jpg_decode_ctx_t *)arg;
+    if (buf)
+    {
+        memcpy(buf, ctx->fb->buf + index, len);
+    }
+    return len;
+}
+
+// called per decoded block (RGB888), only pixels inside the ROI are converted
+static bool jpg_decode_write(void *arg, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t *data)
+{
+    if (!data)
+    {
+        return true;
+    }
+    jpg_decode_ctx_t *ctx = (jpg_decode_ctx_t *)arg;
+    decode_buffer_t *out = ctx->out;
+    int bpp = decode_pixel_bytes(out->format);
+    int ix0 = DL_MAX((int)x, ctx->x0), ix1 = DL_MIN((int)x + w, ctx->x0 + out->width);
+    int iy0 = DL_MAX((int)y, ctx->y0), iy1 = DL_MIN((int)y + h, ctx->y0 + out->height);
+    for (int iy = iy0; iy < iy1; ++iy)
+    {
+        const uint8_t *src = data + ((iy - y) * w + (ix0 - x)) * 3;
+        uint8_t *dst = out->buf + ((iy - ctx->y0) * out->width + (ix0 - ctx->x0)) * bpp;
+        for (int ix = ix0; ix < ix1; ++ix, src += 3, dst += bpp)
+        {
+            decode_put_pixel(dst, out->format, ctx->lut, src[0], src[1], src[2]);
+        }
+    }
+    return true;
+}
+
+bool app_camera_decode_into(camera_fb_t *fb, const decode_option_t *opt, decode_buffer_t *out)
+{
+    decode_option_t full = {DECODE_RGB565, 1, 0, 0, 0, 0, NULL};
+    if (opt == NULL)
+    {
+        opt = &full;
+    }
+    int scale = opt->scale;
+    if (scale != 1 && scale != 2 && scale != 4 && scale != 8)
+    {
+        ESP_LOGE(TAG, "decode scale %d is not supported", scale);
+        return false;
+    }
+    if (opt->format == DECODE_CLASS && opt->lut == NULL)
+    {
+        ESP_LOGE(TAG, "DECODE_CLASS needs a lut");
+        return false;
+    }
+    int rx = 0, ry = 0, rw = fb->width, rh = fb->height;
+    if (opt->roi_w > 0 && opt->roi_h > 0)
+    {
+        rx = DL_MAX(opt->roi_x, 0);
+        ry = DL_MAX(opt->roi_y, 0);
+        rw = DL_MIN(opt->roi_x + opt->roi_w, (int)fb->width) - rx;
+        rh = DL_MIN(opt->roi_y + opt->roi_h, (int)fb->height) - ry;
+        if (rw <= 0 || rh <= 0)
+        {
+            ESP_LOGE(TAG, "decode ROI is outside the frame");
+            return false;
+        }
+    }
+    int ow = rw / scale, oh = rh / scale;
+
+    if (fb->format == PIXFORMAT_JPEG)
+    {
+        static const jpg_scale_t jpg_scales[] = {JPG_SCALE_NONE, JPG_SCALE_2X, JPG_SCALE_NONE, JPG_SCALE_4X,
+                                                 JPG_SCALE_NONE, JPG_SCALE_NONE, JPG_SCALE_NONE, JPG_SCALE_8X};
+        if (!decode_buffer_prepare(out, opt->format, oh, ow))
+        {
+            return false;
+        }
+        // downscale is done by the decoder during IDCT
+        jpg_decode_ctx_t ctx = {fb, out, opt->lut, rx / scale, ry / scale};
+        if (esp_jpg_decode(fb->len, jpg_scales[scale - 1], jpg_decode_read, jpg_decode_write, &ctx) != ESP_OK)
+        {
+            ESP_LOGE(TAG, "jpeg decode failed");
+            return false;
+        }
+        return true;
+    }
+
+    if (fb->format != PIXFORMAT_RGB565 && fb->format != PIXFORMAT_GRAYSCALE)
+    {
+        ESP_LOGE(TAG, "decode format %d is not supported", fb->format);
+        return false;
+    }
+    decode_format_t in_format = fb->format == PIXFORMAT_RGB565 ? DECODE_RGB565 : DECODE_GRAY;
+    if (in_format == opt->format && scale == 1 && rw == (int)fb->width && rh == (int)fb->height)
+    {
+        out->data = fb->buf;
+        out->format = in_format;
+        out->height = fb->height;
+        out->width = fb->width;
+        return true;
+    }
+    if (!decode_buffer_prepare(out, opt->format, oh, ow))
+    {
+        return false;
+    }
+    int in_bpp = decode_pixel_bytes(in_format), out_bpp = decode_pixel_bytes(opt->format);
+    for (int y = 0; y < oh; ++y)
+    {
+        const uint8_t *src = fb->buf + ((size_t)(ry + y * scale) * fb->width + rx) * in_bpp;
+        uint8_t *dst = out->buf + (size_t)y * ow * out_bpp;
+        if (in_format == opt->format && scale == 1)
+        {
+            memcpy(dst, src, ow * out_bpp);
+            continue;
+        }
+        for (int x = 0; x < ow; ++x, src += scale * in_bpp, dst += out_bpp)
+        {
+            if (in_format == DECODE_GRAY)
+            {
+                decode_put_pixel(dst, opt->format, opt->lut, src[0], src[0], src[0]);
+            }
+            else if (opt->format == DECODE_CLASS)
+            {
+                // the LUT is indexed by the camera RGB565 value as stored, no unpacking
+                dst[0] = opt->lut[(src[0] << 8) | src[1]];
+            }
+            else
+            {
+                uint8_t r = src[0] & 0xF8;
+                uint8_t g = ((src[0] & 0x07) << 5) | ((src[1] & 0xE0) >> 3);
+                uint8_t b = (src[1] & 0x1F) << 3;
+                decode_put_pixel(dst, opt->format, opt->lut, r, g, b);
+            }
+        }
+    }
+    return true;
 }
\ No newline at end of file
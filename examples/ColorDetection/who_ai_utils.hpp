@@ -1,6 +1,7 @@
 #pragma once
 
 #include <list>
+#include <vector>
 #include "dl_detect_define.hpp"
 #include "esp_camera.h"
 
@@ -35,8 +36,70 @@ void print_detection_result(std::list<dl::detect::result_t> &results);
 /**
  * @brief Decode fb , 
  *        - if fb->format == PIXFORMAT_RGB565, then return fb->buf
- *        - else, then return a new memory with RGB888, don't forget to free it
+ *        - else, then return a new memory with RGB888, don't forget to free it with free()
+ *        Allocates a full RGB888 frame per call, prefer app_camera_decode_into() in a frame loop.
  * 
  * @param fb 
  */
 void *app_camera_decode(camera_fb_t *fb);
+
+typedef enum
+{
+    DECODE_RGB565 = 0, /*!< 2 bytes per pixel, same byte order as camera RGB565 */
+    DECODE_RGB888,     /*!< 3 bytes per pixel, same order as fmt2rgb888() */
+    DECODE_GRAY,       /*!< 1 byte per pixel, luminance */
+    DECODE_CLASS,      /*!< 1 byte per pixel, bit i set when the pixel is inside color i of the LUT */
+} decode_format_t;
+
+typedef struct
+{
+    decode_format_t format; /*!< output format */
+    int scale;              /*!< downscale factor: 1, 2, 4 or 8 */
+    int roi_x;              /*!< ROI in source pixels, roi_w == 0 or roi_h == 0 means the whole frame */
+    int roi_y;
+    int roi_w;
+    int roi_h;
+    const uint8_t *lut;     /*!< DECODE_CLASS only, from decode_class_lut_create() */
+} decode_option_t;
+
+typedef struct
+{
+    uint8_t *buf;           /*!< reusable buffer, allocated once on first use */
+    size_t capacity;        /*!< size of buf in bytes */
+    uint8_t *data;          /*!< decoded image, either buf or fb->buf when no conversion is needed */
+    int height;
+    int width;
+    decode_format_t format;
+} decode_buffer_t;
+
+/**
+ * @brief Initialize a reusable decode buffer, memory is allocated on the first conversion and never freed
+ * 
+ * @param out       decode buffer
+ * @param capacity  largest output in bytes, e.g. 240 * 240 * 2 for a RGB565 240x240 frame
+ */
+void decode_buffer_init(decode_buffer_t *out, size_t capacity);
+
+/**
+ * @brief Build the per-pixel classification LUT for DECODE_CLASS: one byte per RGB565 value (65536 bytes)
+ * 
+ * @param color_thresh  up to 8 HSV ranges in ColorDetector order {h_min, h_max, s_min, s_max, v_min, v_max}, h in 0~180,
+ *                      h_min > h_max wraps around red
+ * @return LUT allocated once in internal SRAM (PSRAM if internal is full), NULL when out of memory
+ */
+uint8_t *decode_class_lut_create(const std::vector<std::vector<uint8_t>> &color_thresh);
+
+/**
+ * @brief Decode fb into a preallocated buffer, converting only the ROI at the requested scale and format.
+ *        - RGB565 / GRAYSCALE fb: out->data points to fb->buf when the output equals the input, else rows are converted into out->buf
+ *        - JPEG fb: decoded block by block, each block is converted straight into out->buf, no full RGB888 frame is allocated
+ *        - DECODE_CLASS: each pixel is one LUT lookup, RGB565 fb is indexed directly without unpacking
+ *        out->data stays valid until fb is returned or the next call.
+ * 
+ * @param fb   camera frame
+ * @param opt  output format, scale and ROI, NULL means RGB565 full frame
+ * @param out  decode buffer
+ * @return true  success
+ *         false unsupported format, buffer too small or decode failed
+ */
+bool app_camera_decode_into(camera_fb_t *fb, const decode_option_t *opt, decode_buffer_t *out);
@@ -1,18 +1,22 @@
 #include "camera_setting.h"
 #include "face_detection.hpp"
 #include "iic_data_send.hpp"
+#include "deferred_log.hpp"
 
 static QueueHandle_t xQueueAIFrame = NULL;
 static QueueHandle_t xQueueIICData = NULL;
 
 void setup() 
 {
+  Serial.begin(115200);
+  /* 注册日志输出任务，各任务的日志在核心0上输出，不阻塞检测 */
+  register_deferred_log();
   /* 创建图像传输队列 */
   xQueueAIFrame = xQueueCreate(2, sizeof(camera_fb_t *)); 
   /* 创建IIC数据传输队列 */
-  xQueueIICData = xQueueCreate(2, sizeof(iic_send_data_t *));
+  xQueueIICData = xQueueCreate(2, sizeof(target_face_information_t));
 
-  /* 注册摄像头处理任务 */
+  /* 注册摄像头处理任务，也可用PIXFORMAT_JPEG采集，检测任务会逐块解码到固定缓冲 */
   register_camera(PIXFORMAT_RGB565, FRAMESIZE_240X240, 4, xQueueAIFrame);
   /* 注册人脸检测任务 */
   register_human_face_detection(xQueueAIFrame, NULL, xQueueIICData, NULL, true);
@@ -0,0 +1,267 @@
+#include "deferred_log.hpp"
+#include "esp_timer.h"
+#include "Arduino.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "deferred_log";
+
+/* 单生产者（所属任务）单消费者（输出任务）环形缓冲，记录为 长度(2) + 文本 */
+typedef struct
+{
+  TaskHandle_t owner;
+  uint8_t *buf;
+  volatile uint32_t head;  // 只由所属任务写
+  volatile uint32_t tail;  // 只由输出任务写
+  volatile uint32_t dropped;
+} dlog_ring_t;
+
+static dlog_ring_t rings[DLOG_MAX_RINGS];
+static volatile int ring_num = 0;
+static dlog_tag_t *tags[DLOG_MAX_TAGS];
+static volatile int tag_num = 0;
+static portMUX_TYPE dlog_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char LEVEL_CHAR[] = {'N', 'E', 'W', 'I', 'D'};
+
+/* 查找当前任务的环形缓冲，第一次使用时分配 */
+static dlog_ring_t *task_ring(void)
+{
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  int num = __atomic_load_n(&ring_num, __ATOMIC_ACQUIRE);
+  for (int i = 0; i < num; ++i)
+  {
+    if (rings[i].owner == self)
+    {
+      return &rings[i];
+    }
+  }
+  uint8_t *buf = (uint8_t *)malloc(DLOG_RING_SIZE);
+  if (!buf)
+  {
+    return NULL;
+  }
+  dlog_ring_t *ring = NULL;
+  portENTER_CRITICAL(&dlog_mux);
+  if (ring_num < DLOG_MAX_RINGS)
+  {
+    ring = &rings[ring_num];
+    ring->owner = self;
+    ring->buf = buf;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+    __atomic_store_n(&ring_num, ring_num + 1, __ATOMIC_RELEASE);
+  }
+  portEXIT_CRITICAL(&dlog_mux);
+  if (!ring)
+  {
+    free(buf);
+  }
+  return ring;
+}
+
+static void tag_register(dlog_tag_t *tag)
+{
+  portENTER_CRITICAL(&dlog_mux);
+  if (!tag->registered && tag_num < DLOG_MAX_TAGS)
+  {
+    tags[tag_num] = tag;
+    tag->registered = true;
+    __atomic_store_n(&tag_num, tag_num + 1, __ATOMIC_RELEASE);
+  }
+  portEXIT_CRITICAL(&dlog_mux);
+}
+
+/* 令牌桶限流，多个任务共用一个标签时计数可能略有偏差 */
+static bool tag_allow(dlog_tag_t *tag)
+{
+  if (tag->rate == 0)
+  {
+    return true;
+  }
+  int64_t now = esp_timer_get_time();
+  tag->tokens += (now - tag->refill_us) * tag->rate / 1000000.0f;
+  if (tag->tokens > tag->rate)
+  {
+    tag->tokens = tag->rate;
+  }
+  tag->refill_us = now;
+  if (tag->tokens < 1.0f)
+  {
+    __atomic_fetch_add(&tag->suppressed, 1, __ATOMIC_RELAXED);
+    return false;
+  }
+  tag->tokens -= 1.0f;
+  return true;
+}
+
+static void ring_put(dlog_ring_t *ring, const uint8_t *data, uint32_t len)
+{
+  uint32_t head = ring->head;
+  for (uint32_t i = 0; i < len; ++i)
+  {
+    ring->buf[(head + i) % DLOG_RING_SIZE] = data[i];
+  }
+}
+
+void dlog_write(dlog_tag_t *tag, dlog_level_t level, const char *fmt, ...)
+{
+  /* 先登记标签，级别过滤掉的标签也能被 dlog_set_level 调高 */
+  if (!tag->registered)
+  {
+    tag_register(tag);
+  }
+  if (level > tag->level)
+  {
+    return;
+  }
+  if (!tag_allow(tag))
+  {
+    return;
+  }
+  dlog_ring_t *ring = task_ring();
+  if (!ring)
+  {
+    return;
+  }
+
+  char line[2 + DLOG_LINE_MAX];
+  int n = snprintf(line + 2, DLOG_LINE_MAX, "%c (%u) %s: ", LEVEL_CHAR[level], (unsigned)(esp_timer_get_time() / 1000), tag->name);
+  va_list args;
+  va_start(args, fmt);
+  int m = vsnprintf(line + 2 + n, DLOG_LINE_MAX - n, fmt, args);
+  va_end(args);
+  n = (m < 0) ? n : (n + m < DLOG_LINE_MAX - 1 ? n + m : DLOG_LINE_MAX - 1);
+  line[0] = n & 0xFF;
+  line[1] = n >> 8;
+
+  /* 空间不够时丢弃本条，不等待 */
+  uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+  uint32_t used = ring->head - tail;
+  if (DLOG_RING_SIZE - used < (uint32_t)n + 2)
+  {
+    __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  ring_put(ring, (const uint8_t *)line, n + 2);
+  __atomic_store_n(&ring->head, ring->head + n + 2, __ATOMIC_RELEASE);
+}
+
+int dlog_set_level(const char *name, uint8_t level)
+{
+  int changed = 0;
+  int num = __atomic_load_n(&tag_num, __ATOMIC_ACQUIRE);
+  for (int i = 0; i < num; ++i)
+  {
+    if (strcmp(name, "*") == 0 || strcmp(name, tags[i]->name) == 0)
+    {
+      tags[i]->level = level > DLOG_DEBUG ? DLOG_DEBUG : level;
+      changed++;
+    }
+  }
+  return changed;
+}
+
+/* 输出一个缓冲中的全部记录 */
+static void ring_flush(dlog_ring_t *ring)
+{
+  char line[DLOG_LINE_MAX + 2];
+  uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  uint32_t tail = ring->tail;
+  while (tail != head)
+  {
+    uint32_t n = ring->buf[tail % DLOG_RING_SIZE] | (ring->buf[(tail + 1) % DLOG_RING_SIZE] << 8);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+      line[i] = ring->buf[(tail + 2 + i) % DLOG_RING_SIZE];
+    }
+    line[n] = '\r';
+    line[n + 1] = '\n';
+    Serial.write((const uint8_t *)line, n + 2);
+    tail += n + 2;
+  }
+  __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+}
+
+/* 串口命令：log 列出标签；log <tag|*> <level> 设置等级（0无 1错误 2警告 3信息 4调试） */
+static void serial_command(char *cmd)
+{
+  char name[24];
+  int level;
+  if (strcmp(cmd, "log") == 0)
+  {
+    int num = __atomic_load_n(&tag_num, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < num; ++i)
+    {
+      Serial.printf("%s level:%d rate:%d/s\r\n", tags[i]->name, tags[i]->level, tags[i]->rate);
+    }
+  }
+  else if (sscanf(cmd, "log %23s %d", name, &level) == 2)
+  {
+    Serial.printf("log %s -> %d (%d tags)\r\n", name, level, dlog_set_level(name, level));
+  }
+}
+
+static void task_process_handler(void *arg)
+{
+  char cmd[40];
+  int cmd_len = 0;
+  int64_t last_report_us = esp_timer_get_time();
+  while (true)
+  {
+    int num = __atomic_load_n(&ring_num, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < num; ++i)
+    {
+      ring_flush(&rings[i]);
+    }
+
+    /* 每秒汇总被限流和缓冲满丢弃的条数 */
+    if (esp_timer_get_time() - last_report_us >= 1000000)
+    {
+      last_report_us = esp_timer_get_time();
+      int tnum = __atomic_load_n(&tag_num, __ATOMIC_ACQUIRE);
+      for (int i = 0; i < tnum; ++i)
+      {
+        uint32_t s = __atomic_exchange_n(&tags[i]->suppressed, 0, __ATOMIC_RELAXED);
+        if (s)
+        {
+          Serial.printf("W %s: %u lines rate limited\r\n", tags[i]->name, (unsigned)s);
+        }
+      }
+      for (int i = 0; i < num; ++i)
+      {
+        uint32_t d = __atomic_exchange_n(&rings[i].dropped, 0, __ATOMIC_RELAXED);
+        if (d)
+        {
+          Serial.printf("W %s: %u lines dropped, ring of %s full\r\n", TAG, (unsigned)d, pcTaskGetName(rings[i].owner));
+        }
+      }
+    }
+
+    while (Serial.available())
+    {
+      char c = Serial.read();
+      if (c == '\r' || c == '\n')
+      {
+        cmd[cmd_len] = '\0';
+        if (cmd_len)
+        {
+          serial_command(cmd);
+        }
+        cmd_len = 0;
+      }
+      else if (cmd_len < (int)sizeof(cmd) - 1)
+      {
+        cmd[cmd_len++] = c;
+      }
+    }
+    vTaskDelay(pdMS_TO_TICKS(DLOG_FLUSH_MS));
+  }
+}
+
+void register_deferred_log(void)
+{
+  xTaskCreatePinnedToCore(task_process_handler, TAG, 3 * 1024, NULL, 1, NULL, 0);
+}
@@ -5,10 +5,13 @@
 #include "human_face_detect_msr01.hpp"
 #include "human_face_detect_mnp01.hpp"
 #include "who_ai_utils.hpp"
+#include "motion_gate.hpp"
+#include "deferred_log.hpp"
 
 #define TWO_STAGE_ON 1
 
 static const char *TAG = "human_face_detection";
+static dlog_tag_t LOG_FACE = DLOG_TAG("face", DLOG_INFO, 5);
 
 static QueueHandle_t xQueueFrameI = NULL;
 static QueueHandle_t xQueueEvent = NULL;
@@ -42,21 +45,28 @@ static void task_process_handler(void *arg)
   HumanFaceDetectMNP01 detector2(0.4F, 0.3F, 10);
 #endif
 
+  /* RGB565采集时直接使用帧缓冲；JPEG采集时逐块解码到这块固定缓冲，不再每帧分配 */
+  decode_buffer_t image;
+  decode_buffer_init(&image, 240 * 240 * 2);
   while (true)
   {
-    if (xQueueReceive(xQueueFrameI, &frame, portMAX_DELAY))
+    /* 画面没有变化时跳过检测，重发上一次的结果 */
+    if (xQueueReceive(xQueueFrameI, &frame, portMAX_DELAY) &&
+        app_camera_decode_into(frame, NULL, &image) &&
+        motion_gate_check((const uint16_t *)image.data, image.height, image.width))
     {
+      detect_result.unchanged = 0;
 #if TWO_STAGE_ON
-      std::list<dl::detect::result_t> &detect_candidates = detector.infer((uint16_t *)frame->buf, {(int)frame->height, (int)frame->width, 3});
-      std::list<dl::detect::result_t> &detect_results = detector2.infer((uint16_t *)frame->buf, {(int)frame->height, (int)frame->width, 3}, detect_candidates);
+      std::list<dl::detect::result_t> &detect_candidates = detector.infer((uint16_t *)image.data, {image.height, image.width, 3});
+      std::list<dl::detect::result_t> &detect_results = detector2.infer((uint16_t *)image.data, {image.height, image.width, 3}, detect_candidates);
 #else
-      std::list<dl::detect::result_t> &detect_results = detector.infer((uint16_t *)frame->buf, {(int)frame->height, (int)frame->width, 3});
+      std::list<dl::detect::result_t> &detect_results = detector.infer((uint16_t *)image.data, {image.height, image.width, 3});
 #endif
       if (detect_results.size() > 0)
       {
-        draw_detection_result((uint16_t *)frame->buf, frame->height, frame->width, detect_results);
+        draw_detection_result((uint16_t *)image.data, image.height, image.width, detect_results);
         save_detection_result(detect_results);
-        printf("center_x:%d , center_y:%d , width:%d , length:%d\r\n",detect_result.center_x,detect_result.center_y,detect_result.width,detect_result.length);
+        DLOG_I(&LOG_FACE, "center_x:%d , center_y:%d , width:%d , length:%d",detect_result.center_x,detect_result.center_y,detect_result.width,detect_result.length);
       }
       else
       {
@@ -67,6 +77,10 @@ static void task_process_handler(void *arg)
       }
 
     }
+    else
+    {
+      detect_result.unchanged = 1;
+    }
     if (xQueueFrameO)
     {
       xQueueSend(xQueueFrameO, &frame, portMAX_DELAY);
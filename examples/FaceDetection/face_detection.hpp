@@ -11,6 +11,7 @@ typedef struct
   uint8_t center_y;
   uint8_t width;
   uint8_t length;
+  uint8_t unchanged;  // 1: 画面没有变化，重发上一次的结果
 } target_face_information_t;
 
 
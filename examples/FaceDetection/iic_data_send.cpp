@@ -1,4 +1,6 @@
 #include "iic_data_send.hpp"
+#include "face_detection.hpp"
+#include "deferred_log.hpp"
 #include "Wire.h"
 
 #define I2C_SLAVE_ADDRESS 0x52
@@ -11,29 +13,50 @@ static const int sdaPin = 47;
 static const int sclPin = 48;
 static const uint32_t i2cFrequency = 100000;
 
-static iic_send_data_t send_data;
+/* 任务写入的最新结果，请求回调在同一把锁内拷贝一份再使用 */
+static portMUX_TYPE result_mux = portMUX_INITIALIZER_UNLOCKED;
+static target_face_information_t shared_data;
+static target_face_information_t send_data;
 
 static uint8_t rec;
 static uint8_t data[4] = {0};
 
 static void iic_receive(int len)
 {
-  while(Wire.available())
+  if(Wire.available())
   {
     rec = Wire.read();
-  }  
+  }
+  /* 写寄存器 0x31：所有日志标签的等级 */
+  if(rec == 0x31 && Wire.available())
+  {
+    dlog_set_level("*", Wire.read());
+  }
+  while(Wire.available())
+  {
+    Wire.read();
+  }
 }
 
 static void iic_request()
 {
+  portENTER_CRITICAL(&result_mux);
+  send_data = shared_data;
+  portEXIT_CRITICAL(&result_mux);
   if(rec == 0x01)
   {
     data[0] = send_data.center_x;
     data[1] = send_data.center_y;
-    data[2] = send_data.detection_width;
-    data[3] = send_data.detection_length;
+    data[2] = send_data.width;
+    data[3] = send_data.length;
     Wire.slaveWrite(data, sizeof(data));
   }
+  /* 状态寄存器 0x03：bit0 画面没有变化，结果是重发的 */
+  else if(rec == 0x03)
+  {
+    data[0] = send_data.unchanged ? IIC_STATUS_UNCHANGED : 0;
+    Wire.slaveWrite(data, 1);
+  }
 }
 
 static void task_process_handler(void *arg)
@@ -45,11 +68,14 @@ static void task_process_handler(void *arg)
   /* 注册请求数据的回调函数 */
   Wire.onRequest(iic_request);
 
+  target_face_information_t incoming;
   while (true)
   {
-    if (xQueueReceive(xQueueResultI, &send_data, portMAX_DELAY))
+    if (xQueueReceive(xQueueResultI, &incoming, portMAX_DELAY))
     {
-
+      portENTER_CRITICAL(&result_mux);
+      shared_data = incoming;
+      portEXIT_CRITICAL(&result_mux);
     }
   }
 
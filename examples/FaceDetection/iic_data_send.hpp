@@ -5,14 +5,8 @@
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 
-typedef struct
-{
-  uint8_t center_x;
-  uint8_t center_y;
-  uint8_t detection_width;
-  uint8_t detection_length;
-}iic_send_data_t;
-
+/* 状态寄存器 0x03 的位：1 表示画面没有变化，当前发布的结果是上一次结果的重发 */
+#define IIC_STATUS_UNCHANGED 0x01
 
 void register_iic_data_send(const QueueHandle_t result_i,
                             const QueueHandle_t result_o);
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+/* ColorDetection 与 FaceDetection 各有一份，两份内容保持一致，修改时同步 */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* 亮度特征为 MOTION_GRID x MOTION_GRID 个格子，每格取4个像素的平均亮度 */
+#define MOTION_GRID 16
+/* 格子亮度变化超过该值(0~255)视为该格变化 */
+#define MOTION_CELL_THRESH 12
+/* 变化的格子数达到该值视为画面变化 */
+#define MOTION_CELLS 2
+/* 画面不变时最多间隔该时间也要检测一次（默认值，可用 motion_gate_set_max_age 修改） */
+#define MOTION_MAX_AGE_MS 500
+
+/**
+ * @brief Compare the subsampled luminance of a RGB565 frame with the last detected frame
+ *
+ * @param frame   frame buffer
+ * @param height  frame height
+ * @param width   frame width
+ * @return true if detection should run: the scene changed, the last detection is older than MOTION_MAX_AGE_MS, or no frame was detected yet
+ */
+bool motion_gate_check(const uint16_t *frame, int height, int width);
+
+/**
+ * @brief Whether the last motion_gate_check saw the scene change (not only the max age expiring)
+ */
+bool motion_gate_changed(void);
+
+/**
+ * @brief Set how long a static scene may go without detection
+ *
+ * @param ms  max age in milliseconds
+ */
+void motion_gate_set_max_age(uint32_t ms);
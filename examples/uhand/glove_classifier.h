@@ -0,0 +1,45 @@
+/*
+ * 体感手套数字识别
+ * 六路模拟量（A0~A5，接手套的弯曲传感器）归一化到 0~255 后，
+ * 与 Flash 中的质心表做整数 L1 最近质心分类，得到数字 0~10，距离超过阈值则为未知
+ * 输出需连续 confirm 次相同才改变（去抖）
+ * 质心表由 scripts/glove/train_glove.py 从串口记录的样本训练生成 glove_model.h
+ */
+
+#ifndef __HW_GLOVE_CLASSIFIER_H_
+#define __HW_GLOVE_CLASSIFIER_H_
+
+#include <Arduino.h>
+
+#define GLOVE_CHANNELS 6
+#define GLOVE_UNKNOWN 0xFF
+
+typedef struct
+{
+  uint8_t num;              // 质心个数
+  uint16_t reject;          // L1 距离超过该值判为未知
+  const uint16_t *offset;   // PROGMEM，每通道零点
+  const uint16_t *scale;    // PROGMEM，每通道缩放(Q8)：(raw - offset) * scale >> 8
+  const uint8_t *centroids; // PROGMEM，每个质心 {数字, c0..c5}
+} glove_model_t;
+
+class HW_GloveClassifier{
+  public:
+    //初始化，confirm为去抖需要的连续相同次数
+    void begin(const glove_model_t *model, uint8_t confirm);
+    //单次分类，返回数字或 GLOVE_UNKNOWN，dist返回最近距离
+    uint8_t classify(const uint16_t *raw, uint16_t *dist = NULL);
+    //输入一次采样并去抖，输出改变时返回true
+    bool update(const uint16_t *raw);
+    //去抖后的数字
+    uint8_t result(void) { return stable; }
+
+  private:
+    const glove_model_t *model;
+    uint8_t confirm;
+    uint8_t candidate = GLOVE_UNKNOWN;
+    uint8_t count = 0;
+    uint8_t stable = GLOVE_UNKNOWN;
+};
+
+#endif //__HW_GLOVE_CLASSIFIER_H_
@@ -0,0 +1,19 @@
+/*
+ * 由 scripts/glove/train_glove.py 生成，请勿手动修改
+ * 空模型，识别结果始终为未知，请先记录样本并训练
+ */
+
+#ifndef __GLOVE_MODEL_H_
+#define __GLOVE_MODEL_H_
+
+#include "glove_classifier.h"
+
+static const uint16_t glove_offset[GLOVE_CHANNELS] PROGMEM = { 0, 0, 0, 0, 0, 0 };
+static const uint16_t glove_scale[GLOVE_CHANNELS] PROGMEM = { 64, 64, 64, 64, 64, 64 };
+static const uint8_t glove_centroids[][GLOVE_CHANNELS + 1] PROGMEM = {
+  { 255, 0, 0, 0, 0, 0, 0 },  // 占位，num 为 0 时不会使用
+};
+
+static const glove_model_t GLOVE_MODEL = { 0, 0, glove_offset, glove_scale, &glove_centroids[0][0] };
+
+#endif //__GLOVE_MODEL_H_
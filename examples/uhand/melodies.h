@@ -0,0 +1,38 @@
+/*
+ * 由 scripts/melody/melody2progmem.py 从 melodies.txt 生成，请勿手动修改
+ */
+
+#ifndef __MELODIES_H_
+#define __MELODIES_H_
+
+#include <Arduino.h>
+#include "melody.h"
+
+// C5/100
+const uint8_t MELODY_BEEP_LOW[] PROGMEM = { 72, 10, 255 };
+// C6/100
+const uint8_t MELODY_BEEP[] PROGMEM = { 84, 10, 255 };
+// C6/300
+const uint8_t MELODY_BEEP_MID[] PROGMEM = { 84, 30, 255 };
+// C6/800
+const uint8_t MELODY_BEEP_LONG[] PROGMEM = { 84, 80, 255 };
+// C6/0
+const uint8_t MELODY_BEEP_HOLD[] PROGMEM = { 84, 0, 255 };
+// C6/10000
+const uint8_t MELODY_BEEP_APP[] PROGMEM = { 84, 255, 84, 255, 84, 255, 84, 235, 255 };
+// C5/150 D5/150 E5/150
+const uint8_t MELODY_DO_RE_MI[] PROGMEM = { 72, 15, 74, 15, 76, 15, 255 };
+// E5/150 D5/150 C5/150
+const uint8_t MELODY_MI_RE_DO[] PROGMEM = { 76, 15, 74, 15, 72, 15, 255 };
+// G4/120 C5/120 E5/120 G5/240 R/60 C6/360
+const uint8_t MELODY_GAME_START[] PROGMEM = { 67, 12, 72, 12, 76, 12, 79, 24, 0, 6, 84, 36, 255 };
+// A5/80 R/40 A5/80
+const uint8_t MELODY_GAME_ROUND[] PROGMEM = { 81, 8, 0, 4, 81, 8, 255 };
+// C5/120 E5/120 G5/120 C6/240 R/60 G5/120 C6/480
+const uint8_t MELODY_GAME_WIN[] PROGMEM = { 72, 12, 76, 12, 79, 12, 84, 24, 0, 6, 79, 12, 84, 48, 255 };
+// G4/200 F#4/200 F4/200 E4/600
+const uint8_t MELODY_GAME_LOSE[] PROGMEM = { 67, 20, 66, 20, 65, 20, 64, 60, 255 };
+
+// total 82 bytes of flash
+
+#endif //__MELODIES_H_
@@ -0,0 +1,102 @@
+/*
+ * 蜂鸣器旋律播放器
+ */
+#include "melody.h"
+
+// MIDI 120~131 (C9~B9) 的频率，低八度依次右移一位
+static const uint16_t top_octave[12] PROGMEM = {
+  8372, 8870, 9397, 9956, 10548, 11175, 11840, 12544, 13290, 14080, 14917, 15804
+};
+
+static uint16_t note_freq(uint8_t note)
+{
+  return pgm_read_word(&top_octave[note % 12]) >> (10 - note / 12);
+}
+
+void HW_Melody::begin(uint8_t pin)
+{
+  this->pin = pin;
+  pinMode(pin, OUTPUT);
+  cur = NULL;
+  queue_len = 0;
+}
+
+void HW_Melody::start(const uint8_t *melody, uint8_t priority)
+{
+  cur = melody;
+  cur_priority = priority;
+  note_ms = 0;
+  holding = false;
+}
+
+bool HW_Melody::play(const uint8_t *melody, uint8_t priority)
+{
+  if (cur == NULL) {
+    start(melody, priority);
+    return true;
+  }
+  if (priority > cur_priority) {
+    // 打断当前旋律
+    start(melody, priority);
+    return true;
+  }
+  // 按优先级插入队列，同优先级先到先播
+  int pos = queue_len;
+  while (pos > 0 && queue[pos - 1].priority < priority) {
+    pos--;
+  }
+  if (pos >= MELODY_QUEUE_LEN) {
+    return false;
+  }
+  if (queue_len == MELODY_QUEUE_LEN) {
+    queue_len--;  // 丢弃优先级最低的一个
+  }
+  for (int i = queue_len; i > pos; --i) {
+    queue[i] = queue[i - 1];
+  }
+  queue[pos].melody = melody;
+  queue[pos].priority = priority;
+  queue_len++;
+  return true;
+}
+
+void HW_Melody::stop(void)
+{
+  cur = NULL;
+  queue_len = 0;
+  noTone(pin);
+}
+
+void HW_Melody::update(uint32_t now)
+{
+  if (cur == NULL) {
+    return;
+  }
+  // 当前音符未结束
+  if (holding || (note_ms > 0 && now - note_tick < note_ms)) {
+    return;
+  }
+  uint8_t note = pgm_read_byte(cur);
+  if (note == MELODY_END) {
+    noTone(pin);
+    cur = NULL;
+    // 播放队列中的下一个
+    if (queue_len > 0) {
+      start(queue[0].melody, queue[0].priority);
+      for (int i = 1; i < queue_len; ++i) {
+        queue[i - 1] = queue[i];
+      }
+      queue_len--;
+    }
+    return;
+  }
+  note_ms = pgm_read_byte(cur + 1) * 10u;
+  holding = (note_ms == 0);
+  note_tick = now;
+  cur += 2;
+  if (note == MELODY_REST) {
+    noTone(pin);
+  } else {
+    tone(pin, note_freq(note));
+  }
+}
@@ -0,0 +1,50 @@
+/*
+ * 蜂鸣器旋律播放器
+ * 旋律存放在Flash(PROGMEM)中，每个音符2字节：{MIDI音符号, 时长(10ms)}
+ *   音符号为 MELODY_REST 表示休止，时长为0表示一直保持到 stop() 或被打断，MELODY_END 表示结束
+ * 播放不阻塞，带优先级队列：高优先级打断当前旋律，其余按优先级排队
+ * 旋律由 scripts/melody/melody2progmem.py 从文本记谱生成
+ */
+
+#ifndef __HW_MELODY_H_
+#define __HW_MELODY_H_
+
+#include <Arduino.h>
+
+#define MELODY_REST 0x00
+#define MELODY_END  0xFF
+#define MELODY_QUEUE_LEN 4
+
+typedef struct
+{
+  const uint8_t *melody;
+  uint8_t priority;
+} melody_slot_t;
+
+class HW_Melody{
+  public:
+    //初始化，pin为蜂鸣器引脚
+    void begin(uint8_t pin);
+    //播放旋律，队列已满且优先级不够时返回false
+    bool play(const uint8_t *melody, uint8_t priority);
+    //停止当前旋律并清空队列
+    void stop(void);
+    //是否正在播放
+    bool busy(void) { return cur != NULL; }
+    //播放任务，在loop中调用
+    void update(uint32_t now);
+
+  private:
+    uint8_t pin;
+    const uint8_t *cur = NULL;
+    uint8_t cur_priority = 0;
+    uint32_t note_tick = 0;
+    uint16_t note_ms = 0;   // 当前音符时长，0表示保持
+    bool holding = false;
+    melody_slot_t queue[MELODY_QUEUE_LEN];
+    uint8_t queue_len = 0;
+
+    void start(const uint8_t *melody, uint8_t priority);
+};
+
+#endif //__HW_MELODY_H_
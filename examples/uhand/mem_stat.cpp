@@ -0,0 +1,92 @@
+/*
+ * SRAM 使用情况统计
+ * 内存布局（ATmega328P，RAM 2KB）：
+ *   __data_start | .data .bss .noinit | __heap_start ... __brkval(堆顶) | 空闲 | SP ... RAMEND(栈底)
+ */
+#include "mem_stat.h"
+
+#if defined(__AVR__)
+
+extern uint8_t __data_start;
+extern uint8_t __data_end;
+extern uint8_t __bss_start;
+extern uint8_t __bss_end;
+extern uint8_t __noinit_start;
+extern uint8_t __noinit_end;
+extern uint8_t __heap_start;
+extern uint8_t __stack;
+extern char *__brkval;
+
+// 在main之前运行，把堆起点到栈底之间全部填充
+// .init 各段的代码依次直接执行，不是函数调用：naked 去掉了序言和 ret，不使用栈
+// 此时 .init2 已把 r1 清零、SP 设为 RAMEND，栈里还没有任何内容；填充范围在 .noinit 之后，
+// 与随后 .init4 拷贝的 .data、清零的 .bss 不重叠，所以在C运行时初始化之前写这段内存是安全的
+void mem_paint(void) __attribute__((naked, used, section(".init3")));
+void mem_paint(void)
+{
+  uint8_t *p = &__heap_start;
+  while (p <= &__stack) {
+    *p = MEM_PAINT_BYTE;
+    p++;
+  }
+}
+
+void mem_stat_get(mem_stat_t *stat)
+{
+  uint8_t *heap_end = __brkval ? (uint8_t *)__brkval : &__heap_start;
+  uint8_t *sp = (uint8_t *)SP;
+
+  // 从当前栈顶往下找栈到达过的最低处：连续 MEM_PAINT_RUN 个未改写字节的上沿
+  // 不从堆顶往上数，堆收缩后留在堆顶之上的旧数据也被改写过，会把空闲空间算少
+  uint8_t *top = sp;
+  uint8_t run = 0;
+  for (uint8_t *p = sp; p >= heap_end && run < MEM_PAINT_RUN; --p) {
+    if (*p == MEM_PAINT_BYTE) {
+      run++;
+    } else {
+      run = 0;
+      top = p - 1;
+    }
+  }
+
+  stat->static_bytes = &__heap_start - &__data_start;
+  stat->data_bytes = &__data_end - &__data_start;
+  stat->bss_bytes = &__bss_end - &__bss_start;
+  stat->noinit_bytes = &__noinit_end - &__noinit_start;
+  stat->heap_bytes = heap_end - &__heap_start;
+  stat->free_bytes = sp - heap_end;
+  stat->min_free = top >= heap_end ? top + 1 - heap_end : 0;
+  stat->stack_peak = &__stack - top;
+}
+
+#else
+
+void mem_stat_get(mem_stat_t *stat)
+{
+  memset(stat, 0, sizeof(mem_stat_t));
+}
+
+#endif
+
+void mem_stat_print(void)
+{
+  mem_stat_t stat;
+  mem_stat_get(&stat);
+  Serial.print(F("ram static:"));
+  Serial.print(stat.static_bytes);
+  Serial.print(F(" (data:"));
+  Serial.print(stat.data_bytes);
+  Serial.print(F(" bss:"));
+  Serial.print(stat.bss_bytes);
+  Serial.print(F(" noinit:"));
+  Serial.print(stat.noinit_bytes);
+  Serial.print(F(")"));
+  Serial.print(F(" heap:"));
+  Serial.print(stat.heap_bytes);
+  Serial.print(F(" free:"));
+  Serial.print(stat.free_bytes);
+  Serial.print(F(" min_free:"));
+  Serial.print(stat.min_free);
+  Serial.print(F(" stack_peak:"));
+  Serial.println(stat.stack_peak);
+}
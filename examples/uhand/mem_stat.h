@@ -0,0 +1,34 @@
+/*
+ * SRAM 使用情况统计
+ * 上电时（.init3 阶段，main之前）把堆栈之间的空闲区域填充为 MEM_PAINT_BYTE，
+ * 之后扫描仍未被改写的字节数，就能得到栈的最高水位，用于排查栈与堆/全局变量相撞导致的复位
+ * 串口发送 "M$" 打印统计结果
+ */
+
+#ifndef __MEM_STAT_H_
+#define __MEM_STAT_H_
+
+#include <Arduino.h>
+
+#define MEM_PAINT_BYTE 0xC5
+// 连续这么多个填充字节才算栈没有到达过，栈里的数据偶尔等于 MEM_PAINT_BYTE 时不会误判
+#define MEM_PAINT_RUN 8
+
+typedef struct
+{
+  uint16_t static_bytes;  // .data + .bss + .noinit
+  uint16_t data_bytes;    // .data
+  uint16_t bss_bytes;     // .bss
+  uint16_t noinit_bytes;  // .noinit（复位后不清零的变量）
+  uint16_t heap_bytes;    // 堆当前使用（String等malloc）
+  uint16_t free_bytes;    // 当前栈顶与堆顶之间的空闲空间
+  uint16_t min_free;      // 上电以来空闲空间的最小值（栈最高水位）
+  uint16_t stack_peak;    // 上电以来栈的最大深度
+} mem_stat_t;
+
+//读取当前的内存统计
+void mem_stat_get(mem_stat_t *stat);
+//把内存统计输出到串口
+void mem_stat_print(void);
+
+#endif //__MEM_STAT_H_
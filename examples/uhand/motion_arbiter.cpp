@@ -0,0 +1,79 @@
+/*
+ * 运动仲裁器
+ */
+#include "motion_arbiter.h"
+
+void HW_MotionArbiter::begin(uint16_t fade_ms)
+{
+  this->fade_ms = fade_ms;
+  for (int i = 0; i < ARBITER_SOURCE_MAX; ++i) {
+    sources[i] = NULL;
+    priorities[i] = 0;
+    claims[i] = 0;
+  }
+  for (int j = 0; j < ARBITER_JOINT_NUM; ++j) {
+    owners[j] = ARBITER_NO_OWNER;
+    from[j] = 90;
+    last[j] = 90;
+    fade_tick[j] = 0;
+  }
+}
+
+void HW_MotionArbiter::attach(uint8_t src, const uint8_t *angles, uint8_t priority)
+{
+  sources[src] = angles;
+  priorities[src] = priority;
+}
+
+void HW_MotionArbiter::claim(uint8_t src, uint8_t mask)
+{
+  claims[src] |= mask;
+}
+
+void HW_MotionArbiter::release(uint8_t src, uint8_t mask)
+{
+  claims[src] &= ~mask;
+}
+
+void HW_MotionArbiter::preempt(uint8_t src, uint8_t mask)
+{
+  for (int i = 0; i < ARBITER_SOURCE_MAX; ++i) {
+    if (i != src) {
+      claims[i] &= ~mask;
+    }
+  }
+  claims[src] |= mask;
+}
+
+void HW_MotionArbiter::update(uint32_t now, float *out)
+{
+  for (int j = 0; j < ARBITER_JOINT_NUM; ++j) {
+    // 找出申请了该关节且优先级最高的来源
+    uint8_t best = ARBITER_NO_OWNER;
+    for (int i = 0; i < ARBITER_SOURCE_MAX; ++i) {
+      if (sources[i] && (claims[i] & (1 << j)) &&
+          (best == ARBITER_NO_OWNER || priorities[i] > priorities[best])) {
+        best = i;
+      }
+    }
+    if (best == ARBITER_NO_OWNER) {
+      // 无人控制时保持当前角度
+      owners[j] = best;
+      out[j] = last[j];
+      continue;
+    }
+    // 控制权变化，从当前输出开始淡入
+    if (best != owners[j]) {
+      owners[j] = best;
+      from[j] = last[j];
+      fade_tick[j] = now;
+    }
+    float target = sources[best][j];
+    uint32_t t = now - fade_tick[j];
+    if (t < fade_ms) {
+      target = from[j] + (target - from[j]) * t / fade_ms;
+    }
+    last[j] = target;
+    out[j] = target;
+  }
+}
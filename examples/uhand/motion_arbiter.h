@@ -0,0 +1,48 @@
+/*
+ * 运动仲裁器
+ * 多个角度来源（旋钮、APP、动作组、二次开发）按优先级竞争每一个关节：
+ * 每个关节由申请了该关节且优先级最高的来源控制，控制权变化时在 fade_ms 内交叉淡入，避免硬切换
+ * 例如游戏逻辑申请手指，颜色跟踪申请手腕，两者可以同时运行
+ */
+
+#ifndef __HW_MOTION_ARBITER_H_
+#define __HW_MOTION_ARBITER_H_
+
+#include <Arduino.h>
+
+#define ARBITER_JOINT_NUM 6
+#define ARBITER_SOURCE_MAX 4
+#define ARBITER_ALL_JOINTS 0x3F
+#define ARBITER_NO_OWNER 0xFF
+
+class HW_MotionArbiter{
+  public:
+    //初始化，fade_ms为控制权切换时的交叉淡入时间
+    void begin(uint16_t fade_ms);
+    //注册来源，数值越大优先级越高
+    void attach(uint8_t src, const uint8_t *angles, uint8_t priority);
+    //来源申请 mask 中的关节（bit0~bit5 对应 0~5 号舵机）
+    void claim(uint8_t src, uint8_t mask);
+    //来源释放 mask 中的关节
+    void release(uint8_t src, uint8_t mask = ARBITER_ALL_JOINTS);
+    //来源抢占 mask 中的关节：其他来源释放这些关节，当前来源申请这些关节
+    void preempt(uint8_t src, uint8_t mask);
+    //来源是否还申请着任何关节
+    bool active(uint8_t src) { return claims[src] != 0; }
+    //当前控制该关节的来源
+    uint8_t owner(uint8_t joint) { return owners[joint]; }
+    //计算各关节的目标角度
+    void update(uint32_t now, float *out);
+
+  private:
+    const uint8_t *sources[ARBITER_SOURCE_MAX];
+    uint8_t priorities[ARBITER_SOURCE_MAX];
+    uint8_t claims[ARBITER_SOURCE_MAX];
+    uint8_t owners[ARBITER_JOINT_NUM];
+    float from[ARBITER_JOINT_NUM];   // 交叉淡入的起始角度
+    float last[ARBITER_JOINT_NUM];   // 上一次输出的角度
+    uint32_t fade_tick[ARBITER_JOINT_NUM];
+    uint16_t fade_ms;
+};
+
+#endif //__HW_MOTION_ARBITER_H_
@@ -1,224 +0,0 @@
-#ifndef TONE_H_
-#define TONE_H_
-
-#define TONE_0 8u
-#define TONE_1 9u
-#define TONE_2 9u
-#define TONE_3 10u
-#define TONE_4 10u
-#define TONE_5 11u
-#define TONE_6 12u
-#define TONE_7 12u
-#define TONE_8 13u
-#define TONE_9 14u
-#define TONE_10 15u
-#define TONE_11 15u
-#define TONE_12 16u
-#define TONE_13 17u
-#define TONE_14 18u
-#define TONE_15 19u
-#define TONE_16 21u
-#define TONE_17 22u
-#define TONE_18 23u
-#define TONE_19 24u
-#define TONE_20 26u
-#define TONE_21 28u
-#define TONE_22 29u
-#define TONE_23 31u
-#define TONE_24 33u
-#define TONE_25 35u
-#define TONE_26 37u
-#define TONE_27 39u
-#define TONE_28 41u
-#define TONE_29 44u
-#define TONE_30 46u
-#define TONE_31 49u
-#define TONE_32 52u
-#define TONE_33 55u
-#define TONE_34 58u
-#define TONE_35 62u
-#define TONE_36 65u
-#define TONE_37 69u
-#define TONE_38 73u
-#define TONE_39 78u
-#define TONE_40 82u
-#define TONE_41 87u
-#define TONE_42 92u
-#define TONE_43 98u
-#define TONE_44 104u
-#define TONE_45 110u
-#define TONE_46 117u
-#define TONE_47 123u
-#define TONE_48 131u
-#define TONE_49 139u
-#define TONE_50 147u
-#define TONE_51 156u
-#define TONE_52 165u
-#define TONE_53 175u
-#define TONE_54 185u
-#define TONE_55 196u
-#define TONE_56 208u
-#define TONE_57 220u
-#define TONE_58 233u
-#define TONE_59 247u
-#define TONE_60 262u
-#define TONE_61 277u
-#define TONE_62 294u
-#define TONE_63 311u
-#define TONE_64 330u
-#define TONE_65 349u
-#define TONE_66 370u
-#define TONE_67 392u
-#define TONE_68 415u
-#define TONE_69 440u
-#define TONE_70 466u
-#define TONE_71 494u
-#define TONE_72 523u
-#define TONE_73 554u
-#define TONE_74 587u
-#define TONE_75 622u
-#define TONE_76 659u
-#define TONE_77 698u
-#define TONE_78 740u
-#define TONE_79 784u
-#define TONE_80 831u
-#define TONE_81 880u
-#define TONE_82 932u
-#define TONE_83 988u
-#define TONE_84 1047u
-#define TONE_85 1109u
-#define TONE_86 1175u
-#define TONE_87 1245u
-#define TONE_88 1319u
-#define TONE_89 1397u
-#define TONE_90 1480u
-#define TONE_91 1568u
-#define TONE_92 1661u
-#define TONE_93 1760u
-#define TONE_94 1865u
-#define TONE_95 1976u
-#define TONE_96 2093u
-#define TONE_97 2217u
-#define TONE_98 2349u
-#define TONE_99 2489u
-#define TONE_100 2637u
-#define TONE_101 2794u
-#define TONE_102 2960u
-#define TONE_103 3136u
-#define TONE_104 3322u
-#define TONE_105 3520u
-#define TONE_106 3729u
-#define TONE_107 3951u
-#define TONE_108 4186u
-#define TONE_109 4435u
-#define TONE_110 4699u
-#define TONE_111 4978u
-#define TONE_112 5274u
-#define TONE_113 5588u
-#define TONE_114 5920u
-#define TONE_115 6272u
-#define TONE_116 6645u
-#define TONE_117 7040u
-#define TONE_118 7459u
-#define TONE_119 7902u
-#define TONE_120 8372u
-#define TONE_121 8870u
-#define TONE_122 9397u
-#define TONE_123 9956u
-#define TONE_124 10548u
-#define TONE_125 11175u
-#define TONE_126 11840u
-#define TONE_127 12544u
-
-
-#define TONE_A0  TONE_21
-#define TONE_A0S TONE_22
-#define TONE_B0  TONE_23
-#define TONE_C1  TONE_24
-#define TONE_C1S TONE_25
-#define TONE_D1  TONE_26
-#define TONE_D1S TONE_27
-#define TONE_E1  TONE_28
-#define TONE_F1  TONE_29
-#define TONE_F1S TONE_30
-#define TONE_G1  TONE_31
-#define TONE_G1S TONE_32
-#define TONE_A1  TONE_33
-#define TONE_A1S TONE_34
-#define TONE_B1  TONE_35
-#define TONE_C2  TONE_36
-#define TONE_C2S TONE_37
-#define TONE_D2  TONE_38
-#define TONE_D2S TONE_39
-#define TONE_E2  TONE_40
-#define TONE_F2  TONE_41
-#define TONE_F2S TONE_42
-#define TONE_G2  TONE_43
-#define TONE_G2S TONE_44
-#define TONE_A2  TONE_45
-#define TONE_A2S TONE_46
-#define TONE_B2  TONE_47
-#define TONE_C3  TONE_48
-#define TONE_C3S TONE_49
-#define TONE_D3  TONE_50
-#define TONE_D3S TONE_51
-#define TONE_E3  TONE_52
-#define TONE_F3  TONE_53
-#define TONE_F3S TONE_54
-#define TONE_G3  TONE_55
-#define TONE_G3S TONE_56
-#define TONE_A3  TONE_57
-#define TONE_A3S TONE_58
-#define TONE_B3  TONE_59
-#define TONE_C4  TONE_60
-#define TONE_C4S TONE_61
-#define TONE_D4  TONE_62
-#define TONE_D4S TONE_63
-#define TONE_E4  TONE_64
-#define TONE_F4  TONE_65
-#define TONE_F4S TONE_66
-#define TONE_G4  TONE_67
-#define TONE_G4S TONE_68
-#define TONE_A4  TONE_69
-#define TONE_A4S TONE_70
-#define TONE_B4  TONE_71
-#define TONE_C5  TONE_72
-#define TONE_C5S TONE_73
-#define TONE_D5  TONE_74
-#define TONE_D5S TONE_75
-#define TONE_E5  TONE_76
-#define TONE_F5  TONE_77
-#define TONE_F5S TONE_78
-#define TONE_G5  TONE_79
-#define TONE_G5S TONE_80
-#define TONE_A5  TONE_81
-#define TONE_A5S TONE_82
-#define TONE_B5  TONE_83
-#define TONE_C6  TONE_84
-#define TONE_C6S TONE_85
-#define TONE_D6  TONE_86
-#define TONE_D6S TONE_87
-#define TONE_E6  TONE_88
-#define TONE_F6  TONE_89
-#define TONE_F6S TONE_90
-#define TONE_G6  TONE_91
-#define TONE_G6S TONE_92
-#define TONE_A6  TONE_93
-#define TONE_A6S TONE_94
-#define TONE_B6  TONE_95
-#define TONE_C7  TONE_96
-#define TONE_C7S TONE_97
-#define TONE_D7  TONE_98
-#define TONE_D7S TONE_99
-#define TONE_E7  TONE_100
-#define TONE_F7  TONE_101
-#define TONE_F7S TONE_102
-#define TONE_G7  TONE_103
-#define TONE_G7S TONE_104
-#define TONE_A7  TONE_105
-#define TONE_A7S TONE_106
-#define TONE_B7  TONE_107
-
-#define TONE_NONE 0
-
-#endif
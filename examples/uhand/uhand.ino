@@ -1,18 +1,26 @@
 #include <FastLED.h> //导入库
 #include <EEPROM.h>
 #include <Servo.h>
-#include "tone.h"
+#include "melody.h"
+#include "melodies.h"
+#include "motion_arbiter.h"
+#include "mem_stat.h"
+#include "uhand_protocol.h"
+#include "glove_classifier.h"
+#include "glove_model.h"
 
 #define EEPROM_START_FLAG "HIWONDER"
 #define EEPROM_ACTION_NUM_ADDR 16u   /* 存放动作组内的动作个数 */
 #define EEPROM_ACTION_START_ADDR 32u /* 动作组的起始地址 */
 #define EEPROM_ACTION_UNIT_LENGTH 6u /* 动作组的单个动作字节长度 */
 
-const static uint16_t DOC5[] = { TONE_C5 };
-const static uint16_t DOC6[] = { TONE_C6 };
-const static uint16_t DO_RE_MI[3] = { TONE_C5, TONE_D5, TONE_E5 };
-const static uint16_t MI_RE_DO[3] = { TONE_E5, TONE_D5, TONE_C5 };
-const static uint16_t MI_RE_MI_RE[4] = { TONE_C7, TONE_C6, TONE_C7, TONE_C6 };
+/* 蜂鸣器优先级：游戏提示音 > APP鸣响 > 按键提示音 */
+#define MELODY_PRIO_KEY  1
+#define MELODY_PRIO_APP  2
+#define MELODY_PRIO_GAME 3
+
+/* 游戏提示音，由 'Y' 命令选择 */
+const static uint8_t *const game_melodies[] = { MELODY_GAME_START, MELODY_GAME_ROUND, MELODY_GAME_WIN, MELODY_GAME_LOSE };
 
 const static uint8_t keyPins[2] = { 8, 9 };
 const static uint8_t servoPins[6] = { 7, 6, 5, 4, 3, 2 };
@@ -25,6 +33,14 @@ typedef enum {
   MODE_EXTENDED,
 } UhandMode;
 
+/* 运动仲裁器中的角度来源，数值越大优先级越高 */
+typedef enum {
+  SRC_KNOB,
+  SRC_APP,
+  SRC_EXTENDED,
+  SRC_ACTIONGROUP,
+} MotionSource;
+
 static CRGB rgbs[1];
 static uint8_t eeprom_read_buf[16];
 static bool learning = false;
@@ -33,9 +49,12 @@ static UhandMode g_mode = MODE_KNOB;                          /* mode, 0 -> pane
 static UhandMode g_mode_old = MODE_KNOB;
 
 static uint8_t knob_angles[6] = { 90, 90, 90, 90, 90, 90 };   /* 旋钮产生的角度数值 */
+static float knob_readings[6] = { 90, 90, 90, 90, 90, 90 };   /* 旋钮当前读数对应的角度 */
+static float knob_hold_ref[6];                                 /* 保持动作姿态时的旋钮读数 */
+static uint8_t knob_hold_mask = 0;                             /* 保持动作组最后姿态的关节，旋钮转动后才恢复跟随 */
 static uint8_t app_angles[6] = { 90, 90, 90, 90, 90, 90 };    /* app 发送过来的角度数值 */
 static uint8_t action_angles[6] = { 90, 90, 90, 90, 90, 90 }; /* 动作组的角度数值 */
-static uint8_t extended_func_angles[6] = { 90, 90, 90, 90, 90, 90 }; /* 二次开发例程使用的角度数值 */
+static uint8_t extended_func_angles[6] = { 90, 90, 90, 90, 90, 90 }; /* 二次开发例程使用的角度数值，使用前调用 arbiter.claim(SRC_EXTENDED, mask) */
 
 static float servo_angles[6] = { 90, 90, 90, 90, 90, 90 };  /* 舵机实际控制的角度数值 */
 static uint8_t action_group[80][6];
@@ -43,33 +62,45 @@ static uint8_t action_group[80][6];
 static uint16_t action_index;
 static uint8_t action_group_running_step = 0;
 
-static uint16_t tune_num = 0;
-static uint32_t tune_beat = 10;
-static uint16_t *tune;
+static bool glove_enabled = false; /* 手套数字识别开关 */
+static uint16_t glove_log_ms = 0;  /* 样本记录周期，0为不记录 */
 
 Servo servos[6];
+HW_Melody melody;
+HW_MotionArbiter arbiter;
+HW_UhandProtocol protocol;
+HW_GloveClassifier glove;
 
 static void knob_update(void);   /* 旋钮读取更新 */
+static void glove_sample(const float *values); /* 手套数字识别及样本记录 */
 static void key_scan(void);      /* 按键扫描 */
 static void servo_control(void); /* 舵机控制 */
-void play_tune(uint16_t *p, uint32_t beat, uint16_t len);
-void tune_task(void);
 void action_group_task(void);
 void recv_handler(void);
+static void on_command(char cmd, const char *arg); /* 串口命令处理 */
+static void serial_write(const char *str);
+static void serial_baud(uint32_t baud);
 void servos_middle(void); //中位任务
 
 void setup() {
   // put your setup code here, to run once:
-  Serial.begin(9600);
-  // 设置串行端口读取数据的超时时间
-  Serial.setTimeout(500);
+  Serial.begin(PROTO_DEFAULT_BAUD);
+  protocol.begin("ABCDEFGHIJLMPRTYZ", on_command, serial_write, serial_baud);
   pinMode(keyPins[0], INPUT_PULLUP);
   pinMode(keyPins[1], INPUT_PULLUP);
-  pinMode(buzzerPin, OUTPUT);
+  melody.begin(buzzerPin);
+  glove.begin(&GLOVE_MODEL, 8);
   // 绑定舵机IO口
   for (int i = 0; i < 6; ++i) {
     servos[i].attach(servoPins[i],500,2500);
   }
+  // 注册角度来源，旋钮始终申请全部关节作为最低优先级的兜底
+  arbiter.begin(300);
+  arbiter.attach(SRC_KNOB, knob_angles, SRC_KNOB);
+  arbiter.attach(SRC_APP, app_angles, SRC_APP);
+  arbiter.attach(SRC_EXTENDED, extended_func_angles, SRC_EXTENDED);
+  arbiter.attach(SRC_ACTIONGROUP, action_angles, SRC_ACTIONGROUP);
+  arbiter.claim(SRC_KNOB, ARBITER_ALL_JOINTS);
 
   // 显示白色灯
   FastLED.addLeds<WS2812, rgbPin, GRB>(rgbs, 1);
@@ -89,11 +120,13 @@ void setup() {
   delay(2000);
 
   Serial.println("Start...");
+  protocol.announce();
+  mem_stat_print();
 }
 
 void loop() {
   // 蜂鸣器鸣响任务
-  tune_task();
+  melody.update(millis());
   // 按键扫描及其动作实现
   key_scan();
   // 旋钮读取更新
@@ -135,67 +168,24 @@ void servos_middle(void)
   }
 }
 
+static void serial_write(const char *str)
+{
+  Serial.print(str);
+}
+
+static void serial_baud(uint32_t baud)
+{
+  // 等待回复发送完再切换
+  Serial.flush();
+  Serial.end();
+  Serial.begin(baud);
+}
+
 void recv_handler(void) {
   while (Serial.available() > 0) {
-    String cmd = Serial.readStringUntil('$');
-    Serial.println(cmd);
-    switch (cmd[0]) {
-      case 'A':
-        app_angles[0] = atoi(cmd.c_str() + 1);
-        g_mode = MODE_APP;
-        break;
-      case 'B':
-        app_angles[1] = atoi(cmd.c_str() + 1);
-        g_mode = MODE_APP;
-        break;
-      case 'C':
-        app_angles[2] = atoi(cmd.c_str() + 1);
-        // Serial.println(app_angles[2]);
-        g_mode = MODE_APP;
-        break;
-      case 'D':
-        app_angles[3] = atoi(cmd.c_str() + 1);
-        g_mode = MODE_APP;
-        break;
-      case 'E':
-        app_angles[4] = atoi(cmd.c_str() + 1);
-        g_mode = MODE_APP;
-        break;
-      case 'F':
-        app_angles[5] = atoi(cmd.c_str() + 1);
-        g_mode = MODE_APP;
-        break;
-      case 'G':
-        g_mode = MODE_APP;
-        rgbs[0].r = atoi(cmd.c_str() + 1);
-        break;
-      case 'H':
-        g_mode = MODE_APP;
-        rgbs[0].g = atoi(cmd.c_str() + 1);
-        break;
-      case 'I':
-        g_mode = MODE_APP;
-        rgbs[0].b = atoi(cmd.c_str() + 1);
-        break;
-      case 'J':
-        g_mode = MODE_APP;
-        FastLED.show();
-        break;
-      case 'Z':
-        {
-          g_mode = MODE_APP;
-          if (cmd[1] == '1') {
-            play_tune(DOC6, 10000u, 1u);
-          }
-          if (cmd[1] == '0') {
-            play_tune(DOC6, 1u, 0u);
-          }
-          break;
-        }
-      default:
-        break;
-    }
+    protocol.feed(Serial.read(), millis());
   }
+  protocol.update(millis());
   if ((g_mode_old != MODE_APP)&&(g_mode == MODE_APP)) {
     rgbs[0].r = 0;
     rgbs[0].g = 0;
@@ -204,6 +194,101 @@ void recv_handler(void) {
   }
   g_mode_old = g_mode;
 }
+
+static void on_command(char cmd, const char *arg) {
+  Serial.print(cmd);
+  Serial.println(arg);
+  switch (cmd) {
+    case 'A':
+    case 'B':
+    case 'C':
+    case 'D':
+    case 'E':
+    case 'F':
+      /* APP只申请它控制的那个关节 */
+      app_angles[cmd - 'A'] = atoi(arg);
+      arbiter.claim(SRC_APP, 1 << (cmd - 'A'));
+      g_mode = MODE_APP;
+      break;
+    case 'G':
+      g_mode = MODE_APP;
+      rgbs[0].r = atoi(arg);
+      break;
+    case 'H':
+      g_mode = MODE_APP;
+      rgbs[0].g = atoi(arg);
+      break;
+    case 'I':
+      g_mode = MODE_APP;
+      rgbs[0].b = atoi(arg);
+      break;
+    case 'J':
+      g_mode = MODE_APP;
+      FastLED.show();
+      break;
+    case 'Z':
+      {
+        g_mode = MODE_APP;
+        /* Z1 鸣响10秒（与原协议相同）  Z2 一直鸣响，直到 Z0 或被其他旋律打断  Z0 停止 */
+        if (arg[0] == '1') {
+          melody.play(MELODY_BEEP_APP, MELODY_PRIO_APP);
+        }
+        if (arg[0] == '2') {
+          melody.play(MELODY_BEEP_HOLD, MELODY_PRIO_APP);
+        }
+        if (arg[0] == '0') {
+          melody.stop();
+        }
+        break;
+      }
+    case 'Y':
+      {
+        /* 游戏提示音：Y0开始 Y1回合 Y2胜利 Y3失败 */
+        uint8_t n = arg[0] - '0';
+        if (n < sizeof(game_melodies) / sizeof(game_melodies[0])) {
+          melody.play(game_melodies[n], MELODY_PRIO_GAME);
+        }
+        break;
+      }
+    case 'L':
+      /* 手套样本记录：L<周期ms>，L0停止 */
+      glove_log_ms = atoi(arg);
+      break;
+    case 'R':
+      /* 手套数字识别：R1开启 R0关闭 */
+      glove_enabled = arg[0] == '1';
+      glove.begin(&GLOVE_MODEL, 8);
+      break;
+    case 'M':
+      /* 查询内存使用情况 */
+      mem_stat_print();
+      break;
+    case 'P':
+      /* 运行动作组：P0停止 P1单次 P2循环 */
+      if (arg[0] == '0') {
+        action_group_running_step = 0;
+      } else if ((arg[0] == '1' || arg[0] == '2') && !learning && action_group_running_step == 0) {
+        action_group_running_step = arg[0] - '0';
+      }
+      break;
+    case 'T':
+      {
+        /* 遥测：#T 六个舵机角度 模式 动作组步骤 */
+        Serial.print(F("#T"));
+        for (int i = 0; i < 6; ++i) {
+          Serial.print(' ');
+          Serial.print((int)(servo_angles[i] + 0.5f));
+        }
+        Serial.print(' ');
+        Serial.print(g_mode);
+        Serial.print(' ');
+        Serial.println(action_group_running_step);
+        break;
+      }
+    default:
+      break;
+  }
+}
 void knob_update(void) { /* Read knob Function*/
   static uint32_t last_tick = 0;
   static float values[6];
@@ -218,21 +303,35 @@ void knob_update(void) { /* Read knob Function*/
   values[3] = values[3] * 0.7 + analogRead(A3) * 0.3;
   values[4] = values[4] * 0.7 + analogRead(A4) * 0.3;
   values[5] = values[5] * 0.7 + analogRead(A5) * 0.3;
+  glove_sample(values);
   for (int i = 0; i < 6; ++i) {
     angle = map(values[i], 0, 1023, 0, 180);
     angle = angle < 0 ? 0 : (angle > 180 ? 180 : angle);
-    if (fabs(angle - knob_angles[i]) > 5 && g_mode != MODE_KNOB) { 
+    knob_readings[i] = angle;
+    if (knob_hold_mask & (1 << i)) {
+      /* 保持动作组的最后姿态，直到该旋钮被转动 */
+      if (fabs(angle - knob_hold_ref[i]) <= 5) {
+        continue;
+      }
+      knob_hold_mask &= ~(1 << i);
+    }
+    bool knob_owned = arbiter.owner(i) == SRC_KNOB;
+    if (fabs(angle - knob_angles[i]) > 5 && !knob_owned) { 
       /* When it is found that the knob has been rotated beyond the threshold,
-      the knob control mode will be restored 
+      the knob takes this joint back from the other sources
       (it may currently be in the mobile app control mode) */
-      g_mode = MODE_KNOB;
-      action_group_running_step = 0;
-      rgbs[0].r = 0;
-      rgbs[0].g = 255;
-      rgbs[0].b = 0;
-      FastLED.show();
+      arbiter.preempt(SRC_KNOB, 1 << i);
+      knob_owned = true;
+      if (g_mode != MODE_KNOB) {
+        g_mode = MODE_KNOB;
+        action_group_running_step = 0;
+        rgbs[0].r = 0;
+        rgbs[0].g = 255;
+        rgbs[0].b = 0;
+        FastLED.show();
+      }
     }
-    if (g_mode == MODE_KNOB) {
+    if (knob_owned) {
       knob_angles[i] = angle;
       if (i == 5) {
         // rgbs[0] = CHSV(map(values[i], 0, 1023, 0, 225), 255, 255);
@@ -242,52 +341,45 @@ void knob_update(void) { /* Read knob Function*/
   }
 }
 
-void servo_control(void) {
-  static uint32_t last_tick = 0;
-  if (millis() - last_tick < 25) {
-    return;
+static void glove_sample(const float *values)
+{
+  static uint32_t log_tick = 0;
+  uint16_t raw[GLOVE_CHANNELS];
+  for (int i = 0; i < GLOVE_CHANNELS; ++i) {
+    raw[i] = values[i];
   }
-  last_tick = millis();
-  for (int i = 0; i < 6; ++i) {
-    if (g_mode == MODE_APP) {
-      servo_angles[i] = servo_angles[i] * 0.85 + app_angles[i] * 0.15;
-    } else if (g_mode == MODE_KNOB) {
-      servo_angles[i] = servo_angles[i] * 0.85 + knob_angles[i] * 0.15;
-    } else if (g_mode == MODE_EXTENDED) {
-      servo_angles[i] = servo_angles[i] * 0.85 + extended_func_angles[i] * 0.15;
-    } else{
-      servo_angles[i] = servo_angles[i] * 0.85 + action_angles[i] * 0.15;
+  /* 识别结果去抖后有变化才上报，-1为未知 */
+  if (glove_enabled && glove.update(raw)) {
+    Serial.print(F("#G "));
+    Serial.println(glove.result() == GLOVE_UNKNOWN ? -1 : glove.result());
+  }
+  /* 样本记录，配合 scripts/glove/train_glove.py record */
+  if (glove_log_ms > 0 && millis() - log_tick >= glove_log_ms) {
+    log_tick = millis();
+    Serial.print(F("#L"));
+    for (int i = 0; i < GLOVE_CHANNELS; ++i) {
+      Serial.print(' ');
+      Serial.print(raw[i]);
     }
-    servos[i].write(i == 0 || i == 5 ? 180 - servo_angles[i] : servo_angles[i]);
+    Serial.println();
   }
 }
 
-void tune_task(void) {
-  static uint32_t l_tune_beat = 0;
+void servo_control(void) {
   static uint32_t last_tick = 0;
-  /* If the scheduled time is not reached and 
-  the number of beeps is the same as the previous one */
-  if (millis() - last_tick < l_tune_beat && tune_beat == l_tune_beat) {
+  float targets[6];
+  if (millis() - last_tick < 25) {
     return;
   }
-  l_tune_beat = tune_beat;
   last_tick = millis();
-  if (tune_num > 0) {
-    tune_num -= 1;
-    tone(buzzerPin, *tune++);
-  } else {
-    noTone(buzzerPin);
-    tune_beat = 10;
-    l_tune_beat = 10;
+  /* 由仲裁器决定每个关节跟随哪个来源 */
+  arbiter.update(last_tick, targets);
+  for (int i = 0; i < 6; ++i) {
+    servo_angles[i] = servo_angles[i] * 0.85 + targets[i] * 0.15;
+    servos[i].write(i == 0 || i == 5 ? 180 - servo_angles[i] : servo_angles[i]);
   }
 }
 
-void play_tune(uint16_t *p, uint32_t beat, uint16_t len) {
-  tune = p;
-  tune_beat = beat;
-  tune_num = len;
-}
-
 void action_group_task(void) {
   static uint32_t last_tick = 0;
   static uint32_t tick_wait = 50;
@@ -300,11 +392,24 @@ void action_group_task(void) {
   last_tick = millis();
   switch (action_group_running_step) {
     case 0:
+      /* 动作组结束或被停止，交还关节
+         旋钮来源接过最后的动作姿态并保持，旋钮被转动的关节才回到旋钮位置，避免淡入到过时的旋钮姿态 */
+      if (arbiter.active(SRC_ACTIONGROUP)) {
+        for (int i = 0; i < 6; ++i) {
+          if (arbiter.owner(i) == SRC_ACTIONGROUP) {
+            knob_angles[i] = action_angles[i];
+            knob_hold_ref[i] = knob_readings[i];
+            knob_hold_mask |= 1 << i;
+          }
+        }
+        arbiter.release(SRC_ACTIONGROUP);
+      }
       break;
     case 1:
     case 2:
       {
         g_mode = MODE_ACTIONGROUP;
+        arbiter.claim(SRC_ACTIONGROUP, ARBITER_ALL_JOINTS);
         action_index = 0;
         action_num = 0;
         for (int i = 0; i < 16; ++i) {
@@ -395,11 +500,11 @@ void key_scan(void) { /* 按键扫描 */
               {
                 if (learning) { /* Add new action */
                   memcpy(&action_group[action_index++], knob_angles, 6);
-                  play_tune(DOC5, 100, 1);
+                  melody.play(MELODY_BEEP_LOW, MELODY_PRIO_KEY);
                 } else { /* Stop */
                   if (action_group_running_step != 0) {
                     action_group_running_step = 0;
-                    play_tune(DOC6, 800, 1);
+                    melody.play(MELODY_BEEP_LONG, MELODY_PRIO_KEY);
                     rgbs[0].r = 0;
                     rgbs[0].g = 255;
                     rgbs[0].b = 0;
@@ -412,7 +517,7 @@ void key_scan(void) { /* 按键扫描 */
                 if (!learning) { /* Single run action group */
                   if (action_group_running_step == 0) {
                     action_group_running_step = 1;
-                    play_tune(DOC6, 100u, 1u);
+                    melody.play(MELODY_BEEP, MELODY_PRIO_KEY);
                     rgbs[0].r = 255;
                     rgbs[0].g = 200;
                     rgbs[0].b = 0;
@@ -436,7 +541,7 @@ void key_scan(void) { /* 按键扫描 */
                       EEPROM.write(0 + j, EEPROM_START_FLAG[j]);
                     }
                     learning = false;
-                    play_tune(MI_RE_DO, 150, 3);
+                    melody.play(MELODY_MI_RE_DO, MELODY_PRIO_KEY);
                     rgbs[0].r = 0;
                     rgbs[0].g = 255;
                     rgbs[0].b = 0;
@@ -445,7 +550,7 @@ void key_scan(void) { /* 按键扫描 */
                     if (action_group_running_step == 0) {
                       learning = true;
                       action_index = 0;
-                      play_tune(DO_RE_MI, 150, 3);
+                      melody.play(MELODY_DO_RE_MI, MELODY_PRIO_KEY);
                       rgbs[0].r = 255;
                       rgbs[0].g = 0;
                       rgbs[0].b = 0;
@@ -456,7 +561,7 @@ void key_scan(void) { /* 按键扫描 */
                 if (i == 1) {
                   if (learning) { /* Exit action editing mode and save */
                     learning = false;
-                    play_tune(MI_RE_DO, 150, 3);
+                    melody.play(MELODY_MI_RE_DO, MELODY_PRIO_KEY);
                     rgbs[0].r = 0;
                     rgbs[0].g = 255;
                     rgbs[0].b = 0;
@@ -464,7 +569,7 @@ void key_scan(void) { /* 按键扫描 */
 
                   } else {
                     if (action_group_running_step == 0) { /* Loop operation action group */
-                      play_tune(DOC6, 300u, 1u);
+                      melody.play(MELODY_BEEP_MID, MELODY_PRIO_KEY);
                       rgbs[0].r = 255;
                       rgbs[0].g = 200;
                       rgbs[0].b = 0;
@@ -0,0 +1,158 @@
+/*
+ * uHand 串口协议解析
+ */
+#include "uhand_protocol.h"
+#include <stdlib.h>
+
+const uint32_t HW_UhandProtocol::bauds[] = { 9600, 57600, 115200, 500000, 1000000 };
+const uint8_t HW_UhandProtocol::baud_num = sizeof(bauds) / sizeof(bauds[0]);
+
+// 无符号整数转十进制字符串，返回结尾位置
+static char *put_u32(char *p, uint32_t v)
+{
+  char tmp[10];
+  int n = 0;
+  do {
+    tmp[n++] = '0' + v % 10;
+    v /= 10;
+  } while (v > 0);
+  while (n > 0) {
+    *p++ = tmp[--n];
+  }
+  *p = '\0';
+  return p;
+}
+
+void HW_UhandProtocol::begin(const char *commands, proto_command_cb on_command, proto_write_cb write, proto_baud_cb set_baud)
+{
+  this->commands = commands;
+  this->on_command = on_command;
+  this->write = write;
+  this->set_baud = set_baud;
+  len = 0;
+  overflow = false;
+  cur_baud = good_baud = PROTO_DEFAULT_BAUD;
+  pending_baud = 0;
+}
+
+void HW_UhandProtocol::announce(void)
+{
+  char num[12];
+  write("@ID fw=" PROTO_FIRMWARE_ID " proto=");
+  put_u32(num, PROTO_VERSION);
+  write(num);
+  write(" cmds=");
+  write(commands);
+  write("?~ bauds=");
+  for (int i = 0; i < baud_num; ++i) {
+    char *p = put_u32(num, bauds[i]);
+    if (i < baud_num - 1) {
+      *p++ = ',';
+      *p = '\0';
+    }
+    write(num);
+  }
+  write("\r\n");
+}
+
+void HW_UhandProtocol::reply(const char *tag, uint32_t value)
+{
+  char line[24];
+  char *p = line;
+  while (*tag) {
+    *p++ = *tag++;
+  }
+  *p++ = ' ';
+  p = put_u32(p, value);
+  *p++ = '\r';
+  *p++ = '\n';
+  *p = '\0';
+  write(line);
+}
+
+void HW_UhandProtocol::change_baud(uint32_t baud, uint32_t now)
+{
+  if (pending_baud != 0) {
+    if (baud == pending_baud) {
+      // 主机已经用新波特率发来确认
+      good_baud = baud;
+      pending_baud = 0;
+      reply("~ACK", baud);
+    }
+    return;
+  }
+  bool supported = false;
+  for (int i = 0; i < baud_num; ++i) {
+    if (bauds[i] == baud) {
+      supported = true;
+    }
+  }
+  if (!supported) {
+    reply("~ERR", baud);
+    return;
+  }
+  reply("~OK", baud);
+  if (baud == cur_baud) {
+    good_baud = baud;
+    return;
+  }
+  set_baud(baud);
+  cur_baud = baud;
+  pending_baud = baud;
+  pending_tick = now;
+}
+
+void HW_UhandProtocol::dispatch(uint32_t now)
+{
+  switch (buf[0]) {
+    case '?':
+      announce();
+      break;
+    case '~':
+      change_baud(strtoul(buf + 1, NULL, 10), now);
+      break;
+    default:
+      if (pending_baud == 0) {
+        on_command(buf[0], buf + 1);
+      }
+      break;
+  }
+}
+
+void HW_UhandProtocol::feed(uint8_t c, uint32_t now)
+{
+  if (len > 0 && now - byte_tick > PROTO_FRAME_TIMEOUT_MS) {
+    len = 0;
+    overflow = false;
+  }
+  byte_tick = now;
+  if (c == '$') {
+    if (len > 0 && !overflow) {
+      buf[len] = '\0';
+      dispatch(now);
+    }
+    len = 0;
+    overflow = false;
+    return;
+  }
+  // 忽略帧之间的换行和空格
+  if (len == 0 && (c == '\r' || c == '\n' || c == ' ')) {
+    return;
+  }
+  if (len >= PROTO_FRAME_MAX) {
+    overflow = true;
+    return;
+  }
+  buf[len++] = c;
+}
+
+void HW_UhandProtocol::update(uint32_t now)
+{
+  if (pending_baud != 0 && now - pending_tick > PROTO_CONFIRM_MS) {
+    // 没有收到确认，退回上一次可用的波特率
+    pending_baud = 0;
+    set_baud(good_baud);
+    cur_baud = good_baud;
+    len = 0;
+  }
+}
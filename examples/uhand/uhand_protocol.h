@@ -0,0 +1,66 @@
+/*
+ * uHand 串口协议解析
+ * 帧格式沿用原有文本协议："<命令字符><参数>$"，例如 "A90$"
+ * 协议版本2在此基础上增加：
+ *   "?$"        查询固件信息，回复 "@ID fw=uhand proto=2 cmds=... bauds=9600,...\r\n"
+ *   "~<波特率>$" 切换波特率，回复 "~OK <波特率>" 后切换，主机需在 PROTO_CONFIRM_MS 内
+ *               以新波特率再次发送 "~<波特率>$" 确认，回复 "~ACK <波特率>"；超时未确认则退回原波特率
+ * 不依赖Arduino，逐字节解析，可以在电脑上编译用于模拟设备（scripts/uhand_link）
+ */
+
+#ifndef __HW_UHAND_PROTOCOL_H_
+#define __HW_UHAND_PROTOCOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define PROTO_FIRMWARE_ID "uhand"
+#define PROTO_VERSION 2
+#define PROTO_DEFAULT_BAUD 9600
+#define PROTO_FRAME_MAX 24          // 单帧最大长度（不含'$'）
+#define PROTO_FRAME_TIMEOUT_MS 500  // 帧内字节间隔超时，丢弃不完整的帧
+#define PROTO_CONFIRM_MS 1000       // 切换波特率后等待确认的时间
+
+typedef void (*proto_command_cb)(char cmd, const char *arg);
+typedef void (*proto_write_cb)(const char *str);
+typedef void (*proto_baud_cb)(uint32_t baud);  // 需先等待发送完成再切换
+
+class HW_UhandProtocol{
+  public:
+    //初始化，commands为固件支持的命令字符列表（用于握手回复）
+    void begin(const char *commands, proto_command_cb on_command, proto_write_cb write, proto_baud_cb set_baud);
+    //输入一个接收到的字节
+    void feed(uint8_t c, uint32_t now);
+    //处理波特率确认超时，在loop中调用
+    void update(uint32_t now);
+    //输出固件信息，上电时主动发送一次
+    void announce(void);
+    //当前使用的波特率
+    uint32_t baud(void) { return cur_baud; }
+
+    //支持的波特率（ATmega328P 16MHz 下误差不超过2.1%）
+    static const uint32_t bauds[];
+    static const uint8_t baud_num;
+
+  private:
+    const char *commands;
+    proto_command_cb on_command;
+    proto_write_cb write;
+    proto_baud_cb set_baud;
+
+    char buf[PROTO_FRAME_MAX + 1];
+    uint8_t len = 0;
+    bool overflow = false;
+    uint32_t byte_tick = 0;
+
+    uint32_t cur_baud = PROTO_DEFAULT_BAUD;
+    uint32_t good_baud = PROTO_DEFAULT_BAUD;  // 最近一次确认可用的波特率
+    uint32_t pending_baud = 0;                // 等待确认的波特率，0表示没有
+    uint32_t pending_tick = 0;
+
+    void dispatch(uint32_t now);
+    void change_baud(uint32_t baud, uint32_t now);
+    void reply(const char *tag, uint32_t value);
+};
+
+#endif //__HW_UHAND_PROTOCOL_H_
@@ -1,7 +1,14 @@
 //Action group file
 #include <Arduino.h>
+#include "motion_layers.h"
 #define action_count 3 //Number of action groups
 
+/*数组成员：第0位为行类型
+  1 -- 姿态：{1, 舵机1~6的角度}
+  2 -- 运动层：{2, 关节掩码, 波形(LayerShape), 幅度(度), 周期(10ms), 持续时间(100ms)}，叠加在上一个姿态上，结束后再执行下一行
+  0 -- 动作组结束
+*/
+
 static uint8_t action[action_count][20][11] = 
     {
       //Action Group 1
@@ -34,28 +41,14 @@ static uint8_t action[action_count][20][11] =
       //胜利手势
       {
         {1,10,170,170,10,10,90}, // 2
-        {1,10,170,170,10,10,50}, // 2
-        // {1,10,170,170,10,10,90}, // 2
-        {1,10,170,170,10,10,140}, // 2
-        // {1,10,170,170,10,10,90}, // 2
-        {1,10,170,170,10,10,50}, // 2
-        // {1,10,170,170,10,10,90}, // 2
-        {1,10,170,170,10,10,140}, // 2
-        {1,10,170,170,10,10,90}, // 2
+        {2,0x20,LAYER_SINE,45,60,24}, // 手腕挥动 90±45°，周期0.6s，持续2.4s
       },
 
       //Action Group 3
       //失败手势
       {
         {1,10,10,170,10,10,90},  // 中指
-        {1,10,10,170,10,10,50},  // 中指
-        // {1,10,10,170,10,10,90},  // 中指
-        {1,10,10,170,10,10,140}, // 中指
-        // {1,10,10,170,10,10,90},  // 中指
-        {1,10,10,170,10,10,50},  // 中指
-        // {1,10,10,170,10,10,90},  // 中指
-        {1,10,10,170,10,10,140}, // 中指
-        {1,10,10,170,10,10,90},  // 中指
+        {2,0x20,LAYER_SINE,45,60,24}, // 手腕挥动 90±45°，周期0.6s，持续2.4s
 
       }
 
@@ -0,0 +1,104 @@
+/*
+ * 程序化运动层
+ */
+#include "motion_layers.h"
+
+// 1/4周期正弦表，sin(i/64 * 90°) * 127
+static const uint8_t sine_quarter[65] PROGMEM = {
+    0,   3,   6,   9,  12,  16,  19,  22,  25,  28,  31,  34,  37,  40,  43,  46,
+   49,  51,  54,  57,  60,  63,  65,  68,  71,  73,  76,  78,  81,  83,  85,  88,
+   90,  92,  94,  96,  98, 100, 102, 104, 106, 107, 109, 111, 112, 113, 115, 116,
+  117, 118, 120, 121, 122, 122, 123, 124, 125, 125, 126, 126, 126, 127, 127, 127,
+  127,
+};
+
+// phase: 0~255 对应一个周期，返回 -127~127
+static int16_t sin8(uint8_t phase)
+{
+  uint8_t i = phase & 0x3F;
+  switch (phase >> 6) {
+    case 0: return pgm_read_byte(&sine_quarter[i]);
+    case 1: return pgm_read_byte(&sine_quarter[64 - i]);
+    case 2: return -(int16_t)pgm_read_byte(&sine_quarter[i]);
+    default: return -(int16_t)pgm_read_byte(&sine_quarter[64 - i]);
+  }
+}
+
+bool HW_MotionLayers::add(uint8_t mask, uint8_t shape, int8_t amplitude, uint16_t period_ms, uint16_t duration_ms, uint32_t now)
+{
+  for (int i = 0; i < MOTION_LAYER_MAX; ++i) {
+    if (layers[i].shape == LAYER_NONE || now - layers[i].start >= layers[i].duration_ms) {
+      layers[i].mask = mask;
+      layers[i].shape = shape;
+      layers[i].amplitude = amplitude;
+      layers[i].period_ms = period_ms > 0 ? period_ms : 1;
+      layers[i].duration_ms = duration_ms;
+      layers[i].start = now;
+      return true;
+    }
+  }
+  return false;
+}
+
+void HW_MotionLayers::clear(void)
+{
+  for (int i = 0; i < MOTION_LAYER_MAX; ++i) {
+    layers[i].shape = LAYER_NONE;
+  }
+}
+
+bool HW_MotionLayers::active(uint32_t now)
+{
+  for (int i = 0; i < MOTION_LAYER_MAX; ++i) {
+    if (layers[i].shape != LAYER_NONE && now - layers[i].start < layers[i].duration_ms) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void HW_MotionLayers::apply(float *angles, uint32_t now)
+{
+  for (int i = 0; i < MOTION_LAYER_MAX; ++i) {
+    motion_layer_t *l = &layers[i];
+    if (l->shape == LAYER_NONE) {
+      continue;
+    }
+    uint32_t t = now - l->start;
+    if (t >= l->duration_ms) {
+      l->shape = LAYER_NONE;
+      continue;
+    }
+    uint8_t phase = (uint8_t)((t % l->period_ms) * 256 / l->period_ms);
+    uint32_t left = l->duration_ms - t;
+    int32_t wave;  // Q7，-127~127
+    int32_t env;   // Q8 包络，0~256
+    switch (l->shape) {
+      case LAYER_SINE:
+        {
+          uint32_t ramp = min((uint32_t)l->period_ms / 4, (uint32_t)l->duration_ms / 2);
+          uint32_t edge = min(t, left);
+          wave = sin8(phase);
+          env = (ramp == 0 || edge >= ramp) ? 256 : (int32_t)(edge * 256 / ramp);
+          break;
+        }
+      case LAYER_SHAKE:
+        wave = sin8(phase);
+        env = (int32_t)(left * 256 / l->duration_ms);
+        break;
+      case LAYER_PULSE:
+        // 升余弦：(1 - cos) / 2，从0开始也在0结束
+        wave = (127 - sin8(phase + 64)) / 2;
+        env = 256;
+        break;
+      default:
+        continue;
+    }
+    float offset = (l->amplitude * wave * env) / 32768.0f;
+    for (int j = 0; j < 6; ++j) {
+      if (l->mask & (1 << j)) {
+        angles[j] += offset;
+      }
+    }
+  }
+}
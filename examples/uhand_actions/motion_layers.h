@@ -0,0 +1,46 @@
+/*
+ * 程序化运动层
+ * 在静态姿态上叠加参数化的偏移：正弦摆动、抖动、脉冲
+ * 全部使用定点运算，在舵机控制周期中计算，一个手势只需要几个字节的参数
+ */
+
+#ifndef __HW_MOTION_LAYERS_H_
+#define __HW_MOTION_LAYERS_H_
+
+#include <Arduino.h>
+
+#define MOTION_LAYER_MAX 3
+
+typedef enum {
+  LAYER_NONE,
+  LAYER_SINE,   // 正弦摆动，首尾各淡入淡出1/4周期
+  LAYER_SHAKE,  // 抖动，幅度随时间线性衰减
+  LAYER_PULSE,  // 脉冲，每个周期从0升到幅度再回到0，只朝一个方向
+} LayerShape;
+
+typedef struct
+{
+  uint8_t mask;         // 作用的关节，bit0~bit5 对应 0~5 号舵机
+  uint8_t shape;        // LayerShape
+  int8_t amplitude;     // 幅度（度），负数表示反方向
+  uint16_t period_ms;   // 周期
+  uint16_t duration_ms; // 持续时间
+  uint32_t start;       // 开始时刻
+} motion_layer_t;
+
+class HW_MotionLayers{
+  public:
+    //添加一个运动层，层数已满时返回false
+    bool add(uint8_t mask, uint8_t shape, int8_t amplitude, uint16_t period_ms, uint16_t duration_ms, uint32_t now);
+    //清除所有运动层
+    void clear(void);
+    //是否还有运动层在运行
+    bool active(uint32_t now);
+    //把各层在 now 时刻的偏移叠加到6个关节的角度上
+    void apply(float *angles, uint32_t now);
+
+  private:
+    motion_layer_t layers[MOTION_LAYER_MAX];
+};
+
+#endif //__HW_MOTION_LAYERS_H_
@@ -76,6 +76,7 @@ void servo_control(void) {
   }
   last_tick = millis();
 
+  float out_angles[6];
   for (int i = 0; i < 6; ++i) {
     if(servo_angles[i] > action_ctl.extended_func_angles[i])
     {
@@ -91,6 +92,14 @@ void servo_control(void) {
 
     servo_angles[i] = servo_angles[i] < limt_angles[i][0] ? limt_angles[i][0] : servo_angles[i];
     servo_angles[i] = servo_angles[i] > limt_angles[i][1] ? limt_angles[i][1] : servo_angles[i];
-    servos[i].write(i == 0 || i == 5 ? 180 - servo_angles[i] : servo_angles[i]);
+    out_angles[i] = servo_angles[i];
+  }
+
+  // 运动层叠加在滤波后的姿态上，避免摆动幅度被滤波削弱
+  action_ctl.layers.apply(out_angles, last_tick);
+  for (int i = 0; i < 6; ++i) {
+    out_angles[i] = out_angles[i] < limt_angles[i][0] ? limt_angles[i][0] : out_angles[i];
+    out_angles[i] = out_angles[i] > limt_angles[i][1] ? limt_angles[i][1] : out_angles[i];
+    servos[i].write(i == 0 || i == 5 ? 180 - out_angles[i] : out_angles[i]);
   }
 }
@@ -4,7 +4,7 @@ void HW_ACTION_CTL::action_set(int num){
   action_num = num;
 }
 
-static int HW_ACTION_CTL::action_state_get(void){
+int HW_ACTION_CTL::action_state_get(void){
   return action_num;
 }
 
@@ -23,7 +23,7 @@ void HW_ACTION_CTL::action_task(void){
     switch(step)
     {
       case 0: //运行动作
-        if(action[action_num-1][num][0] != 0)
+        if(action[action_num-1][num][0] == 1) //姿态
         {
           extended_func_angles[0] = action[action_num-1][num][1];
           extended_func_angles[1] = action[action_num-1][num][2];
@@ -34,6 +34,16 @@ void HW_ACTION_CTL::action_task(void){
 
           step = 1;
 
+        }else if(action[action_num-1][num][0] == 2) //运动层
+        {
+          layers.add(action[action_num-1][num][1],
+                     action[action_num-1][num][2],
+                     (int8_t)action[action_num-1][num][3],
+                     action[action_num-1][num][4] * 10u,
+                     action[action_num-1][num][5] * 100u,
+                     millis());
+          step = 2;
+
         }else{ //若运行完毕
           num = 0;
           // 清空动作组变量
@@ -50,6 +60,13 @@ void HW_ACTION_CTL::action_task(void){
           step = 0;
         }
         break;
+      case 2: //等待运动层结束
+        if(!layers.active(millis()))
+        {
+          num++;
+          step = 0;
+        }
+        break;
       default:
         step = 0;
         break;
@@ -7,6 +7,7 @@
 class HW_ACTION_CTL{
   public:
     uint8_t extended_func_angles[6] = { 0,0,0,0,0, 90 }; /* 二次开发例程使用的角度数值 */
+    HW_MotionLayers layers; /* 叠加在 extended_func_angles 上的运动层，在舵机控制任务中计算 */
     //控制执行动作组
     void action_set(int num);
     int action_state_get(void);
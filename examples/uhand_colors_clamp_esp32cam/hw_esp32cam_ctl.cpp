@@ -4,10 +4,73 @@
  */
 #include "hw_esp32cam_ctl.h"
 
+#if ESP32CAM_USE_SPI
+static const uint8_t spiSckPin = 8;
+static const uint8_t spiMosiPin = 9;
+static const uint8_t spiCsPin = 10;
+static const uint8_t spiMisoPin = 12;
+static const uint8_t spiReadyPin = A0;
+
+// 模式0读取一个字节：上升沿采样，从机在下降沿输出下一位
+static uint8_t spiReadByte(void)
+{
+  uint8_t v = 0;
+  for (uint8_t b = 0; b < 8; ++b)
+  {
+#if defined(__AVR_ATmega328P__)
+    // SCK=PB0 MISO=PB4，直接操作端口
+    PORTB |= _BV(PB0);
+    v = (v << 1) | ((PINB >> PB4) & 1);
+    PORTB &= ~_BV(PB0);
+#else
+    digitalWrite(spiSckPin, HIGH);
+    v = (v << 1) | digitalRead(spiMisoPin);
+    digitalWrite(spiSckPin, LOW);
+#endif
+  }
+  return v;
+}
+
+void HW_ESP32Cam::spiUpdate(void)
+{
+  uint8_t frame[RESULT_FRAME_SIZE];
+  if (digitalRead(spiReadyPin) == LOW)
+  {
+    return; // 没有新帧，沿用上一帧
+  }
+  digitalWrite(spiCsPin, LOW);
+  delayMicroseconds(2);
+  for (int i = 0; i < RESULT_FRAME_SIZE; ++i)
+  {
+    frame[i] = spiReadByte();
+  }
+  digitalWrite(spiCsPin, HIGH);
+  int len = result_frame_check(frame);
+  if (len < RESULT_PAYLOAD_LEN)
+  {
+    frame_errors++;
+    return;
+  }
+  memcpy(payload, frame + RESULT_FRAME_HEAD, RESULT_PAYLOAD_LEN);
+  frames++;
+}
+#endif
+
 // 初始化IIC通信函数
 void HW_ESP32Cam::begin(void)
 {
   Wire.begin();
+#if ESP32CAM_USE_SPI
+  memset(payload, 0, sizeof(payload));
+  pinMode(spiSckPin, OUTPUT);
+  pinMode(spiMosiPin, OUTPUT);
+  pinMode(spiCsPin, OUTPUT);
+  pinMode(spiMisoPin, INPUT);
+  pinMode(spiReadyPin, INPUT);
+  digitalWrite(spiSckPin, LOW);
+  digitalWrite(spiMosiPin, LOW);
+  digitalWrite(spiCsPin, HIGH);
+#endif
 }
 
 //向esp32Cam发送多个字节
@@ -89,6 +152,14 @@ bool HW_ESP32Cam::faceDetect(void)
 //读取ESP32Cam识别颜色，返回颜色代号
 int HW_ESP32Cam::colorDetect(void)
 {
+#if ESP32CAM_USE_SPI
+  spiUpdate();
+  // 帧内颜色顺序：红 黄 绿 蓝 紫，w值在每种颜色的第3个字节
+  if (payload[RESULT_OFS_COLOR + 0 * 4 + 2] > 0) return 1;  //红色
+  if (payload[RESULT_OFS_COLOR + 2 * 4 + 2] > 0) return 2;  //绿色
+  if (payload[RESULT_OFS_COLOR + 3 * 4 + 2] > 0) return 3;  //蓝色
+  return 0;
+#endif
   uint8_t color_info[3][4];
   int num = WireReadDataArray(0x00,color_info[0],4);
   if((num == 4) && (color_info[0][2] > 0)) //接收识别到的颜色的x,y,w,h值
@@ -114,9 +185,57 @@ int HW_ESP32Cam::colorDetect(void)
   return 0;
 }
 
+//设置ESP32Cam功耗模式（寄存器0x30）
+bool HW_ESP32Cam::setPowerMode(uint8_t mode)
+{
+  return wireWriteDataArray(ESP32CAM_ADDR, 0x30, &mode, 1);
+}
+
+//读取ESP32Cam跟踪的某种颜色的目标，按面积从大到小
+int HW_ESP32Cam::colorTracks(uint8_t color, cam_track_t *tracks, uint8_t max)
+{
+#if ESP32CAM_USE_SPI
+  if(color >= RESULT_COLOR_NUM)
+  {
+    return -1;
+  }
+  spiUpdate();
+  uint8_t count = payload[RESULT_OFS_TRACK_NUM + color];
+  const uint8_t *data = &payload[RESULT_OFS_TRACK + color * RESULT_TRACK_K * 8];
+#else
+  uint8_t buf[1 + CAM_TRACK_MAX * 8];
+  int num = WireReadDataArray(0x20 + color, buf, sizeof(buf));
+  if(num < 1 || num < 1 + buf[0] * 8)
+  {
+    return -1;
+  }
+  uint8_t count = buf[0];
+  const uint8_t *data = &buf[1];
+#endif
+  int n = count < max ? count : max;
+  for(int i = 0; i < n; ++i)
+  {
+    const uint8_t *p = &data[i * 8];
+    tracks[i].id = p[0];
+    tracks[i].x = p[1];
+    tracks[i].y = p[2];
+    tracks[i].w = p[3];
+    tracks[i].h = p[4];
+    tracks[i].vx = (int8_t)p[5];
+    tracks[i].vy = (int8_t)p[6];
+    tracks[i].lost = p[7];
+  }
+  return n;
+}
+
 //读取ESP32Cam识别颜色位置，读取成功返回true和位置数据
 bool HW_ESP32Cam::color_position(uint8_t *color_info)
 {
+#if ESP32CAM_USE_SPI
+  spiUpdate();
+  memcpy(color_info, &payload[RESULT_OFS_COLOR + 2 * 4], 4); //绿色
+  return color_info[2] > 0;
+#endif
   int num = WireReadDataArray(0x01,color_info,4);
   if((num == 4) && (color_info[2] > 0)) //接收识别到的颜色的x,y,w,h值
   {
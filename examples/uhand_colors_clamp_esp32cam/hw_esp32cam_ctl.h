@@ -9,20 +9,49 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include "result_frame.h"
 
 #define ESP32CAM_ADDR 0x52
+/* 1: 颜色结果通过SPI帧读取（ESP32Cam的 ColorDetection.ino 中 RESULT_USE_SPI 也要设为1）  0: IIC寄存器
+ * SPI使用软件时序：SCK 8  MOSI 9  CS 10  MISO 12  就绪 A0（11和13被蜂鸣器与RGB灯占用，不能用硬件SPI）
+ * SCK MOSI CS 是5V输出，必须经电平转换或电阻分压（1k/2k）降到3.3V再接ESP32-S3，不能直接相连 */
+#define ESP32CAM_USE_SPI 0
+#define CAM_TRACK_MAX 3
+
+// ESP32Cam跟踪的目标，需ESP32Cam下载带跟踪寄存器(0x20~0x24)的颜色识别程序
+typedef struct
+{
+  uint8_t id;       // 编号，同一物体在帧间保持不变
+  uint8_t x, y;     // 中心坐标（已预测到读取时刻）
+  uint8_t w, h;
+  int8_t vx, vy;    // 速度，10像素/秒
+  uint8_t lost;     // 连续丢失帧数，0为当前帧检测到
+} cam_track_t;
 
 class HW_ESP32Cam{
   public:
     //初始化IIC
     void begin(void);
-    //人脸识别获取函数
+    //人脸识别获取函数（人脸识别程序只支持IIC）
     bool faceDetect(void);
     //颜色识别获取函数
     int colorDetect(void);
     // 颜色位置获取函数
     bool color_position(uint8_t *color_info);
+    // 跟踪目标获取函数，color：0红 1黄 2绿 3蓝 4紫，返回目标数，失败返回-1
+    int colorTracks(uint8_t color, cam_track_t *tracks, uint8_t max);
+    // 设置ESP32Cam功耗模式，0自动调节 1保持最高档
+    bool setPowerMode(uint8_t mode);
+#if ESP32CAM_USE_SPI
+    // 收到的帧数和校验失败的帧数
+    uint32_t frames = 0;
+    uint32_t frame_errors = 0;
 
+  private:
+    uint8_t payload[RESULT_PAYLOAD_LEN];
+    //ESP32Cam有新帧时读取一帧，校验通过则更新payload
+    void spiUpdate(void);
+#endif
 };
 
 #endif //__ESP32CAM_CTL_H_
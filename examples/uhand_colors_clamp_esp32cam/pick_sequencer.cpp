@@ -0,0 +1,186 @@
+/*
+ * 颜色分拣动作序列器
+ */
+#include "pick_sequencer.h"
+
+// 默认配置与原例程的角度保持一致
+static const pick_config_t default_config = {
+  { 80, 100, 100, 80, 70 },   // open_pose
+  { 11, 31, 56, 43, 29 },     // grab_pose
+  90,                         // home_wrist
+  { { COLOR_1, 180 }, { COLOR_2, 0 } }, // COLOR_1转到180°，COLOR_2转到0°
+  2,                          // bin_num
+  3,                          // tolerance
+  300,                        // confirm_ms
+  200,                        // grab_hold_ms
+  150,                        // release_hold_ms
+  150,                        // wrist_speed
+  100,                        // detect_ms
+};
+
+void HW_PickSequencer::begin(HW_ESP32Cam *cam, const float *servo_state)
+{
+  this->cam = cam;
+  state = servo_state;
+  config = default_config;
+  set_fingers(config.open_pose);
+  target[5] = config.home_wrist;
+  wrist = config.home_wrist;
+  step = STEP_DETECT;
+  cur_color = 0;
+  next_color = 0;
+  seen_color = 0;
+  sorted_num = 0;
+}
+
+void HW_PickSequencer::set_fingers(const uint8_t *pose)
+{
+  for (int i = 0; i < 5; ++i) {
+    target[i] = pose[i];
+  }
+}
+
+int HW_PickSequencer::bin_index(int color)
+{
+  for (int i = 0; i < config.bin_num; ++i) {
+    if (config.bins[i].color == color) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// 读取相机颜色，颜色连续出现 confirm_ms 后返回该颜色，否则返回0
+int HW_PickSequencer::poll_color(uint32_t now)
+{
+  if (now - detect_tick < config.detect_ms) {
+    return -1;
+  }
+  detect_tick = now;
+  int c = cam->colorDetect();
+  if (c == 0 || bin_index(c) < 0) {
+    seen_color = 0;
+    return 0;
+  }
+  if (c != seen_color) {
+    seen_color = c;
+    seen_tick = now;
+  }
+  return (now - seen_tick >= config.confirm_ms) ? c : 0;
+}
+
+// 判断 first~last 号舵机的插值角度是否已到位并保持了 hold_ms
+bool HW_PickSequencer::settled(uint8_t first, uint8_t last, uint16_t hold_ms, uint32_t now)
+{
+  for (uint8_t i = first; i <= last; ++i) {
+    if (fabs(state[i] - target[i]) > config.tolerance) {
+      settle_tick = 0;
+      return false;
+    }
+  }
+  if (settle_tick == 0) {
+    settle_tick = now;
+  }
+  return now - settle_tick >= hold_ms;
+}
+
+// 手腕按 wrist_speed 斜坡转动，斜坡到达目标时返回true
+bool HW_PickSequencer::ramp_wrist(uint8_t angle, uint32_t now)
+{
+  float step = config.wrist_speed * (now - move_tick) / 1000.0f;
+  move_tick = now;
+  if (fabs(angle - wrist) <= step) {
+    wrist = angle;
+  } else {
+    wrist += angle > wrist ? step : -step;
+  }
+  target[5] = (uint8_t)(wrist + 0.5f);
+  return wrist == angle;
+}
+
+void HW_PickSequencer::enter(PickStep next, uint32_t now)
+{
+  step = next;
+  settle_tick = 0;
+  move_tick = now;
+  switch (next) {
+    case STEP_GRAB:
+      set_fingers(config.grab_pose);
+      break;
+    case STEP_RELEASE:
+      set_fingers(config.open_pose);
+      break;
+    case STEP_RETURN:
+      next_color = 0;
+      seen_color = 0;
+      break;
+    default:
+      break;
+  }
+}
+
+PickEvent HW_PickSequencer::update(uint32_t now)
+{
+  PickEvent evt = PICK_EVT_NONE;
+  int c;
+
+  switch (step) {
+    case STEP_DETECT: //等待物体
+      c = next_color;
+      next_color = 0;
+      if (c == 0) {
+        c = poll_color(now);
+      }
+      if (c > 0) {
+        cur_color = c;
+        if (sorted_num == 0) {
+          start_tick = now;
+        }
+        enter(STEP_GRAB, now);
+        evt = PICK_EVT_DETECTED;
+      } else if (c == 0) {
+        evt = PICK_EVT_EMPTY;
+      }
+      break;
+    case STEP_GRAB: //抓取，手指到位并保持后转动
+      if (settled(0, 4, config.grab_hold_ms, now)) {
+        enter(STEP_ROTATE, now);
+      }
+      break;
+    case STEP_ROTATE: //转到对应颜色的位置
+      if (ramp_wrist(config.bins[bin_index(cur_color)].wrist_angle, now) && settled(5, 5, 0, now)) {
+        enter(STEP_RELEASE, now);
+      }
+      break;
+    case STEP_RELEASE: //放开
+      if (settled(0, 4, config.release_hold_ms, now)) {
+        enter(STEP_RETURN, now);
+      }
+      break;
+    case STEP_RETURN: //回到中位，同时预读下一个物体
+      if (next_color == 0) {
+        c = poll_color(now);
+        if (c > 0) {
+          next_color = c;
+        }
+      }
+      if (ramp_wrist(config.home_wrist, now) && settled(5, 5, 0, now)) {
+        sorted_num++;
+        step = STEP_DETECT;
+        evt = PICK_EVT_SORTED;
+      }
+      break;
+    default:
+      step = STEP_DETECT;
+      break;
+  }
+  return evt;
+}
+
+float HW_PickSequencer::rate(uint32_t now)
+{
+  if (sorted_num == 0 || now == start_tick) {
+    return 0;
+  }
+  return sorted_num * 60000.0f / (now - start_tick);
+}
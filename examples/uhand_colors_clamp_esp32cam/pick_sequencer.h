@@ -0,0 +1,93 @@
+/*
+ * 颜色分拣动作序列器
+ * 每个阶段的结束由舵机插值状态判断（到位 + 保持时间），不再使用固定的等待计数
+ * 机械手返回中位的过程中预先读取下一个物体的颜色，回到中位后直接开始抓取
+ */
+
+#ifndef __HW_PICK_SEQUENCER_H_
+#define __HW_PICK_SEQUENCER_H_
+
+#include <Arduino.h>
+#include "hw_esp32cam_ctl.h"
+
+#define COLOR_1   3
+#define COLOR_2   1
+
+#define PICK_BIN_MAX 3
+
+typedef struct
+{
+  int color;            // colorDetect() 返回的颜色代号
+  uint8_t wrist_angle;  // 放置位置的手腕角度
+} pick_bin_t;
+
+typedef struct
+{
+  uint8_t open_pose[5];   // 手指张开的角度
+  uint8_t grab_pose[5];   // 手指抓取的角度
+  uint8_t home_wrist;     // 抓取位置的手腕角度
+  pick_bin_t bins[PICK_BIN_MAX];
+  uint8_t bin_num;
+  uint8_t tolerance;      // 判断到位的角度误差（度）
+  uint16_t confirm_ms;    // 颜色需要连续出现的时间，等待物体放稳
+  uint16_t grab_hold_ms;  // 手指到位后保持的时间，等待夹紧
+  uint16_t release_hold_ms; // 手指张开后保持的时间，等待物体落下
+  uint16_t wrist_speed;   // 手腕转动速度（度/秒）
+  uint16_t detect_ms;     // 读取相机的间隔
+} pick_config_t;
+
+typedef enum {
+  PICK_EVT_NONE,
+  PICK_EVT_DETECTED,  // 识别到待分拣的物体
+  PICK_EVT_EMPTY,     // 没有物体
+  PICK_EVT_SORTED,    // 完成一次分拣
+} PickEvent;
+
+class HW_PickSequencer{
+  public:
+    pick_config_t config;
+    uint8_t target[6];  // 舵机目标角度，由 servo_control 插值
+
+    //初始化，servo_state 为 servo_control 中的插值角度
+    void begin(HW_ESP32Cam *cam, const float *servo_state);
+    //周期调用，返回本次产生的事件
+    PickEvent update(uint32_t now);
+    //当前正在分拣的颜色
+    int color(void) { return cur_color; }
+    //已分拣数量
+    uint16_t sorted(void) { return sorted_num; }
+    //每分钟分拣数量
+    float rate(uint32_t now);
+
+  private:
+    typedef enum {
+      STEP_DETECT,
+      STEP_GRAB,
+      STEP_ROTATE,
+      STEP_RELEASE,
+      STEP_RETURN,
+    } PickStep;
+
+    HW_ESP32Cam *cam;
+    const float *state;
+    PickStep step = STEP_DETECT;
+    int cur_color = 0;
+    int next_color = 0;       // 预读的下一个物体颜色
+    int seen_color = 0;       // 正在确认的颜色
+    uint32_t seen_tick = 0;
+    uint32_t detect_tick = 0;
+    uint32_t settle_tick = 0; // 到位的时刻，0表示尚未到位
+    uint32_t move_tick = 0;
+    float wrist = 0;          // 手腕斜坡目标
+    uint16_t sorted_num = 0;
+    uint32_t start_tick = 0;
+
+    void enter(PickStep next, uint32_t now);
+    int poll_color(uint32_t now);
+    bool settled(uint8_t first, uint8_t last, uint16_t hold_ms, uint32_t now);
+    bool ramp_wrist(uint8_t angle, uint32_t now);
+    int bin_index(int color);
+    void set_fingers(const uint8_t *pose);
+};
+
+#endif //__HW_PICK_SEQUENCER_H_
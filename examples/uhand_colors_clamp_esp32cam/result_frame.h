@@ -0,0 +1,83 @@
+/*
+ * 颜色识别结果的 SPI 帧格式，ESP32Cam 固件与 Arduino 端共用
+ * 帧固定 RESULT_FRAME_SIZE 字节（DMA 要求 4 字节对齐）：
+ *   magic(2) 序号(2,小端) 有效载荷长度(1) 标志(1) 载荷(RESULT_PAYLOAD_MAX) CRC16(2)
+ * CRC16-CCITT(多项式0x1021，初值0xFFFF) 覆盖 magic 之后到载荷末尾的全部字节
+ */
+
+#ifndef __RESULT_FRAME_H_
+#define __RESULT_FRAME_H_
+
+#include <stdint.h>
+
+#define RESULT_FRAME_SIZE 160
+#define RESULT_FRAME_HEAD 6
+#define RESULT_PAYLOAD_MAX (RESULT_FRAME_SIZE - RESULT_FRAME_HEAD - 2)
+#define RESULT_MAGIC0 0xA5
+#define RESULT_MAGIC1 0x5A
+
+/* 标志位 */
+#define RESULT_FLAG_UNCHANGED 0x01  // 画面没有变化，结果沿用之前的帧
+
+/* 载荷内容（颜色顺序：红 黄 绿 蓝 紫） */
+#define RESULT_COLOR_NUM 5
+#define RESULT_TRACK_K 3
+#define RESULT_OFS_COLOR 0                                      // 每种颜色最大色块 x y w h
+#define RESULT_OFS_TRACK_NUM (RESULT_OFS_COLOR + RESULT_COLOR_NUM * 4)  // 每种颜色跟踪的目标数
+#define RESULT_OFS_TRACK (RESULT_OFS_TRACK_NUM + RESULT_COLOR_NUM)      // 每种颜色 K 个目标，格式同 IIC 寄存器 0x20~0x24
+#define RESULT_OFS_TIMING (RESULT_OFS_TRACK + RESULT_COLOR_NUM * RESULT_TRACK_K * 8)  // 采集->开始检测 检测耗时(ms, 各2字节)
+#define RESULT_PAYLOAD_LEN (RESULT_OFS_TIMING + 4)
+
+#if RESULT_PAYLOAD_LEN > RESULT_PAYLOAD_MAX
+#error "result payload does not fit in the frame"
+#endif
+
+static inline uint16_t result_frame_crc16(const uint8_t *data, int len)
+{
+  uint16_t crc = 0xFFFF;
+  for (int i = 0; i < len; ++i)
+  {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t b = 0; b < 8; ++b)
+    {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+/* 组帧，载荷已写入 frame + RESULT_FRAME_HEAD */
+static inline void result_frame_seal(uint8_t *frame, uint16_t seq, uint8_t len, uint8_t flags)
+{
+  frame[0] = RESULT_MAGIC0;
+  frame[1] = RESULT_MAGIC1;
+  frame[2] = seq & 0xFF;
+  frame[3] = seq >> 8;
+  frame[4] = len;
+  frame[5] = flags;
+  uint16_t crc = result_frame_crc16(frame + 2, RESULT_FRAME_SIZE - 4);
+  frame[RESULT_FRAME_SIZE - 2] = crc & 0xFF;
+  frame[RESULT_FRAME_SIZE - 1] = crc >> 8;
+}
+
+/* 校验一帧，成功返回载荷长度，失败返回-1 */
+static inline int result_frame_check(const uint8_t *frame)
+{
+  if (frame[0] != RESULT_MAGIC0 || frame[1] != RESULT_MAGIC1 || frame[4] > RESULT_PAYLOAD_MAX)
+  {
+    return -1;
+  }
+  uint16_t crc = frame[RESULT_FRAME_SIZE - 2] | (frame[RESULT_FRAME_SIZE - 1] << 8);
+  if (result_frame_crc16(frame + 2, RESULT_FRAME_SIZE - 4) != crc)
+  {
+    return -1;
+  }
+  return frame[4];
+}
+
+static inline uint16_t result_frame_seq(const uint8_t *frame)
+{
+  return frame[2] | (frame[3] << 8);
+}
+
+#endif //__RESULT_FRAME_H_
@@ -7,14 +7,12 @@
 #include <FastLED.h> //导入LED库
 #include <Servo.h> //导入舵机库
 #include "hw_esp32cam_ctl.h" //导入ESP32Cam通讯库
+#include "pick_sequencer.h" //导入分拣序列器
 #include "tone.h" //音调库
 
 const static uint16_t DOC5[] = { TONE_C5 };
 const static uint16_t DOC6[] = { TONE_C6 };
 
-#define COLOR_1   3
-#define COLOR_2   1
-
 /* 引脚定义 */
 const static uint8_t servoPins[6] = { 7, 6, 5, 4, 3, 2 };
 const static uint8_t buzzerPin = 11;
@@ -23,12 +21,13 @@ const static uint8_t rgbPin = 13;
 static CRGB rgbs[1];
 //ESP32Cam通讯对象
 HW_ESP32Cam hw_cam;
+//分拣序列器，颜色与放置角度在 pick_sequencer.cpp 的默认配置中修改
+HW_PickSequencer sequencer;
 //舵机控制对象
 Servo servos[6];
 
 // 舵机角度相关变量
-static uint8_t extended_func_angles[6] = { 80, 100, 100, 80, 70, 95 }; /* 二次开发例程使用的角度数值 */
-static uint8_t servo_angles[6] = { 80, 100, 100, 80, 70, 95 };  /* 舵机实际控制的角度数值 */
+static float servo_angles[6] = { 80, 100, 100, 80, 70, 95 };  /* 舵机实际控制的角度数值 */
 
 // 蜂鸣器相关变量
 static uint16_t tune_num = 0;
@@ -52,6 +51,7 @@ void setup() {
   }
 
   hw_cam.begin(); //初始化与ESP32Cam通讯接口
+  sequencer.begin(&hw_cam, servo_angles); //初始化分拣序列器
 
   //RGB灯初始化并控制
   FastLED.addLeds<WS2812, rgbPin, GRB>(rgbs, 1);
@@ -77,127 +77,46 @@ void loop() {
   servo_control();
 }
 
+// esp32cam通讯任务：由分拣序列器判断每个阶段是否完成
 void espcam_task(void)
 {
   static uint32_t last_tick = 0;
-  static int posi = 90;
-  static uint8_t step = 0;
-  static uint8_t delay_count = 0;
-  static uint8_t color_state = 0;
-  int color = 0;
-  
-  if (millis() - last_tick < 100) {
+
+  if (millis() - last_tick < 20) {
     return;
   }
   last_tick = millis();
-  
-  switch(step)
+
+  switch(sequencer.update(last_tick))
   {
-    case 0:
-      color = hw_cam.colorDetect(); //获取颜色
-      if(color == COLOR_1)
+    case PICK_EVT_DETECTED:
+      if(sequencer.color() == COLOR_1)
       {
         rgbs[0].r = 0;
         rgbs[0].g = 0;
         rgbs[0].b = 250;
-        FastLED.show();
-        play_tune(DOC6, 300u, 1u);
-        step++;
-      }else if(color == COLOR_2)
-      {
-        rgbs[0].r = 250;     
-        rgbs[0].g = 0;
-        rgbs[0].b = 0;
-        FastLED.show();
-        play_tune(DOC6, 300u, 1u);
-        step++;
       }else{
-        rgbs[0].r = 0;
+        rgbs[0].r = 250;
         rgbs[0].g = 0;
         rgbs[0].b = 0;
-        FastLED.show();
-      }
-      color_state = color;
-      break;
-    case 1:  //等待
-      delay_count++;
-      if(delay_count > 10)
-      {
-        step++;
-        delay_count = 0;
-      }
-      break;
-    case 2://抓取
-      extended_func_angles[0] = 11;
-      extended_func_angles[1] = 31;
-      extended_func_angles[2] = 56;
-      extended_func_angles[3] = 43;
-      extended_func_angles[4] = 29;
-      delay_count = 0;
-      step++;
-      break;
-    case 3: //等待
-      delay_count++;
-      if(delay_count > 5)
-      {
-        step++;
       }
+      FastLED.show();
+      play_tune(DOC6, 300u, 1u);
       break;
-    case 4: //转动
-      if(color_state == COLOR_1) //COLOR_1转到180°
-      {
-        posi += 10;
-        if(posi >= 180)
-          posi = 180;
-      }else{ //COLOR_2转到0°
-        posi -= 10;
-        if(posi <= 0)
-          posi = 0;
-      }
-      extended_func_angles[5] = posi;
-      //等待转动结束，并等待
-      delay_count++;
-      if(delay_count >= 25)
-      {
-        step++;
-        delay_count = 0;
-      }
+    case PICK_EVT_EMPTY:
+      rgbs[0].r = 0;
+      rgbs[0].g = 0;
+      rgbs[0].b = 0;
+      FastLED.show();
       break;
-    case 5: //放开
-      extended_func_angles[0] = 80;
-      extended_func_angles[1] = 100;
-      extended_func_angles[2] = 100;
-      extended_func_angles[3] = 80;
-      extended_func_angles[4] = 70;
-      delay_count++;
-      if(delay_count >= 10)
-      {
-        step++;
-        delay_count = 0;
-      }
-      break;
-    case 6: //回到中位
-      if(color_state == COLOR_1) //COLOR_1 180°->90°
-      { 
-        posi -= 10;
-        if(posi <= 90)
-          posi = 90;
-      }else{ //COLOR_2 0°->90°
-        posi += 10;
-        if(posi >= 90)
-          posi = 90;
-      }
-      extended_func_angles[5] = posi;
-      //等待转动结束，并等待
-      delay_count++;
-      if(delay_count >= 18)
-      {
-        step = 0;
-        delay_count = 0;
-      }
+    case PICK_EVT_SORTED:
+      Serial.print("sorted:");
+      Serial.print(sequencer.sorted());
+      Serial.print(" rate:");
+      Serial.print(sequencer.rate(last_tick));
+      Serial.println("/min");
       break;
     default:
-      step = 0;
       break;
   }
 }
@@ -210,7 +129,7 @@ void servo_control(void) {
   }
   last_tick = millis();
   for (int i = 0; i < 6; ++i) {
-    servo_angles[i] = servo_angles[i] * 0.85 + extended_func_angles[i] * 0.15;
+    servo_angles[i] = servo_angles[i] * 0.85 + sequencer.target[i] * 0.15;
     servos[i].write(i == 0 || i == 5 ? 180 - servo_angles[i] : servo_angles[i]);
   }
 }
@@ -0,0 +1,102 @@
+/*
+ * 色块视觉伺服跟踪控制器
+ */
+#include "blob_tracker.h"
+
+static const tracker_param_t default_param = {
+  50000.0f,        // q_accel
+  16.0f,           // r_meas
+  100,             // latency_ms 相机采集+识别约80ms，舵机响应约40ms，略小于两者之和以减少换向时的过冲
+  250,             // horizon_ms
+  400,             // lost_ms
+  TRACKER_Q8(0.60),  // kp
+  TRACKER_Q8(0.02),  // ki
+  TRACKER_Q8(0.10),  // kd
+  TRACKER_Q8(10),    // i_limit
+  TRACKER_Q8(6),     // slew
+  0, 320,          // 与原例程 map(num, 0, 320, 60, 120) 保持一致
+  60, 120,
+};
+
+void HW_BlobTracker::begin(uint8_t angle)
+{
+  param = default_param;
+  valid = false;
+  out = (int32_t)angle << 8;
+  integ = 0;
+  last_err = 0;
+}
+
+// 常速度模型的预测步：x += v*dt，P = F*P*F' + Q
+void HW_BlobTracker::predict(float dt)
+{
+  float dt2 = dt * dt;
+  x_est += v_est * dt;
+  p00 += dt * (2 * p01 + dt * p11) + param.q_accel * dt2 * dt2 / 4;
+  p01 += dt * p11 + param.q_accel * dt2 * dt / 2;
+  p11 += param.q_accel * dt2;
+}
+
+void HW_BlobTracker::measure(int16_t x, uint32_t now)
+{
+  // 首次测量或丢失目标后重新初始化
+  if (!valid || now - meas_tick > param.lost_ms) {
+    x_est = x;
+    v_est = 0;
+    p00 = param.r_meas;
+    p01 = 0;
+    p11 = 1.0e5f;
+    meas_tick = now;
+    valid = true;
+    return;
+  }
+  predict((now - meas_tick) / 1000.0f);
+  meas_tick = now;
+
+  // 更新步：只观测位置
+  float s = p00 + param.r_meas;
+  float k0 = p00 / s;
+  float k1 = p01 / s;
+  float y = x - x_est;
+  x_est += k0 * y;
+  v_est += k1 * y;
+  p11 -= k1 * p01;
+  p01 -= k0 * p01;
+  p00 -= k0 * p00;
+}
+
+bool HW_BlobTracker::tracking(uint32_t now)
+{
+  return valid && (now - meas_tick <= param.lost_ms);
+}
+
+int32_t HW_BlobTracker::update(uint32_t now)
+{
+  if (!tracking(now)) {
+    // 丢失目标：保持当前角度，清除积分
+    integ = 0;
+    last_err = 0;
+    return out;
+  }
+
+  // 预测到 舵机真正到位的时刻 的色块位置
+  uint32_t ahead = now - meas_tick + param.latency_ms;
+  if (ahead > param.horizon_ms) {
+    ahead = param.horizon_ms;
+  }
+  float x = x_est + v_est * (ahead / 1000.0f);
+  x = constrain(x, (float)param.x_min, (float)param.x_max);
+
+  // 映射到手腕角度(Q8)
+  int32_t target = ((int32_t)param.angle_min << 8) +
+                   (int32_t)((x - param.x_min) * (((int32_t)(param.angle_max - param.angle_min)) << 8) / (param.x_max - param.x_min));
+
+  // 增量式PID：out += Kp*e + Ki*Σe + Kd*Δe
+  int32_t err = target - out;
+  integ = constrain(integ + err, -(int32_t)param.i_limit, (int32_t)param.i_limit);
+  int32_t du = (param.kp * err + param.ki * integ + param.kd * (err - last_err)) >> 8;
+  last_err = err;
+  du = constrain(du, -(int32_t)param.slew, (int32_t)param.slew);
+  out = constrain(out + du, (int32_t)param.angle_min << 8, (int32_t)param.angle_max << 8);
+  return out;
+}
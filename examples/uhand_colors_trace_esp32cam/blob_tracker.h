@@ -0,0 +1,67 @@
+/*
+ * 色块视觉伺服跟踪控制器
+ * 1. 常速度卡尔曼滤波估计色块中心的位置和速度
+ * 2. 按相机+舵机的总延时向前预测色块位置
+ * 3. 定点(Q8)增量式PID把手腕舵机驱动到预测位置对应的角度
+ * 所有参数都放在 param 中，可以在运行时修改
+ */
+
+#ifndef __HW_BLOB_TRACKER_H_
+#define __HW_BLOB_TRACKER_H_
+
+#include <Arduino.h>
+
+// Q8定点数：低8位为小数部分
+#define TRACKER_Q8(x) ((int32_t)((x) * 256))
+
+typedef struct
+{
+  float q_accel;        // 过程噪声：目标加速度的方差 (px/s^2)^2
+  float r_meas;         // 测量噪声：色块中心的方差 px^2
+  uint16_t latency_ms;  // 向前预测的时间，相机延时 + 舵机延时
+  uint16_t horizon_ms;  // 预测时间上限，防止丢失目标后越飞越远
+  uint16_t lost_ms;     // 超过该时间没有测量值则认为目标丢失
+  int16_t kp;           // Q8 比例系数
+  int16_t ki;           // Q8 积分系数
+  int16_t kd;           // Q8 微分系数
+  int16_t i_limit;      // Q8 积分限幅（度）
+  int16_t slew;         // Q8 每个控制周期最大转动角度（度）
+  uint16_t x_min;       // 图像坐标与舵机角度的映射关系
+  uint16_t x_max;
+  uint8_t angle_min;
+  uint8_t angle_max;
+} tracker_param_t;
+
+class HW_BlobTracker{
+  public:
+    tracker_param_t param;
+
+    //初始化，angle为手腕当前角度
+    void begin(uint8_t angle);
+    //输入一次色块中心测量值，now为测量时刻(ms)
+    void measure(int16_t x, uint32_t now);
+    //控制周期调用，返回手腕目标角度(Q8)
+    int32_t update(uint32_t now);
+    //目标是否处于跟踪状态
+    bool tracking(uint32_t now);
+    //当前估计的位置(px)与速度(px/s)
+    float position(void) { return x_est; }
+    float velocity(void) { return v_est; }
+
+  private:
+    //卡尔曼滤波状态
+    float x_est = 0;
+    float v_est = 0;
+    float p00 = 0, p01 = 0, p11 = 0;
+    uint32_t meas_tick = 0;
+    bool valid = false;
+
+    //PID状态(Q8)
+    int32_t out = 0;
+    int32_t integ = 0;
+    int32_t last_err = 0;
+
+    void predict(float dt);
+};
+
+#endif //__HW_BLOB_TRACKER_H_
@@ -112,3 +112,32 @@ bool HW_ESP32Cam::color_position(uint8_t *color_info)
   return false;
 }
 
+//读取ESP32Cam识别颜色位置及追踪信息，读取成功且识别到颜色返回true
+bool HW_ESP32Cam::color_position_traced(uint8_t *color_info, cam_trace_t *trace)
+{
+  uint8_t data[12];
+  int num = WireReadDataArray(0x12,data,12);
+  trace->read_ms = millis();
+  if(num != 12)
+  {
+    trace->seq = 0;
+    return false;
+  }
+  memcpy(color_info, data, 4);
+  trace->seq = data[4] | (data[5] << 8);
+  trace->capture_to_detect = data[6] | (data[7] << 8);
+  trace->detect = data[8] | (data[9] << 8);
+  trace->detect_to_read = data[10] | (data[11] << 8);
+  return color_info[2] > 0;
+}
+
+//读取状态寄存器，bit0 为1表示画面没有变化、结果是上一次的重发
+int HW_ESP32Cam::result_status(void)
+{
+  uint8_t status;
+  if(WireReadDataArray(0x03,&status,1) != 1)
+  {
+    return -1;
+  }
+  return status;
+}
@@ -12,6 +12,19 @@
 
 #define ESP32CAM_ADDR 0x52
 
+// 状态寄存器(0x03)的位：画面没有变化，ESP32Cam 重发的是上一次的结果（旧程序没有该寄存器）
+#define CAM_STATUS_UNCHANGED 0x01
+
+// 一帧从采集到被Arduino读取的各阶段耗时，需ESP32Cam下载带追踪寄存器(0x10~0x12)的颜色识别程序
+typedef struct
+{
+  uint16_t seq;               // 帧序号
+  uint16_t capture_to_detect; // 采集到开始检测(ms)
+  uint16_t detect;            // 检测耗时(ms)
+  uint16_t detect_to_read;    // 检测完成到被读取(ms)
+  uint32_t read_ms;           // 读取时的millis()
+} cam_trace_t;
+
 class HW_ESP32Cam{
   public:
     //初始化IIC
@@ -22,6 +35,10 @@ class HW_ESP32Cam{
     int colorDetect(void);
     // 颜色位置获取函数
     bool color_position(uint8_t *color_info);
+    // 颜色位置获取函数，同时读取该帧的追踪信息
+    bool color_position_traced(uint8_t *color_info, cam_trace_t *trace);
+    // 读取状态寄存器，失败返回-1；紧接在结果之后读取，(status & CAM_STATUS_UNCHANGED) 表示结果不是新检测的
+    int result_status(void);
 
 };
 
@@ -1,6 +1,7 @@
 #include <FastLED.h> //导入LED库
 #include <Servo.h> //导入舵机库
 #include "hw_esp32cam_ctl.h" //导入ESP32Cam通讯库
+#include "blob_tracker.h" //导入色块跟踪控制器
 #include "tone.h" //导入音调库
 
 const static uint16_t DOC5[] = { TONE_C5 };
@@ -15,12 +16,19 @@ const static uint8_t rgbPin = 13;
 static CRGB rgbs[1];
 //ESP32Cam通讯对象
 HW_ESP32Cam hw_cam;
+//色块跟踪控制器
+HW_BlobTracker tracker;
 //舵机控制对象
 Servo servos[6];
 
 // 舵机角度相关变量
 static uint8_t extended_func_angles[6] = { 80, 100, 100, 80, 70, 95 }; /* 二次开发例程使用的角度数值 */
 static float servo_angles[6] = { 80, 100, 100, 80, 70, 95 };  /* 舵机实际控制的角度数值 */
+static bool track_log = false; /* 是否输出色块轨迹，用于录制并在电脑上仿真 */
+static bool latency_log = false; /* 是否输出端到端延时记录 */
+static cam_trace_t pending_trace; /* 已输入跟踪控制器、等待舵机执行的帧 */
+static uint16_t last_seq = 0;
+static bool trace_pending = false;
 
 // 蜂鸣器相关变量
 static uint16_t tune_num = 0;
@@ -32,6 +40,7 @@ void play_tune(uint16_t *p, uint32_t beat, uint16_t len); /* 蜂鸣器鸣响接
 void tune_task(void); /* 蜂鸣器控制任务 */
 
 void espcam_task(void); /* esp32cam通讯任务 */
+void recv_handler(void); /* 串口调参 */
 
 void setup() {
   Serial.begin(115200);
@@ -44,6 +53,7 @@ void setup() {
   }
 
   hw_cam.begin(); //初始化与ESP32Cam通讯接口
+  tracker.begin(extended_func_angles[5]); //初始化跟踪控制器
 
   //RGB灯初始化并控制
   FastLED.addLeds<WS2812, rgbPin, GRB>(rgbs, 1);
@@ -67,6 +77,8 @@ void loop() {
   tune_task();
   // 舵机控制
   servo_control();
+  // 串口调参
+  recv_handler();
 }
 
 // esp32cam通讯任务
@@ -81,11 +93,60 @@ void espcam_task(void)
   }
   last_tick = millis();
   
-  if(hw_cam.color_position(color_info)) //若识别到颜色
+  cam_trace_t trace;
+  if(hw_cam.color_position_traced(color_info, &trace)) //若识别到颜色
   {
     uint16_t num = color_info[0] + color_info[2]/2; //计算颜色块中心
-    uint16_t angle = map(num , 0 , 320 , 60 , 120); //映射到对应的舵机角度
-    extended_func_angles[5] = angle; //控制舵机运动追踪
+    tracker.measure(num, last_tick); //输入跟踪控制器，由servo_control预测并驱动手腕
+    // 同一帧可能被读取多次，只记录第一次
+    if (trace.seq != 0 && trace.seq != last_seq) {
+      last_seq = trace.seq;
+      pending_trace = trace;
+      trace_pending = true;
+    }
+    if (track_log) {
+      Serial.print("B,");
+      Serial.print(last_tick);
+      Serial.print(',');
+      Serial.println(num);
+    }
+  }
+  else if (track_log)
+  {
+    Serial.print("B,");
+    Serial.print(last_tick);
+    Serial.println(",-1");
+  }
+}
+
+// 串口调参，命令格式与uhand例程一致，以'$'结尾
+// P/I/D: Q8 PID系数  L: 预测提前量ms  Q: 过程噪声  R: 测量噪声  S: Q8 限速  T: 轨迹输出开关
+// E: 延时记录开关  ?: 打印参数
+void recv_handler(void)
+{
+  while (Serial.available() > 0) {
+    String cmd = Serial.readStringUntil('$');
+    const char *arg = cmd.c_str() + 1;
+    switch (cmd[0]) {
+      case 'P': tracker.param.kp = atoi(arg); break;
+      case 'I': tracker.param.ki = atoi(arg); break;
+      case 'D': tracker.param.kd = atoi(arg); break;
+      case 'L': tracker.param.latency_ms = atoi(arg); break;
+      case 'Q': tracker.param.q_accel = atof(arg); break;
+      case 'R': tracker.param.r_meas = atof(arg); break;
+      case 'S': tracker.param.slew = atoi(arg); break;
+      case 'T': track_log = (arg[0] == '1'); break;
+      case 'E': latency_log = (arg[0] == '1'); break;
+      case '?': break;
+      default: continue;
+    }
+    Serial.print("kp:"); Serial.print(tracker.param.kp);
+    Serial.print(" ki:"); Serial.print(tracker.param.ki);
+    Serial.print(" kd:"); Serial.print(tracker.param.kd);
+    Serial.print(" latency:"); Serial.print(tracker.param.latency_ms);
+    Serial.print(" q:"); Serial.print(tracker.param.q_accel);
+    Serial.print(" r:"); Serial.print(tracker.param.r_meas);
+    Serial.print(" slew:"); Serial.println(tracker.param.slew);
   }
 }
 
@@ -93,13 +154,35 @@ void espcam_task(void)
 //舵机控制任务
 void servo_control(void) {
   static uint32_t last_tick = 0;
-  if (millis() - last_tick < 40) {
+  if (millis() - last_tick < 20) {
     return;
   }
   last_tick = millis();
-  for (int i = 0; i < 6; ++i) {
+  for (int i = 0; i < 5; ++i) {
     servo_angles[i] = servo_angles[i] * 0.85 + extended_func_angles[i] * 0.15;
-    servos[i].write(i == 0 || i == 5 ? 180 - servo_angles[i] : servo_angles[i]);
+    servos[i].write(i == 0 ? 180 - servo_angles[i] : servo_angles[i]);
+  }
+  // 手腕由跟踪控制器驱动，不再经过一阶滤波；用脉宽输出以保留Q8的小数部分
+  int32_t wrist = tracker.update(last_tick);
+  servo_angles[5] = wrist / 256.0f;
+  servos[5].writeMicroseconds(2500 - (int32_t)(wrist * 2000 / (180L << 8)));
+
+  // 新测量第一次作用到舵机：输出 E,帧序号,采集->检测,检测,检测->读取,读取->舵机 (ms)
+  // 由 scripts/latency/latency_hist.py 统计
+  if (trace_pending) {
+    trace_pending = false;
+    if (latency_log) {
+      Serial.print("E,");
+      Serial.print(pending_trace.seq);
+      Serial.print(',');
+      Serial.print(pending_trace.capture_to_detect);
+      Serial.print(',');
+      Serial.print(pending_trace.detect);
+      Serial.print(',');
+      Serial.print(pending_trace.detect_to_read);
+      Serial.print(',');
+      Serial.println(millis() - pending_trace.read_ms);
+    }
   }
 }
 
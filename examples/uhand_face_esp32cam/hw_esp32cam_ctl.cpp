@@ -101,3 +101,13 @@ bool HW_ESP32Cam::color_position(uint8_t *color_info)
   return false;
 }
 
+//读取状态寄存器，bit0 为1表示画面没有变化、结果是上一次的重发
+int HW_ESP32Cam::result_status(void)
+{
+  uint8_t status;
+  if(WireReadDataArray(0x03,&status,1) != 1)
+  {
+    return -1;
+  }
+  return status;
+}
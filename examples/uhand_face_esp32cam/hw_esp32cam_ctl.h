@@ -12,6 +12,9 @@
 
 #define ESP32CAM_ADDR 0x52
 
+// 状态寄存器(0x03)的位：画面没有变化，ESP32Cam 重发的是上一次的结果（旧程序没有该寄存器）
+#define CAM_STATUS_UNCHANGED 0x01
+
 class HW_ESP32Cam{
   public:
     //初始化IIC
@@ -22,6 +25,8 @@ class HW_ESP32Cam{
     int colorDetect(void);
     // 颜色位置获取函数
     bool color_position(uint8_t *color_info);
+    // 读取状态寄存器，失败返回-1；紧接在结果之后读取，(status & CAM_STATUS_UNCHANGED) 表示结果不是新检测的
+    int result_status(void);
 
 };
 
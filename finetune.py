@@ -0,0 +1,340 @@
+"""
+Fast on-site fine-tuning of CNNGestureRecognizer for a new venue.
+The convolutional backbone is frozen. Its activations are computed once per image and kept in an
+append-only feature cache next to the model, so newly captured frames only cost one backbone pass
+each, and every fine-tuning run retrains fc1/fc2 from the cache in seconds.
+
+Cache layout (<model>.features/ by default):
+    meta.json     backbone fingerprint, feature size; a different backbone empties the cache
+    features.f16  float16 rows of model.features(), appended
+    index.jsonl   one line per row: path, label, split, source, mtime, size (path and source are real absolute paths)
+"""
+
+'''
+python finetune.py --model models/cnn_gesture.pth --data-dir datasets/resized_img_split --new-data datasets/venue_b
+python finetune.py --model models/cnn_gesture.pth --new-data datasets/venue_b --epochs 20 --save models/venue_b.pth
+'''
+
+import hashlib
+import json
+import logging
+import os
+import time
+from typing import Dict, List, Optional, Tuple
+
+import numpy as np
+import torch
+import torch.nn as nn
+import torch.optim as optim
+
+from train import GestureDataset, GestureTrainer, build_model, decode_dataset, load_dataset_from_folders
+
+# Setup logging
+logging.basicConfig(level=logging.INFO)
+logger = logging.getLogger(__name__)
+
+HEAD_PREFIXES = ('fc1.', 'fc2.')
+
+
+def backbone_fingerprint(model: nn.Module) -> str:
+    """SHA-1 of every parameter outside the head, cached features are only valid for this backbone."""
+    digest = hashlib.sha1()
+    for name, tensor in model.state_dict().items():
+        if not name.startswith(HEAD_PREFIXES):
+            digest.update(name.encode('utf-8'))
+            digest.update(tensor.detach().cpu().contiguous().numpy().tobytes())
+    return digest.hexdigest()
+
+
+class FeatureCache:
+    """Append-only cache of backbone features, keyed by image path and file mtime/size."""
+
+    def __init__(self, cache_dir: str, model: nn.Module, batch_size: int = 64):
+        """
+        Args:
+            cache_dir: Cache directory, created if missing
+            model: Model with features() (CNNGestureRecognizer), used in eval mode
+            batch_size: Images per backbone pass when adding new files
+        """
+        self.cache_dir = cache_dir
+        self.model = model
+        self.batch_size = batch_size
+        self.features_path = os.path.join(cache_dir, 'features.f16')
+        self.index_path = os.path.join(cache_dir, 'index.jsonl')
+        os.makedirs(cache_dir, exist_ok=True)
+
+        with torch.no_grad():
+            self.dim = int(model.features(torch.zeros(1, 3, 64, 64)).shape[1])
+        # 'paths' marks caches keyed by real paths, older caches stored cwd-dependent sources and are rebuilt
+        self.meta = {'backbone_sha1': backbone_fingerprint(model), 'dim': self.dim, 'dtype': 'float16',
+                     'paths': 'realpath'}
+        meta_path = os.path.join(cache_dir, 'meta.json')
+        stale = True
+        if os.path.exists(meta_path):
+            with open(meta_path, 'r', encoding='utf-8') as f:
+                stale = json.load(f) != self.meta
+        if stale:
+            # New or retrained backbone: start over
+            for path in (self.features_path, self.index_path):
+                if os.path.exists(path):
+                    os.remove(path)
+            with open(meta_path, 'w', encoding='utf-8') as f:
+                json.dump(self.meta, f, indent=2)
+        self.rows = self._load_index()
+
+    def _load_index(self) -> List[Dict]:
+        """Read the index, dropping rows an interrupted append left without their partner or only partly written."""
+        rows = []
+        if os.path.exists(self.index_path):
+            with open(self.index_path, 'r', encoding='utf-8') as f:
+                for line in f:
+                    try:
+                        rows.append(json.loads(line))
+                    except json.JSONDecodeError:
+                        break
+        row_bytes = self.dim * 2
+        size = os.path.getsize(self.features_path) if os.path.exists(self.features_path) else 0
+        if size != len(rows) * row_bytes:
+            # Features are written before their index lines, so keep the shorter of the two. A torn last
+            # feature row is cut off as well, otherwise every later append would land misaligned
+            stored = size // row_bytes
+            if stored < len(rows):
+                rows = rows[:stored]
+                with open(self.index_path, 'w', encoding='utf-8') as f:
+                    f.writelines(json.dumps(row) + '\n' for row in rows)
+            with open(self.features_path, 'ab') as f:
+                f.truncate(len(rows) * row_bytes)
+        return rows
+
+    def __len__(self) -> int:
+        return len(self.rows)
+
+    def update(self, paths: List[str], labels: List[int], split: str, source: str) -> int:
+        """
+        Compute and append features of images that are new or changed since they were cached.
+
+        Args:
+            paths: Image files
+            labels: Their labels
+            split: 'train' or 'test'
+            source: Dataset the images come from (e.g. the directory), used for weighting and reports;
+                    stored as a real path so matching does not depend on the working directory
+
+        Returns:
+            Number of rows appended
+        """
+        known = {(row['path'], row['mtime'], row['size']) for row in self.rows}
+        source = os.path.realpath(source)
+        todo = []
+        for path, label in zip(paths, labels):
+            stat = os.stat(path)
+            key = (os.path.realpath(path), stat.st_mtime_ns, stat.st_size)
+            if key not in known:
+                todo.append((key, int(label)))
+        if not todo:
+            return 0
+
+        self.model.eval()
+        for start in range(0, len(todo), self.batch_size):
+            chunk = todo[start:start + self.batch_size]
+            images, _ = decode_dataset(GestureDataset([key[0] for key, _ in chunk], [label for _, label in chunk]))
+            with torch.inference_mode():
+                feats = self.model.features(torch.from_numpy(images).float().div_(255.0))
+            with open(self.features_path, 'ab') as f:
+                f.write(feats.cpu().numpy().astype(np.float16).tobytes())
+            new_rows = [{'path': key[0], 'label': label, 'split': split, 'source': source,
+                         'mtime': key[1], 'size': key[2]} for key, label in chunk]
+            with open(self.index_path, 'a', encoding='utf-8') as f:
+                f.writelines(json.dumps(row) + '\n' for row in new_rows)
+            self.rows.extend(new_rows)
+        return len(todo)
+
+    def load(self) -> Tuple[torch.Tensor, List[Dict]]:
+        """
+        All current rows: float16 features (N, dim) in memory and their index entries.
+        A changed file keeps its old row in the file, only the latest row per path is returned.
+        """
+        latest = {}
+        for i, row in enumerate(self.rows):
+            latest[row['path']] = i
+        keep = np.array(sorted(latest.values()), dtype=np.int64)
+        mapped = np.memmap(self.features_path, dtype=np.float16, mode='r', shape=(len(self.rows), self.dim))
+        return torch.from_numpy(np.ascontiguousarray(mapped[keep])), [self.rows[i] for i in keep]
+
+
+def train_head(model: nn.Module, features: torch.Tensor, labels: torch.Tensor, train_idx: np.ndarray,
+               epochs: int = 30, learning_rate: float = 0.001, weight_decay: float = 1e-4,
+               batch_size: int = 64, seed: int = 0) -> List[float]:
+    """
+    Retrain fc1/fc2 on cached features, the backbone gets no gradients.
+
+    Args:
+        model: Model with classify() (CNNGestureRecognizer)
+        features: Cached features (N, dim), float16
+        labels: Labels (N,)
+        train_idx: Rows to train on, repeat a row to weight it up
+        epochs: Passes over train_idx
+        learning_rate: Adam learning rate
+        weight_decay: L2 regularization weight
+        batch_size: Batch size
+        seed: Shuffling seed
+
+    Returns:
+        Mean training loss per epoch
+    """
+    for name, param in model.named_parameters():
+        param.requires_grad_(name.startswith(HEAD_PREFIXES))
+    head = [param for param in model.parameters() if param.requires_grad]
+    optimizer = optim.Adam(head, lr=learning_rate, weight_decay=weight_decay)
+    criterion = nn.CrossEntropyLoss()
+    generator = torch.Generator().manual_seed(seed)
+    train_idx = torch.from_numpy(train_idx)
+
+    model.train()
+    losses = []
+    for _ in range(epochs):
+        order = train_idx[torch.randperm(len(train_idx), generator=generator)]
+        total = torch.zeros(())
+        for start in range(0, len(order), batch_size):
+            idx = order[start:start + batch_size]
+            optimizer.zero_grad(set_to_none=True)
+            loss = criterion(model.classify(features[idx].float()), labels[idx])
+            loss.backward()
+            optimizer.step()
+            total += loss.detach() * len(idx)
+        losses.append(total.item() / max(1, len(order)))
+    model.eval()
+    for param in model.parameters():
+        param.requires_grad_(True)
+    return losses
+
+
+def head_accuracy(model: nn.Module, features: torch.Tensor, labels: torch.Tensor, idx: np.ndarray) -> float:
+    """Accuracy (%) of the head on the given cached rows."""
+    if len(idx) == 0:
+        return float('nan')
+    model.eval()
+    with torch.inference_mode():
+        correct = 0
+        for start in range(0, len(idx), 1024):
+            rows = torch.from_numpy(idx[start:start + 1024])
+            correct += (model.classify(features[rows].float()).argmax(dim=1) == labels[rows]).sum().item()
+    return 100.0 * correct / len(idx)
+
+
+def load_checkpoint_model(model_path: str) -> nn.Module:
+    """Rebuild the model stored in a train.py checkpoint."""
+    checkpoint = torch.load(model_path, map_location='cpu')
+    state = checkpoint['model_state_dict']
+    kwargs = {'hidden_units': state['fc1.weight'].shape[0]} if 'fc1.weight' in state else {}
+    model = build_model(checkpoint.get('model_architecture', 'CNNGestureRecognizer'), num_classes=11, **kwargs)
+    model.load_state_dict(state)
+    return model.eval()
+
+
+def finetune(model_path: str, data_dirs: List[str], new_dirs: List[str], save_path: str,
+             cache_dir: Optional[str] = None, epochs: int = 30, learning_rate: float = 0.001,
+             new_weight: int = 4, reset_head: bool = False, export: bool = True) -> Dict:
+    """
+    Update the feature cache with every image under data_dirs and new_dirs, retrain the head and save.
+
+    Args:
+        model_path: train.py checkpoint to adapt
+        data_dirs: Datasets the model was trained on (cached once, then reused)
+        new_dirs: Frames from the new venue, same class folder layout
+        save_path: Output checkpoint, inference artifacts are exported next to it
+        cache_dir: Feature cache, default <model>.features
+        epochs: Head training epochs
+        learning_rate: Head learning rate
+        new_weight: How many times each new-venue training frame is repeated per epoch
+        reset_head: Reinitialize fc1/fc2 instead of starting from the trained head
+        export: Export TorchScript/ONNX/.uhm next to save_path
+
+    Returns:
+        Summary with timings and accuracies
+    """
+    model = load_checkpoint_model(model_path)
+    if not hasattr(model, 'features'):
+        raise ValueError(f"{type(model).__name__} has no separable backbone, fine-tuning needs CNNGestureRecognizer")
+    cache = FeatureCache(cache_dir or os.path.splitext(model_path)[0] + '.features', model)
+
+    t0 = time.perf_counter()
+    added = 0
+    for data_dir in list(data_dirs) + list(new_dirs):
+        train_paths, test_paths, train_labels, test_labels = load_dataset_from_folders(data_dir)
+        added += cache.update(train_paths, train_labels, 'train', data_dir)
+        added += cache.update(test_paths, test_labels, 'test', data_dir)
+    cache_seconds = time.perf_counter() - t0
+    logger.info(f"Feature cache: {added} images added, {len(cache)} rows ({cache_seconds:.1f} s)")
+
+    features, rows = cache.load()
+    labels = torch.tensor([row['label'] for row in rows], dtype=torch.long)
+    sources = {os.path.realpath(d) for d in new_dirs}
+    is_new = np.array([row['source'] in sources for row in rows])
+    is_train = np.array([row['split'] == 'train' for row in rows])
+    wanted = {os.path.realpath(d) for d in list(data_dirs) + list(new_dirs)}
+    in_use = np.array([row['source'] in wanted for row in rows])
+    train_idx = np.flatnonzero(is_train & in_use)
+    train_idx = np.concatenate([train_idx] + [np.flatnonzero(is_train & is_new)] * max(0, new_weight - 1))
+    test_idx = np.flatnonzero(~is_train & in_use)
+    new_test_idx = np.flatnonzero(~is_train & is_new)
+
+    before = head_accuracy(model, features, labels, new_test_idx)
+    if reset_head:
+        model.fc1.reset_parameters()
+        model.fc2.reset_parameters()
+    t0 = time.perf_counter()
+    losses = train_head(model, features, labels, train_idx, epochs, learning_rate)
+    train_seconds = time.perf_counter() - t0
+    summary = {
+        'rows': len(rows), 'added': added, 'train_rows': len(train_idx),
+        'cache_seconds': cache_seconds, 'train_seconds': train_seconds, 'final_loss': losses[-1] if losses else None,
+        'test_accuracy': head_accuracy(model, features, labels, test_idx),
+        'new_test_accuracy_before': before,
+        'new_test_accuracy': head_accuracy(model, features, labels, new_test_idx),
+    }
+    logger.info(f"Head retrained in {train_seconds:.1f} s: test accuracy {summary['test_accuracy']:.2f}%, "
+                f"new venue {before:.2f}% -> {summary['new_test_accuracy']:.2f}%")
+
+    GestureTrainer(model, 'cpu', progress=False).save_model(save_path, export=export)
+    return summary
+
+
+def main():
+    """Fine-tune the head of a trained model for a new venue."""
+    import argparse
+
+    parser = argparse.ArgumentParser(description='Frozen-backbone fine-tuning from a feature cache')
+    parser.add_argument('--model', '-m', type=str, default='models/cnn_gesture.pth',
+                        help='Checkpoint to adapt')
+    parser.add_argument('--data-dir', type=str, action='append', default=[],
+                        help='Dataset the model was trained on (repeatable)')
+    parser.add_argument('--new-data', type=str, action='append', default=[],
+                        help='Frames captured at the new venue, class folder layout (repeatable)')
+    parser.add_argument('--save', type=str,
+                        help='Output checkpoint, default <model>_finetuned.pth')
+    parser.add_argument('--cache', type=str,
+                        help='Feature cache directory, default <model>.features')
+    parser.add_argument('--epochs', type=int, default=30,
+                        help='Head training epochs')
+    parser.add_argument('--learning-rate', type=float, default=0.001,
+                        help='Head learning rate')
+    parser.add_argument('--new-weight', type=int, default=4,
+                        help='Repeat each new-venue training frame this many times per epoch')
+    parser.add_argument('--reset-head', action='store_true',
+                        help='Reinitialize fc1/fc2 instead of starting from the trained head')
+    parser.add_argument('--no-export', action='store_true',
+                        help='Only write the checkpoint')
+    args = parser.parse_args()
+    if not args.data_dir and not args.new_data:
+        parser.error('--data-dir or --new-data is required')
+
+    summary = finetune(args.model, args.data_dir, args.new_data,
+                       args.save or os.path.splitext(args.model)[0] + '_finetuned.pth',
+                       args.cache, args.epochs, args.learning_rate, args.new_weight, args.reset_head,
+                       not args.no_export)
+    print(json.dumps(summary, indent=2))
+
+
+if __name__ == "__main__":
+    main()
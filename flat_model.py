@@ -0,0 +1,372 @@
+"""
+Flat memory-mapped model format for the gesture recognition models.
+All model generations (TF .pb from the original project, TF checkpoint parameters saved as .npz,
+PyTorch .pth checkpoints from train.py) are converted into one file that is mapped, not unpickled.
+
+File layout (little-endian):
+    header      128 bytes, see HEADER
+    tensor table num_tensors entries, see TENSOR_ENTRY
+    metadata    UTF-8 JSON (class map, source file, extra hyperparameters)
+    tensor data each tensor starts on a 64-byte boundary, float32, PyTorch layout (NCHW, fc weight [out, in])
+"""
+
+'''
+python flat_model.py convert models/cnn_gesture.pth models/cnn_gesture.uhm
+python flat_model.py convert model_only_pc/digital_gesture.pb models/digital_gesture.uhm
+python flat_model.py info models/cnn_gesture.uhm
+'''
+
+import json
+import logging
+import mmap
+import os
+import struct
+from typing import Dict, Optional, Tuple
+
+import numpy as np
+
+# Setup logging
+logging.basicConfig(level=logging.INFO)
+logger = logging.getLogger(__name__)
+
+MAGIC = b'UHGM'
+VERSION = 1
+ALIGNMENT = 64
+
+# magic, version, header_size, num_tensors, architecture, input_c, input_h, input_w, num_classes,
+# meta_offset, meta_size, table_offset, data_offset, reserved
+HEADER = struct.Struct('<4sIII32sIIIIQQQQ32x')
+# name, dtype, ndim, shape[4], offset, nbytes
+TENSOR_ENTRY = struct.Struct('<56sII4IQQ')
+DTYPE_F32 = 0
+
+DEFAULT_CLASS_MAP = {i: str(i) for i in range(11)}
+
+# Parameter order and TF names of the two-conv network shared by all generations
+TF_PARAMETERS = [
+    ('conv1.weight', 'W_conv1'), ('conv1.bias', 'b_conv1'),
+    ('conv2.weight', 'W_conv2'), ('conv2.bias', 'b_conv2'),
+    ('fc1.weight', 'W_fc1'), ('fc1.bias', 'b_fc1'),
+    ('fc2.weight', 'W_fc2'), ('fc2.bias', 'b_fc2'),
+]
+
+
+def _align(value: int) -> int:
+    return (value + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+
+class FlatModel:
+    """
+    A mapped .uhm file. Tensors are numpy views into the mapping, nothing is copied.
+
+    The mapping is copy-on-write, so the arrays are writable (torch.from_numpy accepts them)
+    but writes never reach the file.
+    """
+
+    def __init__(self, path: str):
+        """
+        Args:
+            path: Path to the .uhm file
+        """
+        self.path = path
+        with open(path, 'rb') as f:
+            self._mmap = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_COPY)
+        buf = self._mmap
+        if len(buf) < HEADER.size:
+            raise ValueError(f"{path}: file too small")
+        (magic, version, header_size, num_tensors, arch, c, h, w, num_classes,
+         meta_offset, meta_size, table_offset, data_offset) = HEADER.unpack_from(buf, 0)
+        if magic != MAGIC:
+            raise ValueError(f"{path}: not a flat model file")
+        if version != VERSION:
+            raise ValueError(f"{path}: unsupported version {version}")
+        self.architecture = arch.rstrip(b'\0').decode('ascii')
+        self.input_size = (c, h, w)
+        self.num_classes = num_classes
+        meta = json.loads(bytes(buf[meta_offset:meta_offset + meta_size]).decode('utf-8'))
+        self.class_map = {int(k): v for k, v in meta.pop('class_map', {}).items()}
+        self.meta = meta
+        self.tensors: Dict[str, np.ndarray] = {}
+        for i in range(num_tensors):
+            name, dtype, ndim, s0, s1, s2, s3, offset, nbytes = TENSOR_ENTRY.unpack_from(
+                buf, table_offset + i * TENSOR_ENTRY.size)
+            if dtype != DTYPE_F32:
+                raise ValueError(f"{path}: unsupported dtype {dtype}")
+            shape = (s0, s1, s2, s3)[:ndim]
+            if offset + nbytes > len(buf) or nbytes != int(np.prod(shape)) * 4:
+                raise ValueError(f"{path}: tensor {i} out of range")
+            array = np.frombuffer(buf, dtype='<f4', count=nbytes // 4, offset=offset).reshape(shape)
+            self.tensors[name.rstrip(b'\0').decode('ascii')] = array
+
+    def state_dict(self):
+        """Tensors as a PyTorch state dict sharing memory with the mapping."""
+        import torch
+        return {name: torch.from_numpy(array) for name, array in self.tensors.items()}
+
+    def build_model(self):
+        """Create the model described by the header with its weights mapped from the file."""
+        import torch
+        from train import build_model
+        kwargs = {'num_classes': self.num_classes}
+        if 'hidden_units' in self.meta:
+            kwargs['hidden_units'] = int(self.meta['hidden_units'])
+        # Build on the meta device so no weights are allocated or initialized, then adopt the mapped tensors
+        with torch.device('meta'):
+            model = build_model(self.architecture, **kwargs)
+        model.load_state_dict(self.state_dict(), assign=True)
+        return model
+
+    def close(self):
+        """Unmap the file. If tensors are still referenced elsewhere the mapping lives on until they are freed."""
+        self.tensors = {}
+        try:
+            self._mmap.close()
+        except BufferError:
+            pass
+
+
+def save_flat_model(path: str, tensors: Dict[str, np.ndarray], architecture: str = 'CNNGestureRecognizer',
+                    input_size: Tuple[int, int, int] = (3, 64, 64), class_map: Optional[dict] = None,
+                    meta: Optional[dict] = None):
+    """
+    Write tensors (PyTorch layout) into a .uhm file.
+
+    Args:
+        path: Output file
+        tensors: Parameter name to array, written in insertion order
+        architecture: Model class name
+        input_size: (channels, height, width)
+        class_map: Class id to name mapping
+        meta: Extra JSON metadata (source, hyperparameters)
+    """
+    class_map = DEFAULT_CLASS_MAP if class_map is None else class_map
+    meta = dict(meta or {})
+    meta['class_map'] = {str(k): v for k, v in class_map.items()}
+    meta_bytes = json.dumps(meta, ensure_ascii=False).encode('utf-8')
+
+    table_offset = HEADER.size
+    meta_offset = table_offset + TENSOR_ENTRY.size * len(tensors)
+    data_offset = _align(meta_offset + len(meta_bytes))
+
+    entries, blobs, offset = [], [], data_offset
+    for name, array in tensors.items():
+        array = np.ascontiguousarray(array, dtype='<f4')
+        if array.ndim > 4 or len(name.encode('ascii')) >= 56:
+            raise ValueError(f"Tensor {name} cannot be stored")
+        shape = list(array.shape) + [0] * (4 - array.ndim)
+        entries.append(TENSOR_ENTRY.pack(name.encode('ascii'), DTYPE_F32, array.ndim, *shape, offset, array.nbytes))
+        blobs.append((offset, array))
+        offset = _align(offset + array.nbytes)
+
+    header = HEADER.pack(MAGIC, VERSION, HEADER.size, len(tensors), architecture.encode('ascii'),
+                         *input_size, len(class_map), meta_offset, len(meta_bytes), table_offset, data_offset)
+    os.makedirs(os.path.dirname(path) or '.', exist_ok=True)
+    tmp_path = path + '.tmp'
+    with open(tmp_path, 'wb') as f:
+        f.write(header)
+        f.write(b''.join(entries))
+        f.write(meta_bytes)
+        for blob_offset, array in blobs:
+            f.write(b'\0' * (blob_offset - f.tell()))
+            f.write(array.tobytes())
+    os.replace(tmp_path, path)
+    logger.info(f"Flat model saved to {path} ({offset} bytes, {len(tensors)} tensors)")
+
+
+def tf_to_torch_layout(parameters: Dict[str, np.ndarray]) -> Dict[str, np.ndarray]:
+    """
+    Convert the TF parameters of the original project (W_conv1 ... b_fc2, NHWC) into PyTorch layout.
+
+    Conv kernels go from [kh, kw, in, out] to [out, in, kh, kw]. The TF graph flattens the last
+    feature map as (h, w, c), CNNGestureRecognizer as (c, h, w), so the rows of W_fc1 are reordered.
+    """
+    out = {}
+    for torch_name, tf_name in TF_PARAMETERS:
+        array = np.asarray(parameters[tf_name], dtype=np.float32)
+        if tf_name.startswith('W_conv'):
+            array = array.transpose(3, 2, 0, 1)
+        elif tf_name == 'W_fc1':
+            c = parameters['W_conv2'].shape[3]
+            hw = int(round((array.shape[0] / c) ** 0.5))
+            array = array.reshape(hw, hw, c, -1).transpose(3, 2, 0, 1).reshape(array.shape[1], -1)
+        elif tf_name == 'W_fc2':
+            array = array.T
+        out[torch_name] = np.ascontiguousarray(array)
+    return out
+
+
+def _read_varint(buf: bytes, pos: int) -> Tuple[int, int]:
+    result, shift = 0, 0
+    while True:
+        b = buf[pos]
+        pos += 1
+        result |= (b & 0x7F) << shift
+        if not b & 0x80:
+            return result, pos
+        shift += 7
+
+
+def _proto_fields(buf: bytes):
+    """Iterate (field number, wire type, value) over a serialized protobuf message."""
+    pos = 0
+    while pos < len(buf):
+        key, pos = _read_varint(buf, pos)
+        field, wire = key >> 3, key & 7
+        if wire == 0:
+            value, pos = _read_varint(buf, pos)
+        elif wire == 1:
+            value, pos = buf[pos:pos + 8], pos + 8
+        elif wire == 2:
+            size, pos = _read_varint(buf, pos)
+            value, pos = buf[pos:pos + size], pos + size
+        elif wire == 5:
+            value, pos = buf[pos:pos + 4], pos + 4
+        else:
+            raise ValueError(f"Unsupported protobuf wire type {wire}")
+        yield field, wire, value
+
+
+def _parse_tf_tensor(buf: bytes) -> Optional[np.ndarray]:
+    """Decode a float TensorProto (dtype 1), None for other dtypes."""
+    dtype, shape, content, floats = 0, [], None, []
+    for field, wire, value in _proto_fields(buf):
+        if field == 1:
+            dtype = value
+        elif field == 2:
+            for dim_field, _, dim in _proto_fields(value):
+                if dim_field == 2:
+                    shape.append(next((v for f, _, v in _proto_fields(dim) if f == 1), 0))
+        elif field == 4:
+            content = value
+        elif field == 5:
+            floats.extend(np.frombuffer(value, dtype='<f4') if wire == 2 else [struct.unpack('<f', value)[0]])
+    if dtype != 1:
+        return None
+    if content is not None:
+        return np.frombuffer(content, dtype='<f4').reshape(shape)
+    if len(floats) == int(np.prod(shape)):
+        return np.array(floats, dtype=np.float32).reshape(shape)
+    # Constants filled with one value are stored as a single float_val
+    return np.full(shape, floats[0] if floats else 0.0, dtype=np.float32)
+
+
+def load_tf_graph_parameters(pb_path: str) -> Dict[str, np.ndarray]:
+    """
+    Read the frozen weights of the original TF model (.pb) without TensorFlow.
+
+    The variables were frozen without names (Variable, Variable_1, ...), so they are matched by shape.
+    """
+    with open(pb_path, 'rb') as f:
+        graph = f.read()
+    consts = []
+    for field, _, node in _proto_fields(graph):
+        if field != 1:
+            continue
+        op, tensor = None, None
+        for node_field, _, value in _proto_fields(node):
+            if node_field == 2:
+                op = value.decode('utf-8')
+            elif node_field == 5:  # attr map entry: key = 1, value = 2 (AttrValue, tensor = 8)
+                entry = dict((f, v) for f, _, v in _proto_fields(value))
+                if entry.get(1) == b'value' and 2 in entry:
+                    for attr_field, _, attr in _proto_fields(entry[2]):
+                        if attr_field == 8:
+                            tensor = _parse_tf_tensor(attr)
+        if op == 'Const' and tensor is not None:
+            consts.append(tensor)
+
+    conv = [t for t in consts if t.ndim == 4]
+    mats = [t for t in consts if t.ndim == 2]
+    if len(conv) != 2 or len(mats) != 2:
+        raise ValueError(f"{pb_path}: expected 2 conv kernels and 2 matrices, found {len(conv)} and {len(mats)}")
+    W_conv1, W_conv2 = sorted(conv, key=lambda t: t.shape[2])
+    W_fc1, W_fc2 = sorted(mats, key=lambda t: -t.shape[0])
+
+    def bias(size):
+        found = [t for t in consts if t.ndim == 1 and t.shape[0] == size]
+        if not found:
+            raise ValueError(f"{pb_path}: no bias of size {size}")
+        return found[0]
+
+    return {'W_conv1': W_conv1, 'b_conv1': bias(W_conv1.shape[3]),
+            'W_conv2': W_conv2, 'b_conv2': bias(W_conv2.shape[3]),
+            'W_fc1': W_fc1, 'b_fc1': bias(W_fc1.shape[1]),
+            'W_fc2': W_fc2, 'b_fc2': bias(W_fc2.shape[1])}
+
+
+def load_torch_checkpoint(pth_path: str) -> Tuple[Dict[str, np.ndarray], str]:
+    """
+    Read the model weights of a train.py checkpoint, optimizer state and other entries are dropped.
+
+    Returns:
+        (tensors, architecture class name), checkpoints without 'model_architecture' are CNNGestureRecognizer
+    """
+    import torch
+    checkpoint = torch.load(pth_path, map_location='cpu')
+    architecture = 'CNNGestureRecognizer'
+    state = checkpoint
+    if isinstance(checkpoint, dict) and 'model_state_dict' in checkpoint:
+        state = checkpoint['model_state_dict']
+        architecture = checkpoint.get('model_architecture', architecture)
+    return {name: tensor.detach().cpu().float().numpy() for name, tensor in state.items()}, architecture
+
+
+def convert(src: str, dst: str, class_map: Optional[dict] = None):
+    """
+    Convert a model file of any generation into the flat format.
+
+    Args:
+        src: .pth (train.py), .pb (original TF project) or .npz (TF parameters W_conv1 ... b_fc2,
+             e.g. saved with np.savez from load_model.load_parameters())
+        dst: Output .uhm file
+        class_map: Class id to name mapping, default 0-10
+    """
+    ext = os.path.splitext(src)[1].lower()
+    architecture = 'CNNGestureRecognizer'
+    if ext in ('.pth', '.pt'):
+        tensors, architecture = load_torch_checkpoint(src)
+    elif ext == '.pb':
+        tensors = tf_to_torch_layout(load_tf_graph_parameters(src))
+    elif ext == '.npz':
+        tensors = tf_to_torch_layout(dict(np.load(src)))
+    else:
+        raise ValueError(f"Unsupported model file: {src}")
+
+    if class_map is None:
+        # The classifier is the last linear layer: fc2 in CNNGestureRecognizer, fc in TinyGestureRecognizer
+        classifier = [array for name, array in tensors.items() if name.endswith('.weight') and array.ndim == 2][-1]
+        class_map = {i: DEFAULT_CLASS_MAP.get(i, f"Class_{i}") for i in range(classifier.shape[0])}
+    meta = {'source': os.path.basename(src)}
+    if 'fc1.weight' in tensors:
+        meta['hidden_units'] = int(tensors['fc1.weight'].shape[0])
+    save_flat_model(dst, tensors, architecture, (3, 64, 64), class_map, meta)
+
+
+def main():
+    """Command line: convert and inspect flat model files."""
+    import argparse
+
+    parser = argparse.ArgumentParser(description='Flat memory-mapped gesture model files')
+    sub = parser.add_subparsers(dest='command', required=True)
+    p_convert = sub.add_parser('convert', help='Convert .pth / .pb / .npz into .uhm')
+    p_convert.add_argument('src', type=str)
+    p_convert.add_argument('dst', type=str)
+    p_info = sub.add_parser('info', help='Print header and tensor table')
+    p_info.add_argument('path', type=str)
+
+    args = parser.parse_args()
+    if args.command == 'convert':
+        convert(args.src, args.dst)
+    else:
+        model = FlatModel(args.path)
+        print(f"architecture: {model.architecture}")
+        print(f"input size:   {model.input_size}")
+        print(f"classes:      {model.num_classes} {model.class_map}")
+        print(f"meta:         {model.meta}")
+        for name, array in model.tensors.items():
+            print(f"  {name:<16} {str(array.shape):<20} {array.nbytes:>10} bytes")
+        model.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -9,14 +9,15 @@ python inference.py --model models/cnn_gesture.pth --mode image --input datasets
 
 import torch
 import torch.nn.functional as F
+import ctypes
 import cv2
 import numpy as np
 from PIL import Image
 import os
-from typing import List, Union
+from typing import List, Optional, Union
 import logging
 
-from train import CNNGestureRecognizer
+from train import CNNGestureRecognizer, build_model
 
 # Setup logging
 logging.basicConfig(level=logging.INFO)
@@ -28,34 +29,116 @@ GESTURE_CLASSES = {
         5: "5", 6: "6", 7: "7", 8: "8", 9: "9", 10: "10"
     }
 
+# Inference backends and the artifact each one loads (train.py writes them next to the checkpoint)
+BACKENDS = {
+    'torch': None,                   # .pth checkpoint or .uhm flat model, eager PyTorch
+    'torchscript': '.torchscript.pt',
+    'onnxruntime': '.onnx',
+    'native': '.uhm',                # native/gesture_native.cpp through ctypes
+}
+
+NATIVE_LIB = os.environ.get('GESTURE_NATIVE_LIB',
+                            os.path.join(os.path.dirname(os.path.abspath(__file__)), 'native', 'libgesture_native.so'))
+
+
+def backend_artifact(model_path: str, backend: str) -> str:
+    """
+    Path of the artifact a backend loads. A checkpoint path is mapped to its sibling artifact,
+    e.g. models/cnn_gesture.pth -> models/cnn_gesture.onnx for onnxruntime.
+    """
+    suffix = BACKENDS[backend]
+    if suffix is None or model_path.endswith(suffix):
+        return model_path
+    return os.path.splitext(model_path)[0] + suffix
+
+
+class NativeGestureModel:
+    """ctypes wrapper of native/libgesture_native.so, weights are mapped from a .uhm file."""
+    
+    def __init__(self, model_path: str, lib_path: str = NATIVE_LIB):
+        """
+        Args:
+            model_path: Path to the .uhm file
+            lib_path: Path to the shared library (see native/gesture_native.h for the build command)
+        """
+        if not os.path.exists(lib_path):
+            raise FileNotFoundError(f"Native library not found: {lib_path}")
+        lib = ctypes.CDLL(lib_path)
+        lib.gesture_native_open.argtypes = [ctypes.c_char_p]
+        lib.gesture_native_open.restype = ctypes.c_void_p
+        lib.gesture_native_close.argtypes = [ctypes.c_void_p]
+        lib.gesture_native_last_error.restype = ctypes.c_char_p
+        lib.gesture_native_num_classes.argtypes = [ctypes.c_void_p]
+        lib.gesture_native_forward.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int, ctypes.c_void_p]
+        self._lib = lib
+        self._net = lib.gesture_native_open(model_path.encode('utf-8'))
+        if not self._net:
+            raise RuntimeError(lib.gesture_native_last_error().decode('utf-8'))
+        self.num_classes = lib.gesture_native_num_classes(self._net)
+    
+    def forward(self, batch: np.ndarray) -> np.ndarray:
+        """Logits (N, num_classes) for a float32 (N, C, H, W) batch."""
+        batch = np.ascontiguousarray(batch, dtype=np.float32)
+        logits = np.empty((batch.shape[0], self.num_classes), dtype=np.float32)
+        self._lib.gesture_native_forward(self._net, batch.ctypes.data, batch.shape[0], logits.ctypes.data)
+        return logits
+    
+    def __del__(self):
+        if getattr(self, '_net', None):
+            self._lib.gesture_native_close(self._net)
+            self._net = None
+
 
 class GesturePredictor:
     """Class for making predictions with the trained gesture recognition model."""
     
-    def __init__(self, model_path: str, device: str = 'auto'):
+    def __init__(self, model_path: Optional[str], device: str = 'auto', backend: str = 'torch'):
         """
         Initialize the predictor.
         
         Args:
-            model_path: Path to the trained model file
-            device: Device to use ('auto', 'cpu', 'cuda')
+            model_path: Path to the trained model file, None keeps untrained weights (benchmarks only)
+            device: Device to use ('auto', 'cpu', 'cuda'), onnxruntime and native always run on CPU
+            backend: 'torch', 'torchscript', 'onnxruntime' or 'native', see BACKENDS
         """
-        if device == 'auto':
+        if backend not in BACKENDS:
+            raise ValueError(f"Unknown backend: {backend}")
+        self.backend = backend
+        if backend in ('onnxruntime', 'native'):
+            self.device = torch.device('cpu')
+        elif device == 'auto':
             self.device = torch.device('cuda' if torch.cuda.is_available() else 'cpu')
         else:
             self.device = torch.device(device)
             
         # Initialize and load the model
-        self.model = CNNGestureRecognizer(num_classes=11)
-        self.load_model(model_path)
-        self.model.eval()
+        self.class_names = GESTURE_CLASSES
+        self.model = None
+        if backend != 'torch':
+            if model_path is None:
+                raise ValueError(f"Backend {backend} needs a model file")
+            self.load_backend(backend_artifact(model_path, backend))
+        elif model_path is not None and model_path.endswith('.uhm'):
+            self.load_flat_model(model_path)
+        else:
+            self.model = CNNGestureRecognizer(num_classes=11)
+            if model_path is None:
+                logger.warning("No model file given, using untrained weights")
+                self.model.to(self.device)
+            else:
+                self.load_model(model_path)
+        if self.model is not None:
+            self.model.eval()
         
-        logger.info(f"Model loaded on device: {self.device}")
+        logger.info(f"Model loaded on device: {self.device} (backend: {backend})")
     
     def load_model(self, model_path: str):
         """Load the trained model."""
         try:
             checkpoint = torch.load(model_path, map_location=self.device)
+            architecture = checkpoint.get('model_architecture', type(self.model).__name__)
+            if architecture != type(self.model).__name__:
+                self.model = build_model(architecture, num_classes=11)
             self.model.load_state_dict(checkpoint['model_state_dict'])
             self.model.to(self.device)
             logger.info(f"Model successfully loaded from {model_path}")
@@ -66,6 +149,46 @@ class GesturePredictor:
             logger.error(f"Error loading model: {str(e)}")
             raise
     
+    def load_flat_model(self, model_path: str):
+        """Map a .uhm file (see flat_model.py), the weights are used in place without unpickling or copying."""
+        from flat_model import FlatModel
+        try:
+            flat = FlatModel(model_path)
+            self.model = flat.build_model().to(self.device)
+            self.class_names = flat.class_map or GESTURE_CLASSES
+            logger.info(f"Flat model mapped from {model_path}")
+        except FileNotFoundError:
+            logger.error(f"Model file not found: {model_path}")
+            raise
+    
+    def load_backend(self, artifact_path: str):
+        """Load the exported artifact of a non-eager backend."""
+        if not os.path.exists(artifact_path):
+            logger.error(f"Model file not found: {artifact_path}")
+            raise FileNotFoundError(f"Model file not found: {artifact_path}")
+        if self.backend == 'torchscript':
+            self.model = torch.jit.load(artifact_path, map_location=self.device)
+        elif self.backend == 'onnxruntime':
+            import onnxruntime as ort
+            self._session = ort.InferenceSession(artifact_path, providers=['CPUExecutionProvider'])
+            self._input_name = self._session.get_inputs()[0].name
+        else:
+            from flat_model import FlatModel
+            flat = FlatModel(artifact_path)
+            self.class_names = flat.class_map or GESTURE_CLASSES
+            flat.close()
+            self._native = NativeGestureModel(artifact_path)
+        logger.info(f"Model successfully loaded from {artifact_path}")
+    
+    def _logits(self, batch: torch.Tensor) -> torch.Tensor:
+        """Forward pass of the selected backend on a preprocessed (N, C, H, W) batch."""
+        if self.model is not None:
+            return self.model(batch)
+        batch = batch.cpu().numpy()
+        if self.backend == 'onnxruntime':
+            return torch.from_numpy(self._session.run(None, {self._input_name: batch})[0])
+        return torch.from_numpy(self._native.forward(batch))
+    
     def preprocess_image(self, image: Union[str, np.ndarray, Image.Image]) -> torch.Tensor:
         """
         Preprocess an image for model input.
@@ -123,7 +246,7 @@ class GesturePredictor:
         
         # Make prediction
         with torch.no_grad():
-            output = self.model(image_tensor)
+            output = self._logits(image_tensor)
             probabilities = F.softmax(output, dim=1)
             predicted_class = torch.argmax(probabilities, dim=1).item()
         
@@ -133,6 +256,20 @@ class GesturePredictor:
         else:
             return predicted_class
     
+    def predict_proba(self, image_tensors: List[torch.Tensor]) -> np.ndarray:
+        """
+        Run one forward pass over already preprocessed images.
+        
+        Args:
+            image_tensors: Tensors returned by preprocess_image, each of shape (1, C, H, W)
+            
+        Returns:
+            Probabilities of shape (N, num_classes)
+        """
+        with torch.no_grad():
+            output = self._logits(torch.cat(image_tensors, dim=0))
+            return F.softmax(output, dim=1).cpu().numpy()
+    
     def predict_batch(self, images: List[Union[str, np.ndarray, Image.Image]]) -> List[int]:
         """
         Make predictions on a batch of images.
@@ -143,11 +280,10 @@ class GesturePredictor:
         Returns:
             List of predicted classes
         """
-        predictions = []
-        for image in images:
-            pred = self.predict(image)
-            predictions.append(pred)
-        return predictions
+        if not images:
+            return []
+        probabilities = self.predict_proba([self.preprocess_image(image) for image in images])
+        return [int(pred) for pred in np.argmax(probabilities, axis=1)]
     
     def get_top_k_predictions(self, image: Union[str, np.ndarray, Image.Image], 
                              k: int = 3) -> List[tuple]:
@@ -168,22 +304,124 @@ class GesturePredictor:
         
         results = []
         for idx in top_k_indices:
-            class_name = GESTURE_CLASSES.get(idx, f"Class_{idx}")
+            class_name = self.class_names.get(idx, f"Class_{idx}")
             probability = probabilities[idx]
             results.append((idx, class_name, probability))
         
         return results
 
 
-def predict_from_camera(model_path: str, camera_id: int = 0):
+class CascadePredictor:
+    """
+    Two-stage predictor: a small first-stage model (train.py --arch tiny) answers the frames it is confident
+    about and only the rest are escalated to the full model. It has the same interface as GesturePredictor.
+    The threshold is calibrated on held-out images by scripts/cascade/calibrate_cascade.py.
+    """
+    
+    def __init__(self, tiny_path: str, full_path: str, threshold: float = 0.9, device: str = 'auto',
+                 backend: str = 'torch', tiny_backend: str = 'torch'):
+        """
+        Args:
+            tiny_path: Path to the first-stage model
+            full_path: Path to the full model
+            threshold: Frames whose first-stage top-1 probability is below this go to the full model
+            device: Device to use ('auto', 'cpu', 'cuda')
+            backend: Backend of the full model, see BACKENDS
+            tiny_backend: Backend of the first-stage model ('native' only runs CNNGestureRecognizer)
+        """
+        self.full = GesturePredictor(full_path, device, backend)
+        # Both stages share one preprocessed tensor, so keep them on the same device
+        self.tiny = GesturePredictor(tiny_path, str(self.full.device), tiny_backend)
+        self.threshold = threshold
+        self.device = self.full.device
+        self.class_names = self.full.class_names
+        self.frames = 0
+        self.escalated = 0
+    
+    @classmethod
+    def from_calibration(cls, calibration_path: str, device: str = 'auto', backend: str = 'torch'):
+        """Create a cascade from the JSON written by scripts/cascade/calibrate_cascade.py."""
+        import json
+        with open(calibration_path, 'r', encoding='utf-8') as f:
+            calibration = json.load(f)
+        logger.info(f"Cascade threshold {calibration['threshold']:.3f} "
+                    f"(calibrated escalation rate {calibration.get('escalation_rate', float('nan')):.1%})")
+        return cls(calibration['tiny_model'], calibration['full_model'], calibration['threshold'], device, backend)
+    
+    @property
+    def escalation_rate(self) -> float:
+        """Fraction of frames seen so far that needed the full model."""
+        return self.escalated / self.frames if self.frames else 0.0
+    
+    def preprocess_image(self, image: Union[str, np.ndarray, Image.Image]) -> torch.Tensor:
+        """Preprocess an image for both stages, see GesturePredictor.preprocess_image."""
+        return self.full.preprocess_image(image)
+    
+    def predict_proba(self, image_tensors: List[torch.Tensor]) -> np.ndarray:
+        """
+        Run the first stage on every image and the full model on the uncertain ones only.
+        
+        Args:
+            image_tensors: Tensors returned by preprocess_image, each of shape (1, C, H, W)
+            
+        Returns:
+            Probabilities of shape (N, num_classes), rows of escalated images come from the full model
+        """
+        probabilities = self.tiny.predict_proba(image_tensors)
+        escalate = np.flatnonzero(probabilities.max(axis=1) < self.threshold)
+        if len(escalate):
+            probabilities[escalate] = self.full.predict_proba([image_tensors[i] for i in escalate])
+        self.frames += len(image_tensors)
+        self.escalated += len(escalate)
+        return probabilities
+    
+    def predict(self, image: Union[str, np.ndarray, Image.Image],
+                return_probabilities: bool = False) -> Union[int, tuple]:
+        """Make a prediction on a single image, see GesturePredictor.predict."""
+        probs = self.predict_proba([self.preprocess_image(image)])[0]
+        predicted_class = int(np.argmax(probs))
+        if return_probabilities:
+            return predicted_class, probs
+        return predicted_class
+    
+    def predict_batch(self, images: List[Union[str, np.ndarray, Image.Image]]) -> List[int]:
+        """Make predictions on a batch of images."""
+        if not images:
+            return []
+        probabilities = self.predict_proba([self.preprocess_image(image) for image in images])
+        return [int(pred) for pred in np.argmax(probabilities, axis=1)]
+    
+    def get_top_k_predictions(self, image: Union[str, np.ndarray, Image.Image],
+                              k: int = 3) -> List[tuple]:
+        """Get top-k predictions as (class_id, class_name, probability) tuples."""
+        _, probabilities = self.predict(image, return_probabilities=True)
+        top_k_indices = np.argsort(probabilities)[-k:][::-1]
+        return [(idx, self.class_names.get(idx, f"Class_{idx}"), probabilities[idx]) for idx in top_k_indices]
+
+
+def make_predictor(model_path: Optional[str], server: str = None, backend: str = 'torch', cascade: str = None):
+    """Predictor for the CLI helpers: a server client, a cascade from its calibration file, or a single model."""
+    if server:
+        from inference_server import InferenceClient
+        return InferenceClient(server)
+    if cascade:
+        return CascadePredictor.from_calibration(cascade, backend=backend)
+    return GesturePredictor(model_path, backend=backend)
+
+
+def predict_from_camera(model_path: str, camera_id: int = 0, server: str = None, backend: str = 'torch',
+                        cascade: str = None):
     """
     Real-time gesture prediction from camera feed.
     
     Args:
         model_path: Path to the trained model
         camera_id: Camera device ID
+        server: Socket path of a running inference_server.py, the model is not loaded locally when set
+        backend: Inference backend, see BACKENDS
+        cascade: Calibration file of a tiny/full cascade, used instead of model_path when set
     """
-    predictor = GesturePredictor(model_path)
+    predictor = make_predictor(model_path, server, backend, cascade)
     cap = cv2.VideoCapture(camera_id)
     
     if not cap.isOpened():
@@ -222,9 +460,13 @@ def predict_from_camera(model_path: str, camera_id: int = 0):
     finally:
         cap.release()
         cv2.destroyAllWindows()
+        if isinstance(predictor, CascadePredictor):
+            logger.info(f"Cascade escalated {predictor.escalated}/{predictor.frames} frames "
+                        f"({predictor.escalation_rate:.1%})")
 
 
-def predict_from_images(model_path: str, image_paths: List[str], output_file: str = None):
+def predict_from_images(model_path: str, image_paths: List[str], output_file: str = None, server: str = None,
+                        backend: str = 'torch', cascade: str = None):
     """
     Make predictions on a list of image files.
     
@@ -232,8 +474,11 @@ def predict_from_images(model_path: str, image_paths: List[str], output_file: st
         model_path: Path to the trained model
         image_paths: List of image file paths
         output_file: Optional file to save results
+        server: Socket path of a running inference_server.py, the model is not loaded locally when set
+        backend: Inference backend, see BACKENDS
+        cascade: Calibration file of a tiny/full cascade, used instead of model_path when set
     """
-    predictor = GesturePredictor(model_path)
+    predictor = make_predictor(model_path, server, backend, cascade)
     results = []
     
     logger.info(f"Making predictions on {len(image_paths)} images...")
@@ -272,7 +517,7 @@ def main():
     import argparse
     
     parser = argparse.ArgumentParser(description='Gesture Recognition Inference')
-    parser.add_argument('--model', '-m', type=str, required=True,
+    parser.add_argument('--model', '-m', type=str,
                        help='Path to the trained model file')
     parser.add_argument('--mode', choices=['camera', 'image', 'batch'], default='image',
                        help='Prediction mode')
@@ -282,17 +527,25 @@ def main():
                        help='Camera device ID')
     parser.add_argument('--output', '-o', type=str,
                        help='Output file for batch results')
+    parser.add_argument('--backend', choices=list(BACKENDS), default='torch',
+                       help='Inference backend, non-torch backends load the artifact exported next to the checkpoint')
+    parser.add_argument('--server', type=str,
+                       help='Send requests to inference_server.py on this socket instead of loading the model')
+    parser.add_argument('--cascade', type=str,
+                       help='Calibration file from scripts/cascade/calibrate_cascade.py, runs the tiny/full cascade')
     
     args = parser.parse_args()
+    if not args.model and not args.server and not args.cascade:
+        parser.error('--model, --server or --cascade is required')
     
     if args.mode == 'camera':
-        predict_from_camera(args.model, args.camera)
+        predict_from_camera(args.model, args.camera, args.server, args.backend, args.cascade)
     elif args.mode == 'image':
         if not args.input:
             logger.error("Input image required for image mode")
             return
         
-        predictor = GesturePredictor(args.model)
+        predictor = make_predictor(args.model, args.server, args.backend, args.cascade)
         top_predictions = predictor.get_top_k_predictions(args.input)
         
         print(f"\nPredictions for {args.input}:")
@@ -319,7 +572,7 @@ def main():
             logger.error("No image files found")
             return
         
-        predict_from_images(args.model, image_paths, args.output)
+        predict_from_images(args.model, image_paths, args.output, args.server, args.backend, args.cascade)
 
 
 if __name__ == "__main__":
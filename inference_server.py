@@ -0,0 +1,392 @@
+"""
+Local inference server for the gesture recognition model.
+The model is loaded once and shared by every client on the PC (camera loops, game tables, CLI).
+Concurrent requests are collected into dynamic batches: a batch is run as soon as it is full
+or when the oldest request has waited max_wait_ms, so added latency is bounded.
+"""
+
+'''
+python inference_server.py --model models/cnn_gesture.pth --socket /tmp/uhand_gesture.sock
+python inference.py --server /tmp/uhand_gesture.sock --mode camera
+'''
+
+import json
+import logging
+import os
+import queue
+import signal
+import socket
+import socketserver
+import struct
+import sys
+import threading
+import time
+from typing import Any, Callable, List, Optional
+
+import numpy as np
+
+# Setup logging
+logging.basicConfig(level=logging.INFO)
+logger = logging.getLogger(__name__)
+
+DEFAULT_SOCKET = '/tmp/uhand_gesture.sock'
+
+# Request:  header + payload
+#   payload_len  uint32
+#   kind         uint8   0: raw RGB uint8 (height x width x 3), 1: encoded image file (jpg/png/...)
+#   k            uint8   number of top predictions to return
+#   height       uint16  raw only
+#   width        uint16  raw only
+# Response: uint32 length + UTF-8 JSON
+#   {"topk": [[class_id, class_name, probability], ...], "batch": n, "wait_ms": t}
+#   {"error": "..."}
+REQUEST_HEADER = struct.Struct('<IBBHH')
+RESPONSE_HEADER = struct.Struct('<I')
+KIND_RAW = 0
+KIND_ENCODED = 1
+MAX_PAYLOAD = 16 * 1024 * 1024
+
+
+def _recv_exact(sock: socket.socket, size: int) -> Optional[bytes]:
+    """Read exactly size bytes, None if the peer closed the connection first."""
+    buf = bytearray(size)
+    view = memoryview(buf)
+    got = 0
+    while got < size:
+        n = sock.recv_into(view[got:], size - got)
+        if n == 0:
+            return None
+        got += n
+    return bytes(buf)
+
+
+class _Pending:
+    """One request waiting in the batch queue."""
+    __slots__ = ('tensor', 'k', 'enqueued', 'done', 'result', 'error', 'batch', 'wait_ms')
+
+    def __init__(self, tensor: Any, k: int):
+        self.tensor = tensor
+        self.k = k
+        self.enqueued = time.perf_counter()
+        self.done = threading.Event()
+        self.result = None
+        self.error = None
+        self.batch = 0
+        self.wait_ms = 0.0
+
+
+class DynamicBatcher:
+    """
+    Collects requests from many threads and runs them through the model in batches.
+
+    A batch starts with the oldest waiting request and closes when it holds max_batch
+    requests or that request has waited max_wait_ms, whichever comes first.
+    Each connection has at most one request in flight, so the batch also closes once
+    every connected client is in it instead of waiting for requests that cannot come.
+    """
+
+    def __init__(self, run_batch: Callable[[List[Any]], np.ndarray], class_names: dict,
+                 max_batch: int = 16, max_wait_ms: float = 5.0):
+        """
+        Args:
+            run_batch: Takes a list of preprocessed inputs, returns probabilities (N, num_classes)
+            class_names: Class id to name mapping
+            max_batch: Largest batch passed to run_batch
+            max_wait_ms: Longest time the first request of a batch waits for others
+        """
+        self.run_batch = run_batch
+        self.class_names = class_names
+        self.max_batch = max(1, max_batch)
+        self.max_wait = max(0.0, max_wait_ms) / 1000.0
+        self.queue = queue.Queue()
+        self.batches = 0
+        self.requests = 0
+        self.clients = 0
+        self._clients_lock = threading.Lock()
+        self._thread = threading.Thread(target=self._run, name='batcher', daemon=True)
+        self._thread.start()
+
+    def submit(self, tensor: Any, k: int = 3, timeout: float = 10.0) -> _Pending:
+        """Queue one preprocessed input and block until its result is ready."""
+        pending = _Pending(tensor, k)
+        self.queue.put(pending)
+        if not pending.done.wait(timeout):
+            raise TimeoutError('inference timed out')
+        if pending.error is not None:
+            raise RuntimeError(pending.error)
+        return pending
+
+    def client_connected(self, delta: int):
+        """Track the number of connected clients, delta is +1 or -1."""
+        with self._clients_lock:
+            self.clients += delta
+
+    def close(self):
+        """Stop the batch thread, requests still queued are answered with an error."""
+        self.queue.put(None)
+        self._thread.join()
+
+    def _collect(self, first: _Pending) -> List[_Pending]:
+        batch = [first]
+        deadline = first.enqueued + self.max_wait
+        while len(batch) < min(self.max_batch, self.clients):
+            remaining = deadline - time.perf_counter()
+            try:
+                # Past the deadline only requests that are already queued are taken
+                item = self.queue.get(timeout=remaining) if remaining > 0 else self.queue.get_nowait()
+            except queue.Empty:
+                break
+            if item is None:
+                self.queue.put(None)
+                break
+            batch.append(item)
+        return batch
+
+    def _run(self):
+        while True:
+            first = self.queue.get()
+            if first is None:
+                break
+            batch = self._collect(first)
+            started = time.perf_counter()
+            try:
+                probabilities = self.run_batch([p.tensor for p in batch])
+                for pending, probs in zip(batch, probabilities):
+                    k = min(max(pending.k, 1), len(probs))
+                    top = np.argsort(probs)[-k:][::-1]
+                    pending.result = [(int(i), self.class_names.get(int(i), f"Class_{int(i)}"), float(probs[i]))
+                                      for i in top]
+            except Exception as e:
+                logger.error(f"Batch inference failed: {str(e)}")
+                for pending in batch:
+                    pending.error = str(e)
+            self.batches += 1
+            self.requests += len(batch)
+            for pending in batch:
+                pending.batch = len(batch)
+                pending.wait_ms = (started - pending.enqueued) * 1000.0
+                pending.done.set()
+        while True:
+            try:
+                pending = self.queue.get_nowait()
+            except queue.Empty:
+                break
+            if pending is not None:
+                pending.error = 'server shutting down'
+                pending.done.set()
+
+
+class _RequestHandler(socketserver.BaseRequestHandler):
+    """One thread per client connection, a connection may send any number of requests."""
+
+    def handle(self):
+        server = self.server
+        server.batcher.client_connected(1)
+        try:
+            self._serve(server)
+        finally:
+            server.batcher.client_connected(-1)
+
+    def _serve(self, server):
+        while True:
+            header = _recv_exact(self.request, REQUEST_HEADER.size)
+            if header is None:
+                return
+            length, kind, k, height, width = REQUEST_HEADER.unpack(header)
+            if length > MAX_PAYLOAD:
+                self._reply({'error': f'payload too large: {length}'})
+                return
+            payload = _recv_exact(self.request, length)
+            if payload is None:
+                return
+            try:
+                image = server.decode(kind, height, width, payload)
+                # Preprocessing runs in the client thread, only the forward pass is batched
+                pending = server.batcher.submit(server.preprocess(image), k)
+                reply = {'topk': pending.result, 'batch': pending.batch, 'wait_ms': round(pending.wait_ms, 3)}
+            except Exception as e:
+                reply = {'error': str(e)}
+            self._reply(reply)
+
+    def _reply(self, reply: dict):
+        body = json.dumps(reply).encode('utf-8')
+        self.request.sendall(RESPONSE_HEADER.pack(len(body)) + body)
+
+
+class InferenceServer(socketserver.ThreadingMixIn, socketserver.UnixStreamServer):
+    """Unix domain socket server in front of a DynamicBatcher."""
+    daemon_threads = True
+
+    def __init__(self, socket_path: str, preprocess: Callable[[np.ndarray], Any], batcher: DynamicBatcher):
+        """
+        Args:
+            socket_path: Path of the Unix domain socket, a stale file is removed
+            preprocess: Turns an RGB uint8 image into the input expected by the batcher
+            batcher: Batcher that owns the model
+        """
+        if os.path.exists(socket_path):
+            os.unlink(socket_path)
+        self.socket_path = socket_path
+        self.preprocess = preprocess
+        self.batcher = batcher
+        super().__init__(socket_path, _RequestHandler)
+
+    @staticmethod
+    def decode(kind: int, height: int, width: int, payload: bytes) -> np.ndarray:
+        """Decode a request payload into an RGB uint8 image."""
+        if kind == KIND_RAW:
+            if len(payload) != height * width * 3:
+                raise ValueError(f"raw image is {len(payload)} bytes, expected {height}x{width}x3")
+            return np.frombuffer(payload, dtype=np.uint8).reshape(height, width, 3)
+        if kind == KIND_ENCODED:
+            import cv2
+            image = cv2.imdecode(np.frombuffer(payload, dtype=np.uint8), cv2.IMREAD_COLOR)
+            if image is None:
+                raise ValueError('cannot decode image')
+            return cv2.cvtColor(image, cv2.COLOR_BGR2RGB)
+        raise ValueError(f"unknown request kind {kind}")
+
+    def server_close(self):
+        super().server_close()
+        self.batcher.close()
+        if os.path.exists(self.socket_path):
+            os.unlink(self.socket_path)
+
+
+class InferenceClient:
+    """
+    Client for InferenceServer.
+
+    Offers the same predict / get_top_k_predictions calls as GesturePredictor,
+    so it can replace a local predictor without other changes.
+    """
+
+    def __init__(self, socket_path: str = DEFAULT_SOCKET, timeout: float = 10.0, num_classes: int = 11):
+        """
+        Args:
+            socket_path: Path of the server socket
+            timeout: Socket timeout in seconds
+            num_classes: Number of classes, used when full probabilities are requested
+        """
+        self.num_classes = num_classes
+        self.last_batch = 0
+        self.last_wait_ms = 0.0
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.settimeout(timeout)
+        self.sock.connect(socket_path)
+
+    def close(self):
+        self.sock.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def _request(self, image, k: int) -> List[tuple]:
+        if isinstance(image, str):
+            if not os.path.exists(image):
+                raise FileNotFoundError(f"Image file not found: {image}")
+            with open(image, 'rb') as f:
+                payload = f.read()
+            header = REQUEST_HEADER.pack(len(payload), KIND_ENCODED, k, 0, 0)
+        else:
+            # Same conventions as GesturePredictor.preprocess_image: arrays are taken as RGB, alpha is dropped
+            image = np.asarray(image)
+            if image.ndim != 3 or image.shape[2] not in (3, 4):
+                raise ValueError("Unsupported image format")
+            payload = np.ascontiguousarray(image[:, :, :3], dtype=np.uint8).tobytes()
+            header = REQUEST_HEADER.pack(len(payload), KIND_RAW, k, image.shape[0], image.shape[1])
+        self.sock.sendall(header + payload)
+        length = _recv_exact(self.sock, RESPONSE_HEADER.size)
+        if length is None:
+            raise ConnectionError('server closed the connection')
+        body = _recv_exact(self.sock, RESPONSE_HEADER.unpack(length)[0])
+        if body is None:
+            raise ConnectionError('server closed the connection')
+        reply = json.loads(body.decode('utf-8'))
+        if 'error' in reply:
+            raise RuntimeError(reply['error'])
+        self.last_batch = reply['batch']
+        self.last_wait_ms = reply['wait_ms']
+        return [tuple(item) for item in reply['topk']]
+
+    def get_top_k_predictions(self, image, k: int = 3) -> List[tuple]:
+        """Get top-k predictions as (class_id, class_name, probability) tuples."""
+        return self._request(image, k)
+
+    def predict(self, image, return_probabilities: bool = False):
+        """Predict the class of one image, optionally with the full probability vector."""
+        if not return_probabilities:
+            return self._request(image, 1)[0][0]
+        probs = np.zeros(self.num_classes, dtype=np.float32)
+        top = self._request(image, self.num_classes)
+        for class_id, _, probability in top:
+            probs[class_id] = probability
+        return top[0][0], probs
+
+
+def build_server(model_path: Optional[str], socket_path: str, max_batch: int, max_wait_ms: float,
+                 device: str = 'auto', backend: str = 'torch', cascade: Optional[str] = None) -> InferenceServer:
+    """Load the model (or the tiny/full cascade described by a calibration file) once and create a server for it."""
+    from inference import CascadePredictor, GesturePredictor
+
+    if cascade:
+        predictor = CascadePredictor.from_calibration(cascade, device, backend)
+    else:
+        predictor = GesturePredictor(model_path, device, backend)
+    # Warm up so the first client does not pay for lazy initialization
+    predictor.predict_proba([predictor.preprocess_image(np.zeros((64, 64, 3), dtype=np.uint8))] * max(1, max_batch))
+    batcher = DynamicBatcher(predictor.predict_proba, predictor.class_names, max_batch, max_wait_ms)
+    return InferenceServer(socket_path, predictor.preprocess_image, batcher)
+
+
+def main():
+    """Run the inference server until interrupted."""
+    import argparse
+
+    parser = argparse.ArgumentParser(description='Gesture Recognition Inference Server')
+    parser.add_argument('--model', '-m', type=str,
+                        help='Path to the trained model file')
+    parser.add_argument('--random-weights', action='store_true',
+                        help='Run with untrained weights (benchmarks only)')
+    parser.add_argument('--socket', '-s', type=str, default=DEFAULT_SOCKET,
+                        help='Unix domain socket path')
+    parser.add_argument('--max-batch', type=int, default=16,
+                        help='Largest dynamic batch')
+    parser.add_argument('--max-wait-ms', type=float, default=5.0,
+                        help='Longest time a request waits for a batch to fill')
+    parser.add_argument('--threads', type=int, default=0,
+                        help='Torch intra-op threads, 0 keeps the default')
+    parser.add_argument('--device', type=str, default='auto',
+                        help="Device to use ('auto', 'cpu', 'cuda')")
+    parser.add_argument('--backend', type=str, default='torch',
+                        help="Inference backend ('torch', 'torchscript', 'onnxruntime', 'native')")
+    parser.add_argument('--cascade', type=str,
+                        help='Calibration file from scripts/cascade/calibrate_cascade.py, serves the tiny/full cascade')
+
+    args = parser.parse_args()
+    if not args.model and not args.random_weights and not args.cascade:
+        parser.error('--model, --random-weights or --cascade is required')
+
+    if args.threads > 0:
+        import torch
+        torch.set_num_threads(args.threads)
+
+    server = build_server(None if args.random_weights else args.model, args.socket,
+                          args.max_batch, args.max_wait_ms, args.device, args.backend, args.cascade)
+    logger.info(f"Listening on {args.socket} (max batch {args.max_batch}, max wait {args.max_wait_ms} ms)")
+    # Stop cleanly on SIGTERM too, so the socket file is removed
+    signal.signal(signal.SIGTERM, lambda signum, frame: sys.exit(0))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        logger.info("Server interrupted by user")
+    finally:
+        logger.info(f"Served {server.batcher.requests} requests in {server.batcher.batches} batches")
+        server.server_close()
+
+
+if __name__ == "__main__":
+    main()
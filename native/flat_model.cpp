@@ -0,0 +1,135 @@
+/*
+ * 手势识别模型的扁平权重文件（.uhm）加载器
+ */
+#include "flat_model.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+
+static const uint32_t FLAT_VERSION = 1;
+static const size_t HEADER_SIZE = 128;
+static const size_t ENTRY_SIZE = 96;
+static const uint32_t DTYPE_F32 = 0;
+
+/* 文件为小端，与 x86/ARM 主机一致，直接 memcpy 读取 */
+template <typename T>
+static T read_le(const uint8_t *p)
+{
+  T v;
+  memcpy(&v, p, sizeof(T));
+  return v;
+}
+
+static std::string read_name(const uint8_t *p, size_t max)
+{
+  size_t n = 0;
+  while (n < max && p[n] != 0) {
+    n++;
+  }
+  return std::string((const char *)p, n);
+}
+
+FlatModel::~FlatModel()
+{
+  close();
+}
+
+bool FlatModel::fail(const std::string &msg)
+{
+  err = msg;
+  close();
+  return false;
+}
+
+void FlatModel::close(void)
+{
+  if (base) {
+    munmap((void *)base, size);
+  }
+  base = nullptr;
+  size = 0;
+  table.clear();
+}
+
+bool FlatModel::open(const std::string &path)
+{
+  close();
+  err.clear();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    err = path + ": cannot open";
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < HEADER_SIZE) {
+    ::close(fd);
+    err = path + ": file too small";
+    return false;
+  }
+  void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED) {
+    err = path + ": mmap failed";
+    return false;
+  }
+  base = (const uint8_t *)p;
+  size = st.st_size;
+
+  /* 文件头布局与 flat_model.py 中的 HEADER 一致 */
+  if (memcmp(base, "UHGM", 4) != 0) {
+    return fail(path + ": not a flat model file");
+  }
+  if (read_le<uint32_t>(base + 4) != FLAT_VERSION) {
+    return fail(path + ": unsupported version");
+  }
+  uint32_t num_tensors = read_le<uint32_t>(base + 12);
+  arch = read_name(base + 16, 32);
+  input_c = read_le<uint32_t>(base + 48);
+  input_h = read_le<uint32_t>(base + 52);
+  input_w = read_le<uint32_t>(base + 56);
+  classes = read_le<uint32_t>(base + 60);
+  uint64_t meta_offset = read_le<uint64_t>(base + 64);
+  uint64_t meta_size = read_le<uint64_t>(base + 72);
+  uint64_t table_offset = read_le<uint64_t>(base + 80);
+  if (meta_offset + meta_size > size || table_offset + (uint64_t)num_tensors * ENTRY_SIZE > size) {
+    return fail(path + ": header out of range");
+  }
+  meta.assign((const char *)base + meta_offset, meta_size);
+
+  for (uint32_t i = 0; i < num_tensors; i++) {
+    const uint8_t *e = base + table_offset + (uint64_t)i * ENTRY_SIZE;
+    FlatTensor t;
+    t.name = read_name(e, 56);
+    uint32_t dtype = read_le<uint32_t>(e + 56);
+    uint32_t ndim = read_le<uint32_t>(e + 60);
+    uint64_t offset = read_le<uint64_t>(e + 80);
+    uint64_t nbytes = read_le<uint64_t>(e + 88);
+    if (dtype != DTYPE_F32 || ndim > 4) {
+      return fail(path + ": unsupported tensor " + t.name);
+    }
+    t.count = 1;
+    for (uint32_t d = 0; d < ndim; d++) {
+      t.shape.push_back(read_le<uint32_t>(e + 64 + d * 4));
+      t.count *= t.shape.back();
+    }
+    if (offset % 4 != 0 || nbytes != t.count * sizeof(float) || offset + nbytes > size) {
+      return fail(path + ": tensor " + t.name + " out of range");
+    }
+    t.data = (const float *)(base + offset);
+    table.push_back(t);
+  }
+  return true;
+}
+
+const FlatTensor *FlatModel::tensor(const std::string &name) const
+{
+  for (const auto &t : table) {
+    if (t.name == name) {
+      return &t;
+    }
+  }
+  return nullptr;
+}
@@ -0,0 +1,65 @@
+/*
+ * 手势识别模型的扁平权重文件（.uhm）加载器（Linux C++17）
+ * 文件格式见根目录 flat_model.py：128 字节文件头 + 张量表 + JSON 元数据 + 64 字节对齐的 float32 数据
+ * 整个文件只读 mmap，张量直接指向映射内存，不拷贝
+ *
+ * 用法:
+ *   FlatModel model;
+ *   if (!model.open("models/cnn_gesture.uhm")) { puts(model.error().c_str()); ... }
+ *   const FlatTensor *w = model.tensor("conv1.weight");   // w->data, w->shape
+ */
+
+#ifndef __FLAT_MODEL_H_
+#define __FLAT_MODEL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct FlatTensor
+{
+  std::string name;
+  std::vector<uint32_t> shape;
+  const float *data;     // 指向映射内存，64 字节对齐
+  size_t count;          // 元素个数
+};
+
+class FlatModel{
+  public:
+    FlatModel() = default;
+    ~FlatModel();
+    FlatModel(const FlatModel &) = delete;
+    FlatModel &operator=(const FlatModel &) = delete;
+
+    //映射文件并校验文件头与张量表，失败时 error() 给出原因
+    bool open(const std::string &path);
+    void close(void);
+    bool is_open(void) const { return base != nullptr; }
+
+    //按名称查找张量，不存在时返回 nullptr
+    const FlatTensor *tensor(const std::string &name) const;
+    const std::vector<FlatTensor> &tensors(void) const { return table; }
+
+    const std::string &architecture(void) const { return arch; }
+    uint32_t input_channels(void) const { return input_c; }
+    uint32_t input_height(void) const { return input_h; }
+    uint32_t input_width(void) const { return input_w; }
+    uint32_t num_classes(void) const { return classes; }
+    //JSON 元数据原文（类别表、来源文件、超参数）
+    const std::string &metadata(void) const { return meta; }
+    const std::string &error(void) const { return err; }
+
+  private:
+    bool fail(const std::string &msg);
+
+    const uint8_t *base = nullptr;
+    size_t size = 0;
+    std::string arch;
+    uint32_t input_c = 0, input_h = 0, input_w = 0, classes = 0;
+    std::string meta;
+    std::vector<FlatTensor> table;
+    std::string err;
+};
+
+#endif
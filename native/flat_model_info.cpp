@@ -0,0 +1,43 @@
+/*
+ * 打印 .uhm 模型文件的文件头与张量表，并统计映射耗时
+ *
+ * 编译:
+ *   g++ -std=c++17 -O2 flat_model_info.cpp flat_model.cpp -o flat_model_info
+ * 运行:
+ *   ./flat_model_info ../models/cnn_gesture.uhm
+ */
+#include "flat_model.h"
+
+#include <chrono>
+#include <cstdio>
+
+int main(int argc, char **argv)
+{
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s model.uhm\n", argv[0]);
+    return 1;
+  }
+  auto t0 = std::chrono::steady_clock::now();
+  FlatModel model;
+  if (!model.open(argv[1])) {
+    fprintf(stderr, "%s\n", model.error().c_str());
+    return 1;
+  }
+  double open_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+  printf("architecture: %s\n", model.architecture().c_str());
+  printf("input:        %u x %u x %u\n", model.input_channels(), model.input_height(), model.input_width());
+  printf("classes:      %u\n", model.num_classes());
+  printf("metadata:     %s\n", model.metadata().c_str());
+  size_t total = 0;
+  for (const auto &t : model.tensors()) {
+    printf("  %-16s [", t.name.c_str());
+    for (size_t d = 0; d < t.shape.size(); d++) {
+      printf(d ? ", %u" : "%u", t.shape[d]);
+    }
+    printf("]  %zu bytes\n", t.count * sizeof(float));
+    total += t.count * sizeof(float);
+  }
+  printf("%zu bytes mapped in %.3f ms\n", total, open_ms);
+  return 0;
+}
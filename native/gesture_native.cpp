@@ -0,0 +1,222 @@
+/*
+ * CNNGestureRecognizer 的 C++ 前向推理
+ * conv(5x5, pad 2) -> relu -> maxpool 2x2 -> conv -> relu -> maxpool -> fc1 -> relu -> fc2
+ */
+#include "gesture_native.h"
+#include "flat_model.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct gesture_native
+{
+  FlatModel model;
+  const FlatTensor *conv_w[2], *conv_b[2];
+  const FlatTensor *fc_w[2], *fc_b[2];
+  int c, h, w;
+  std::vector<float> cols;       // im2col 展开
+  std::vector<float> conv_out;   // 卷积输出（池化前）
+  std::vector<float> pool_out[2];
+  std::vector<float> hidden;
+};
+
+static thread_local std::string last_error;
+
+static bool check_shape(const FlatTensor *t, std::initializer_list<uint32_t> shape)
+{
+  return t && std::vector<uint32_t>(shape) == t->shape;
+}
+
+/* 5x5、pad 2 的卷积展开为矩阵：cols[(c*25 + ky*5 + kx)][y*w + x]，越界处为 0 */
+static void im2col5x5(const float *in, int in_c, int h, int w, float *cols)
+{
+  for (int c = 0; c < in_c; c++) {
+    const float *src = in + (size_t)c * h * w;
+    for (int ky = 0; ky < 5; ky++) {
+      for (int kx = 0; kx < 5; kx++) {
+        float *dst = cols + (size_t)(c * 25 + ky * 5 + kx) * h * w;
+        int x0 = std::max(0, 2 - kx), x1 = std::min(w, w + 2 - kx);
+        for (int y = 0; y < h; y++) {
+          float *d = dst + (size_t)y * w;
+          int sy = y + ky - 2;
+          if (sy < 0 || sy >= h) {
+            std::fill(d, d + w, 0.0f);
+            continue;
+          }
+          std::fill(d, d + x0, 0.0f);
+          memcpy(d + x0, src + (size_t)sy * w + x0 + kx - 2, (x1 - x0) * sizeof(float));
+          std::fill(d + x1, d + w, 0.0f);
+        }
+      }
+    }
+  }
+}
+
+/* out[o] = bias[o] + sum_k weight[o][k] * cols[k]，每次处理 4 个输出通道以复用 cols 的一行，最内层连续可向量化 */
+static void conv5x5(const float *in, int in_c, int h, int w, const FlatTensor *weight, const FlatTensor *bias,
+                    float *cols, float *out)
+{
+  int out_c = weight->shape[0], k_size = in_c * 25;
+  size_t n = (size_t)h * w;
+  im2col5x5(in, in_c, h, w, cols);
+  int o = 0;
+  for (; o + 4 <= out_c; o += 4) {
+    float *d0 = out + o * n, *d1 = d0 + n, *d2 = d1 + n, *d3 = d2 + n;
+    std::fill(d0, d0 + n, bias->data[o]);
+    std::fill(d1, d1 + n, bias->data[o + 1]);
+    std::fill(d2, d2 + n, bias->data[o + 2]);
+    std::fill(d3, d3 + n, bias->data[o + 3]);
+    const float *w0 = weight->data + (size_t)o * k_size;
+    for (int k = 0; k < k_size; k++) {
+      const float *s = cols + k * n;
+      float a0 = w0[k], a1 = w0[k_size + k], a2 = w0[2 * k_size + k], a3 = w0[3 * k_size + k];
+      for (size_t x = 0; x < n; x++) {
+        float v = s[x];
+        d0[x] += a0 * v;
+        d1[x] += a1 * v;
+        d2[x] += a2 * v;
+        d3[x] += a3 * v;
+      }
+    }
+  }
+  for (; o < out_c; o++) {
+    float *d = out + o * n;
+    std::fill(d, d + n, bias->data[o]);
+    const float *wo = weight->data + (size_t)o * k_size;
+    for (int k = 0; k < k_size; k++) {
+      const float *s = cols + k * n;
+      for (size_t x = 0; x < n; x++) {
+        d[x] += wo[k] * s[x];
+      }
+    }
+  }
+}
+
+/* relu 与 2x2 最大池化合并：max(relu(a..d)) == relu(max(a..d)) */
+static void relu_pool(const float *in, int ch, int h, int w, float *out)
+{
+  int oh = h / 2, ow = w / 2;
+  for (int c = 0; c < ch; c++) {
+    const float *src = in + (size_t)c * h * w;
+    float *dst = out + (size_t)c * oh * ow;
+    for (int y = 0; y < oh; y++) {
+      const float *r0 = src + (size_t)(2 * y) * w;
+      const float *r1 = r0 + w;
+      for (int x = 0; x < ow; x++) {
+        float m = std::max(std::max(r0[2 * x], r0[2 * x + 1]), std::max(r1[2 * x], r1[2 * x + 1]));
+        dst[y * ow + x] = m > 0.0f ? m : 0.0f;
+      }
+    }
+  }
+}
+
+/* 全连接，8 路部分和让编译器不开 -ffast-math 也能向量化 */
+static void linear(const float *in, const FlatTensor *weight, const FlatTensor *bias, bool relu, float *out)
+{
+  int rows = weight->shape[0], cols = weight->shape[1];
+  for (int r = 0; r < rows; r++) {
+    const float *wr = weight->data + (size_t)r * cols;
+    float acc[8] = { 0 };
+    int i = 0;
+    for (; i + 8 <= cols; i += 8) {
+      for (int j = 0; j < 8; j++) {
+        acc[j] += wr[i + j] * in[i + j];
+      }
+    }
+    float sum = bias->data[r];
+    for (; i < cols; i++) {
+      sum += wr[i] * in[i];
+    }
+    for (int j = 0; j < 8; j++) {
+      sum += acc[j];
+    }
+    out[r] = relu && sum < 0.0f ? 0.0f : sum;
+  }
+}
+
+gesture_native_t *gesture_native_open(const char *path)
+{
+  gesture_native_t *net = new gesture_native_t();
+  if (!net->model.open(path)) {
+    last_error = net->model.error();
+    delete net;
+    return nullptr;
+  }
+  FlatModel &m = net->model;
+  net->c = m.input_channels();
+  net->h = m.input_height();
+  net->w = m.input_width();
+  const char *conv_names[2][2] = { { "conv1.weight", "conv1.bias" }, { "conv2.weight", "conv2.bias" } };
+  const char *fc_names[2][2] = { { "fc1.weight", "fc1.bias" }, { "fc2.weight", "fc2.bias" } };
+  for (int i = 0; i < 2; i++) {
+    net->conv_w[i] = m.tensor(conv_names[i][0]);
+    net->conv_b[i] = m.tensor(conv_names[i][1]);
+    net->fc_w[i] = m.tensor(fc_names[i][0]);
+    net->fc_b[i] = m.tensor(fc_names[i][1]);
+  }
+  /* 校验形状与 CNNGestureRecognizer 一致 */
+  bool ok = m.architecture() == "CNNGestureRecognizer" && net->h % 4 == 0 && net->w % 4 == 0 &&
+            net->conv_w[0] && net->conv_w[1] && net->fc_w[0] && net->fc_w[1];
+  if (ok) {
+    uint32_t c1 = net->conv_w[0]->shape[0], c2 = net->conv_w[1]->shape[0];
+    uint32_t hidden = net->fc_w[0]->shape[0], classes = net->fc_w[1]->shape[0];
+    ok = check_shape(net->conv_w[0], { c1, (uint32_t)net->c, 5, 5 }) && check_shape(net->conv_b[0], { c1 }) &&
+         check_shape(net->conv_w[1], { c2, c1, 5, 5 }) && check_shape(net->conv_b[1], { c2 }) &&
+         check_shape(net->fc_w[0], { hidden, c2 * (net->h / 4) * (net->w / 4) }) && check_shape(net->fc_b[0], { hidden }) &&
+         check_shape(net->fc_w[1], { classes, hidden }) && check_shape(net->fc_b[1], { classes });
+  }
+  if (!ok) {
+    last_error = std::string(path) + ": tensors do not match CNNGestureRecognizer";
+    delete net;
+    return nullptr;
+  }
+  size_t c1 = net->conv_w[0]->shape[0], c2 = net->conv_w[1]->shape[0];
+  net->cols.resize(std::max((size_t)net->c * 25 * net->h * net->w, c1 * 25 * (net->h / 2) * (net->w / 2)));
+  net->conv_out.resize(std::max(c1 * net->h * net->w, c2 * (net->h / 2) * (net->w / 2)));
+  net->pool_out[0].resize(c1 * (net->h / 2) * (net->w / 2));
+  net->pool_out[1].resize(c2 * (net->h / 4) * (net->w / 4));
+  net->hidden.resize(net->fc_w[0]->shape[0]);
+  return net;
+}
+
+void gesture_native_close(gesture_native_t *net)
+{
+  delete net;
+}
+
+const char *gesture_native_last_error(void)
+{
+  return last_error.c_str();
+}
+
+int gesture_native_num_classes(const gesture_native_t *net)
+{
+  return net->fc_w[1]->shape[0];
+}
+
+void gesture_native_input_size(const gesture_native_t *net, int *c, int *h, int *w)
+{
+  *c = net->c;
+  *h = net->h;
+  *w = net->w;
+}
+
+/* 中间缓冲属于 net，同一个 net 不能被多个线程同时调用 */
+int gesture_native_forward(gesture_native_t *net, const float *input, int n, float *logits)
+{
+  int h = net->h, w = net->w;
+  int c1 = net->conv_w[0]->shape[0], c2 = net->conv_w[1]->shape[0];
+  int classes = gesture_native_num_classes(net);
+  for (int i = 0; i < n; i++) {
+    const float *x = input + (size_t)i * net->c * h * w;
+    conv5x5(x, net->c, h, w, net->conv_w[0], net->conv_b[0], net->cols.data(), net->conv_out.data());
+    relu_pool(net->conv_out.data(), c1, h, w, net->pool_out[0].data());
+    conv5x5(net->pool_out[0].data(), c1, h / 2, w / 2, net->conv_w[1], net->conv_b[1], net->cols.data(), net->conv_out.data());
+    relu_pool(net->conv_out.data(), c2, h / 2, w / 2, net->pool_out[1].data());
+    linear(net->pool_out[1].data(), net->fc_w[0], net->fc_b[0], true, net->hidden.data());
+    linear(net->hidden.data(), net->fc_w[1], net->fc_b[1], false, logits + (size_t)i * classes);
+  }
+  return 0;
+}
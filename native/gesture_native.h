@@ -0,0 +1,39 @@
+/*
+ * CNNGestureRecognizer 的 C++ 前向推理，权重直接使用 .uhm 文件的映射内存
+ * 导出 C 接口，Python 端（inference.py 的 backend='native'）通过 ctypes 调用
+ *
+ * 编译:
+ *   g++ -std=c++17 -O3 -march=native -fPIC -shared gesture_native.cpp flat_model.cpp -o libgesture_native.so
+ */
+
+#ifndef __GESTURE_NATIVE_H_
+#define __GESTURE_NATIVE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct gesture_native gesture_native_t;
+
+//映射模型文件，失败返回 NULL，原因由 gesture_native_last_error() 给出
+gesture_native_t *gesture_native_open(const char *path);
+void gesture_native_close(gesture_native_t *net);
+const char *gesture_native_last_error(void);
+
+int gesture_native_num_classes(const gesture_native_t *net);
+//输入尺寸 C x H x W
+void gesture_native_input_size(const gesture_native_t *net, int *c, int *h, int *w);
+
+/*
+ * 前向推理
+ * input : n x C x H x W，float32，与 GesturePredictor.preprocess_image 的输出相同
+ * logits: n x num_classes
+ * 返回 0 成功
+ */
+int gesture_native_forward(gesture_native_t *net, const float *input, int n, float *logits);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+GesturePredictor 各推理后端的一致性与延时对比
+所有后端使用同一份预处理结果，以 torch 后端为基准比较输出概率和 top-1，并统计加载时间、单张延时和批量吞吐
+
+使用方法（在仓库根目录运行，train.py 保存模型时已在旁边导出 .torchscript.pt / .onnx / .uhm）:
+    python scripts/backends/compare_backends.py --model models/cnn_gesture.pth --images datasets/resized_img_split/resized_img5
+    python scripts/backends/compare_backends.py --model models/cnn_gesture.pth --backends torch,onnxruntime,native --threads 1
+"""
+
+import argparse
+import os
+import sys
+import time
+
+import numpy as np
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', '..'))
+sys.path.insert(0, ROOT)
+
+import torch  # noqa: E402
+
+from inference import BACKENDS, GesturePredictor  # noqa: E402
+
+
+def load_images(image_dir, count, seed=0):
+    """读取目录中的图片；不指定目录时生成随机图像。"""
+    if image_dir:
+        names = sorted(n for n in os.listdir(image_dir)
+                       if n.lower().endswith(('.jpg', '.jpeg', '.png', '.bmp')))[:count]
+        return [os.path.join(image_dir, n) for n in names]
+    rng = np.random.default_rng(seed)
+    return [rng.integers(0, 256, (64, 64, 3), dtype=np.uint8) for _ in range(count)]
+
+
+def measure(predictor, tensors, repeat, batch):
+    """返回 (单张 p50 ms, 单张 p99 ms, 批量吞吐 张/秒)。"""
+    predictor.predict_proba(tensors[:1])  # 预热
+    times = []
+    for i in range(repeat):
+        t0 = time.perf_counter()
+        predictor.predict_proba([tensors[i % len(tensors)]])
+        times.append((time.perf_counter() - t0) * 1000.0)
+    chunks = [tensors[i:i + batch] for i in range(0, len(tensors), batch)]
+    t0 = time.perf_counter()
+    done = 0
+    for chunk in chunks:
+        predictor.predict_proba(chunk)
+        done += len(chunk)
+    throughput = done / (time.perf_counter() - t0)
+    return np.percentile(times, 50), np.percentile(times, 99), throughput
+
+
+def main():
+    parser = argparse.ArgumentParser(description='推理后端一致性与延时对比')
+    parser.add_argument('--model', '-m', required=True, help='checkpoint（.pth）或 .uhm，其他后端按扩展名找旁边的导出文件')
+    parser.add_argument('--images', help='测试图片目录，不指定时使用随机图像')
+    parser.add_argument('--count', type=int, default=64, help='测试图片数')
+    parser.add_argument('--repeat', type=int, default=200, help='单张延时的测量次数')
+    parser.add_argument('--batch', type=int, default=16, help='吞吐测试的批大小')
+    parser.add_argument('--backends', help='参与对比的后端，指定的后端加载失败时返回非 0；不指定时对比全部后端，加载失败的跳过')
+    parser.add_argument('--threads', type=int, default=0, help='torch 线程数，0 为默认')
+    parser.add_argument('--atol', type=float, default=1e-4, help='概率最大误差的容限')
+    args = parser.parse_args()
+
+    if args.threads > 0:
+        torch.set_num_threads(args.threads)
+        os.environ.setdefault('OMP_NUM_THREADS', str(args.threads))
+
+    reference = GesturePredictor(args.model, 'cpu', 'torch')
+    tensors = [reference.preprocess_image(image) for image in load_images(args.images, args.count)]
+    ref_probs = reference.predict_proba(tensors)
+    ref_top1 = ref_probs.argmax(axis=1)
+
+    print(f"{len(tensors)} images, reference: torch ({args.model})")
+    print(f"{'backend':<12} {'load ms':>8} {'max |dp|':>10} {'top-1':>7} {'p50 ms':>8} {'p99 ms':>8} {'img/s':>8}  parity")
+    failed = False
+    for backend in (args.backends or ','.join(BACKENDS)).split(','):
+        try:
+            t0 = time.perf_counter()
+            predictor = GesturePredictor(args.model, 'cpu', backend)
+            load_ms = (time.perf_counter() - t0) * 1000.0
+        except Exception as e:
+            # 命令行点名的后端没有比较就不能算通过
+            failed |= args.backends is not None
+            print(f"{backend:<12} {'FAILED' if args.backends else 'skipped'}: {e}")
+            continue
+        probs = predictor.predict_proba(tensors)
+        max_diff = float(np.abs(probs - ref_probs).max())
+        agree = float((probs.argmax(axis=1) == ref_top1).mean()) * 100.0
+        p50, p99, throughput = measure(predictor, tensors, args.repeat, args.batch)
+        ok = max_diff <= args.atol and agree == 100.0
+        failed |= not ok
+        print(f"{backend:<12} {load_ms:>8.1f} {max_diff:>10.2e} {agree:>6.1f}% {p50:>8.2f} {p99:>8.2f} {throughput:>8.1f}  "
+              f"{'ok' if ok else 'MISMATCH'}")
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
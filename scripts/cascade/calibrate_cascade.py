@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+级联推理（小模型 + 完整模型）的阈值标定
+小模型对每帧先做一次推理，top-1 概率低于阈值的帧再交给完整的 CNNGestureRecognizer
+在 train.py 划分出的测试集上扫描阈值：一半用于选阈值（标定集），另一半只用来复核（复核集），
+报告升级率、相对完整模型的准确率变化和平均单帧延时，写出 inference.py --cascade 使用的 JSON
+
+使用方法（在仓库根目录运行，先训练两个模型）:
+    python train.py --arch cnn
+    python train.py --arch tiny
+    python scripts/cascade/calibrate_cascade.py --tiny models/tiny_gesture.pth --full models/cnn_gesture.pth
+    python inference.py --cascade models/cascade.json --mode camera
+"""
+
+import argparse
+import json
+import os
+import sys
+import time
+
+import numpy as np
+from sklearn.model_selection import train_test_split
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', '..'))
+sys.path.insert(0, ROOT)
+
+import torch  # noqa: E402
+
+from inference import BACKENDS, GesturePredictor  # noqa: E402
+from train import load_dataset_from_folders  # noqa: E402
+
+
+def single_image_ms(predictor, tensors, repeat):
+    """单帧推理延时的中位数（ms），级联在摄像头循环里总是一帧一帧地跑。"""
+    predictor.predict_proba(tensors[:1])  # 预热
+    times = []
+    for i in range(repeat):
+        t0 = time.perf_counter()
+        predictor.predict_proba([tensors[i % len(tensors)]])
+        times.append((time.perf_counter() - t0) * 1000.0)
+    return float(np.median(times))
+
+
+def evaluate(threshold, tiny_probs, full_probs, labels, t_tiny, t_full):
+    """给定阈值下的升级率、级联准确率（%）和平均单帧延时（ms）。"""
+    escalate = tiny_probs.max(axis=1) < threshold
+    pred = np.where(escalate, full_probs.argmax(axis=1), tiny_probs.argmax(axis=1))
+    rate = float(escalate.mean())
+    return rate, float((pred == labels).mean()) * 100.0, t_tiny + rate * t_full
+
+
+def main():
+    parser = argparse.ArgumentParser(description='级联推理阈值标定')
+    parser.add_argument('--tiny', default='models/tiny_gesture.pth', help='小模型（train.py --arch tiny）')
+    parser.add_argument('--full', default='models/cnn_gesture.pth', help='完整模型')
+    parser.add_argument('--data-dir', default=os.path.join('datasets', 'resized_img_split'), help='数据集目录')
+    parser.add_argument('--max-drop', type=float, default=0.5, help='允许的准确率下降（百分点），在此范围内取升级率最低的阈值')
+    parser.add_argument('--backend', choices=list(BACKENDS), default='torch', help='完整模型的推理后端')
+    parser.add_argument('--repeat', type=int, default=200, help='单帧延时的测量次数')
+    parser.add_argument('--threads', type=int, default=0, help='torch 线程数，0 为默认')
+    parser.add_argument('--output', '-o', default='models/cascade.json', help='标定结果')
+    args = parser.parse_args()
+
+    if args.threads > 0:
+        torch.set_num_threads(args.threads)
+
+    # train.py 只划分了训练/测试两部分，训练集小模型已经见过，只用测试集
+    _, paths, _, labels = load_dataset_from_folders(args.data_dir)
+    try:
+        calib_paths, check_paths, calib_labels, check_labels = train_test_split(
+            paths, labels, test_size=0.5, random_state=0, stratify=labels)
+    except ValueError:
+        print('测试集太小无法再分层划分，标定集与复核集相同')
+        calib_paths, check_paths, calib_labels, check_labels = paths, paths, labels, labels
+
+    full = GesturePredictor(args.full, 'cpu', args.backend)
+    tiny = GesturePredictor(args.tiny, 'cpu', 'torch')
+    calib = [full.preprocess_image(p) for p in calib_paths]
+    check = [full.preprocess_image(p) for p in check_paths]
+    calib_labels, check_labels = np.array(calib_labels), np.array(check_labels)
+    probs = {name: (model.predict_proba(calib), model.predict_proba(check))
+             for name, model in (('tiny', tiny), ('full', full))}
+
+    t_tiny = single_image_ms(tiny, calib, args.repeat)
+    t_full = single_image_ms(full, calib, args.repeat)
+    full_acc = float((probs['full'][0].argmax(axis=1) == calib_labels).mean()) * 100.0
+    tiny_acc = float((probs['tiny'][0].argmax(axis=1) == calib_labels).mean()) * 100.0
+    print(f"标定集 {len(calib)} 张，复核集 {len(check)} 张")
+    print(f"完整模型 {full_acc:.2f}%，{t_full:.2f} ms/帧；小模型 {tiny_acc:.2f}%，{t_tiny:.2f} ms/帧")
+
+    # 阈值 > 1 等价于全部升级（只比完整模型多一次小模型推理）
+    thresholds = np.round(np.arange(0.0, 1.0001, 0.01), 2).tolist() + [1.01]
+    rows = [(t, *evaluate(t, probs['tiny'][0], probs['full'][0], calib_labels, t_tiny, t_full)) for t in thresholds]
+    ok = [r for r in rows if r[2] >= full_acc - args.max_drop]
+    best = min(ok, key=lambda r: (r[1], -r[2]))
+
+    print(f"\n{'threshold':>9} {'escalate':>9} {'accuracy':>9} {'delta':>8} {'ms/frame':>9} {'saved':>7}")
+    for t, rate, acc, ms in rows:
+        if round(t * 100) % 10 == 0 or t == best[0]:
+            mark = '  <-' if t == best[0] else ''
+            print(f"{t:>9.2f} {rate:>8.1%} {acc:>8.2f}% {acc - full_acc:>+7.2f} {ms:>9.2f} {1 - ms / t_full:>6.1%}{mark}")
+
+    threshold = best[0]
+    check_full_acc = float((probs['full'][1].argmax(axis=1) == check_labels).mean()) * 100.0
+    check_rate, check_acc, check_ms = evaluate(threshold, probs['tiny'][1], probs['full'][1], check_labels, t_tiny, t_full)
+    print(f"\n阈值 {threshold:.2f}：标定集升级率 {best[1]:.1%}，准确率变化 {best[2] - full_acc:+.2f}，"
+          f"平均 {best[3]:.2f} ms/帧（节省 {1 - best[3] / t_full:.1%}）")
+    print(f"复核集：升级率 {check_rate:.1%}，准确率 {check_acc:.2f}%（完整模型 {check_full_acc:.2f}%，"
+          f"{check_acc - check_full_acc:+.2f}），平均 {check_ms:.2f} ms/帧")
+
+    result = {
+        'tiny_model': args.tiny,
+        'full_model': args.full,
+        'threshold': threshold,
+        'escalation_rate': best[1],
+        'accuracy': best[2],
+        'full_accuracy': full_acc,
+        'accuracy_delta': best[2] - full_acc,
+        'latency_ms': {'tiny': t_tiny, 'full': t_full, 'cascade': best[3]},
+        'check': {'escalation_rate': check_rate, 'accuracy': check_acc, 'full_accuracy': check_full_acc},
+        'samples': {'calibration': len(calib), 'check': len(check)},
+    }
+    os.makedirs(os.path.dirname(args.output) or '.', exist_ok=True)
+    with open(args.output, 'w', encoding='utf-8') as f:
+        json.dump(result, f, ensure_ascii=False, indent=2)
+    print(f"已写入 {args.output}")
+
+
+if __name__ == '__main__':
+    main()
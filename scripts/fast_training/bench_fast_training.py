@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+快速训练模式与原训练循环的对比：每轮耗时和最终测试准确率
+同一份数据划分、同一个随机种子，依次用以下配置各训练 --epochs 轮:
+    baseline   原循环（DataLoader 每步解码图片、fp32、eager、逐 batch 更新 tqdm）
+    memory     只换成 InMemoryLoader
+    fast       GestureTrainer(fast=True)：channels_last、bf16 autocast（硬件支持时）、torch.compile、fused Adam
+第一轮包含 torch.compile 的编译时间，单独列出，每轮耗时取其余轮的中位数
+
+使用方法（在仓库根目录运行）:
+    python scripts/fast_training/bench_fast_training.py --data-dir datasets/resized_img_split --epochs 10
+    python scripts/fast_training/bench_fast_training.py --modes baseline,fast --batch-size 64 --threads 8
+"""
+
+import argparse
+import os
+import sys
+import time
+
+import numpy as np
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', '..'))
+sys.path.insert(0, ROOT)
+
+import torch  # noqa: E402
+from torch.utils.data import DataLoader  # noqa: E402
+
+import train  # noqa: E402
+from train import GestureDataset, GestureTrainer, InMemoryLoader, build_model, load_dataset_from_folders  # noqa: E402
+
+MODES = ('baseline', 'memory', 'fast')
+
+
+class EpochTimer(GestureTrainer):
+    """记录每轮（训练 + 评估）耗时的 GestureTrainer。"""
+
+    def __init__(self, *args, **kwargs):
+        super().__init__(*args, **kwargs)
+        self.epoch_times = []
+        self._t0 = None
+
+    def _tick(self):
+        now = time.perf_counter()
+        if self._t0 is not None:
+            self.epoch_times.append(now - self._t0)
+        self._t0 = now
+
+    def train_epoch(self, *args, **kwargs):
+        self._tick()
+        return super().train_epoch(*args, **kwargs)
+
+    def train_epoch_fast(self, *args, **kwargs):
+        self._tick()
+        return super().train_epoch_fast(*args, **kwargs)
+
+
+def run(mode, arch, datasets, batch_size, epochs, seed, compile_model):
+    """训练一种配置，返回 (数据准备秒数, 每轮秒数列表, 最终准确率)。"""
+    torch.manual_seed(seed)
+    np.random.seed(seed)
+    train_dataset, test_dataset = datasets
+    t0 = time.perf_counter()
+    if mode == 'baseline':
+        train_loader = DataLoader(train_dataset, batch_size=batch_size, shuffle=True, num_workers=0)
+        test_loader = DataLoader(test_dataset, batch_size=batch_size, shuffle=False, num_workers=0)
+    else:
+        train_loader = InMemoryLoader(train_dataset, batch_size, shuffle=True, drop_last=mode == 'fast',
+                                      channels_last=mode == 'fast')
+        test_loader = InMemoryLoader(test_dataset, batch_size, channels_last=mode == 'fast')
+    prepare = time.perf_counter() - t0
+
+    model = build_model(arch, num_classes=11, dropout_rate=0.5 if arch == 'cnn' else 0.2)
+    trainer = EpochTimer(model, 'cpu', fast=mode == 'fast', compile_model=compile_model)
+    history = trainer.train(train_loader, test_loader, num_epochs=epochs)
+    trainer._tick()  # 最后一轮的结束时间
+    return prepare, trainer.epoch_times, history['test_accuracy'][-1]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='快速训练模式耗时与准确率对比')
+    parser.add_argument('--data-dir', default=os.path.join('datasets', 'resized_img_split'), help='数据集目录')
+    parser.add_argument('--arch', choices=list(train.MODEL_ARCHITECTURES), default='cnn', help='模型结构')
+    parser.add_argument('--modes', default=','.join(MODES), help='参与对比的配置')
+    parser.add_argument('--epochs', type=int, default=10, help='每种配置训练的轮数')
+    parser.add_argument('--batch-size', type=int, default=16, help='批大小（与 train.py 默认一致）')
+    parser.add_argument('--threads', type=int, default=0, help='torch 线程数，0 为默认')
+    parser.add_argument('--no-compile', action='store_true', help='fast 配置不使用 torch.compile')
+    parser.add_argument('--seed', type=int, default=0, help='随机种子')
+    args = parser.parse_args()
+
+    if args.threads > 0:
+        torch.set_num_threads(args.threads)
+
+    train_paths, test_paths, train_labels, test_labels = load_dataset_from_folders(args.data_dir)
+    datasets = (GestureDataset(train_paths, train_labels), GestureDataset(test_paths, test_labels))
+    print(f"{len(train_paths)} 张训练，{len(test_paths)} 张测试，{torch.get_num_threads()} 线程，"
+          f"原生 bf16: {'有' if train.cpu_supports_bf16() else '无'}")
+
+    results = []
+    for mode in args.modes.split(','):
+        prepare, times, accuracy = run(mode, args.arch, datasets, args.batch_size, args.epochs, args.seed,
+                                       not args.no_compile)
+        steady = float(np.median(times[1:])) if len(times) > 1 else times[0]
+        results.append((mode, prepare, times[0], steady, accuracy))
+
+    base = results[0][3]
+    print(f"\n{'mode':<10} {'prepare s':>10} {'epoch 1 s':>10} {'epoch s':>9} {'speedup':>8} {'accuracy':>9}")
+    for mode, prepare, first, steady, accuracy in results:
+        print(f"{mode:<10} {prepare:>10.2f} {first:>10.2f} {steady:>9.2f} {base / steady:>7.2f}x {accuracy:>8.2f}%")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,238 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+体感手套数字识别：样本记录与质心表训练
+生成的 glove_model.h 配合 examples/uhand/glove_classifier.h 在板子上做整数最近质心分类
+
+样本文件为 CSV，每行: 数字,a0,a1,a2,a3,a4,a5（a0~a5 为 knob_update 滤波后的 0~1023 读数）
+
+使用方法:
+    # 1. 记录样本：戴上手套保持某个数字的手势，串口 "L20$" 让板子每 20ms 输出一行 "#L a0 ... a5"
+    python train_glove.py record --port /dev/ttyUSB0 --digit 3 --seconds 10 -o samples.csv
+    # 2. 训练并生成 Flash 质心表
+    python train_glove.py train samples.csv -o ../../examples/uhand/glove_model.h
+    # 生成空模型（未训练时固件也能编译，识别结果始终为未知）
+    python train_glove.py init -o ../../examples/uhand/glove_model.h
+"""
+
+import argparse
+import csv
+import os
+import sys
+import time
+
+import numpy as np
+
+CHANNELS = 6
+UNKNOWN = 0xFF
+
+
+def load_samples(paths):
+    """读取样本 CSV，返回 (特征 N x 6, 标签 N)。"""
+    rows = []
+    for path in paths:
+        with open(path, newline='') as f:
+            for row in csv.reader(f):
+                if len(row) != CHANNELS + 1 or not row[0].strip().isdigit():
+                    continue
+                rows.append([int(v) for v in row])
+    if not rows:
+        raise ValueError("no samples found")
+    data = np.array(rows, dtype=np.int64)
+    return data[:, 1:], data[:, 0]
+
+
+def fit_scaling(x):
+    """每通道零点和 Q8 缩放，使 1%~99% 的读数映射到 0~255。"""
+    lo = np.percentile(x, 1, axis=0).astype(np.int64)
+    hi = np.percentile(x, 99, axis=0).astype(np.int64)
+    span = np.maximum(hi - lo, 1)
+    scale = np.minimum(255 * 256 // span, 0xFFFF)
+    return lo, scale
+
+
+def to_feature(x, offset, scale):
+    """与 HW_GloveClassifier::classify 相同的整数归一化。"""
+    v = np.maximum(x - offset, 0)
+    return np.minimum((v * scale) >> 8, 255)
+
+
+def kmeans(x, k, rng, iters=50):
+    """简单的 Lloyd k-means，返回 k x 6 质心。"""
+    k = min(k, len(x))
+    centers = x[rng.choice(len(x), k, replace=False)].astype(np.float64)
+    for _ in range(iters):
+        d = np.abs(x[:, None, :] - centers[None, :, :]).sum(axis=2)
+        assign = d.argmin(axis=1)
+        new = np.array([x[assign == i].mean(axis=0) if np.any(assign == i) else centers[i]
+                        for i in range(k)])
+        if np.allclose(new, centers):
+            break
+        centers = new
+    return np.clip(np.rint(centers), 0, 255).astype(np.int64)
+
+
+def nearest(features, centroids, labels):
+    """整数 L1 最近质心，返回 (标签, 距离)。"""
+    d = np.abs(features[:, None, :] - centroids[None, :, :]).sum(axis=2)
+    idx = d.argmin(axis=1)
+    return labels[idx], d[np.arange(len(features)), idx]
+
+
+def fit(x, y, per_class, margin, seed):
+    """训练：归一化参数、每个数字 per_class 个质心、拒识阈值。"""
+    rng = np.random.default_rng(seed)
+    offset, scale = fit_scaling(x)
+    f = to_feature(x, offset, scale)
+    centroids, labels = [], []
+    for digit in sorted(set(y.tolist())):
+        c = kmeans(f[y == digit], per_class, rng)
+        centroids.append(c)
+        labels += [digit] * len(c)
+    centroids = np.vstack(centroids)
+    labels = np.array(labels)
+    _, dist = nearest(f, centroids, labels)
+    reject = int(min(np.percentile(dist, 99.5) * margin + 1, 0xFFFF))
+    return {'offset': offset, 'scale': scale, 'centroids': centroids, 'labels': labels, 'reject': reject}
+
+
+def predict(model, x):
+    f = to_feature(x, model['offset'], model['scale'])
+    pred, dist = nearest(f, model['centroids'], model['labels'])
+    pred = np.where(dist > model['reject'], UNKNOWN, pred)
+    return pred
+
+
+def evaluate(x, y, args):
+    """每个数字留出 20% 样本评估，返回准确率和拒识率。"""
+    rng = np.random.default_rng(args.seed)
+    test = np.zeros(len(y), dtype=bool)
+    for digit in set(y.tolist()):
+        idx = np.flatnonzero(y == digit)
+        rng.shuffle(idx)
+        test[idx[:max(1, len(idx) // 5)]] = True
+    model = fit(x[~test], y[~test], args.per_class, args.margin, args.seed)
+    pred = predict(model, x[test])
+    return float(np.mean(pred == y[test])), float(np.mean(pred == UNKNOWN))
+
+
+def render(model, comment):
+    """生成 glove_model.h 内容。"""
+    num = len(model['labels'])
+    rows = [f"  {{ {label}, {', '.join(str(v) for v in c)} }},"
+            for label, c in zip(model['labels'], model['centroids'])]
+    if not rows:
+        rows = ['  { 255, 0, 0, 0, 0, 0, 0 },  // 占位，num 为 0 时不会使用']
+    out = [
+        '/*',
+        ' * 由 scripts/glove/train_glove.py 生成，请勿手动修改',
+        *[f' * {line}' for line in comment],
+        ' */',
+        '',
+        '#ifndef __GLOVE_MODEL_H_',
+        '#define __GLOVE_MODEL_H_',
+        '',
+        '#include "glove_classifier.h"',
+        '',
+        f"static const uint16_t glove_offset[GLOVE_CHANNELS] PROGMEM = {{ {', '.join(str(v) for v in model['offset'])} }};",
+        f"static const uint16_t glove_scale[GLOVE_CHANNELS] PROGMEM = {{ {', '.join(str(v) for v in model['scale'])} }};",
+        'static const uint8_t glove_centroids[][GLOVE_CHANNELS + 1] PROGMEM = {',
+        *rows,
+        '};',
+        '',
+        f"static const glove_model_t GLOVE_MODEL = {{ {num}, {model['reject']}, glove_offset, glove_scale, &glove_centroids[0][0] }};",
+        '',
+        '#endif //__GLOVE_MODEL_H_',
+        '',
+    ]
+    return '\r\n'.join(out)
+
+
+def write_header(path, text):
+    with open(path, 'w', encoding='utf-8', newline='') as f:
+        f.write(text)
+    print(f"model written to {path}")
+
+
+def cmd_train(args):
+    x, y = load_samples(args.samples)
+    counts = {int(d): int(np.sum(y == d)) for d in sorted(set(y.tolist()))}
+    print(f"{len(y)} samples: {counts}")
+    acc, rej = evaluate(x, y, args)
+    print(f"holdout accuracy {acc * 100:.1f}%  rejected {rej * 100:.1f}%")
+    model = fit(x, y, args.per_class, args.margin, args.seed)
+    print(f"{len(model['labels'])} centroids, {len(model['labels']) * (CHANNELS + 1) + 4 * CHANNELS} bytes of flash, "
+          f"reject distance {model['reject']}")
+    comment = [f"样本 {len(y)} 个，数字 {sorted(counts)}，每个数字 {args.per_class} 个质心",
+               f"留出集准确率 {acc * 100:.1f}%，拒识 {rej * 100:.1f}%"]
+    write_header(args.output, render(model, comment))
+
+
+def cmd_init(args):
+    model = {'offset': [0] * CHANNELS, 'scale': [64] * CHANNELS,
+             'centroids': [], 'labels': [], 'reject': 0}
+    write_header(args.output, render(model, ['空模型，识别结果始终为未知，请先记录样本并训练']))
+
+
+def cmd_record(args):
+    sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'uhand_link'))
+    from negotiate import SerialPort, negotiate
+
+    port = SerialPort(args.port)
+    baud, _ = negotiate(port, args.max_baud, wait=10.0)
+    print(f"recording digit {args.digit} for {args.seconds}s at {baud} baud, hold the gesture ...")
+    port.flush_input()
+    port.send(f'L{args.period}')
+    count = 0
+    deadline = time.monotonic() + args.seconds
+    with open(args.output, 'a', newline='') as f:
+        writer = csv.writer(f)
+        while time.monotonic() < deadline:
+            line = port.wait_for('#L', timeout=1.0)
+            if line is None:
+                continue
+            values = line.split()[1:]
+            if len(values) != CHANNELS:
+                continue
+            writer.writerow([args.digit] + [int(v) for v in values])
+            count += 1
+    port.send('L0')
+    port.close()
+    print(f"{count} samples appended to {args.output}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Glove digit classifier: record samples and build flash tables')
+    sub = parser.add_subparsers(dest='command', required=True)
+
+    p = sub.add_parser('record', help='record samples of one digit from the board')
+    p.add_argument('--port', required=True)
+    p.add_argument('--digit', type=int, required=True, choices=range(11))
+    p.add_argument('--seconds', type=float, default=10.0)
+    p.add_argument('--period', type=int, default=20, help='sample period on the board in ms')
+    p.add_argument('--max-baud', type=int, default=115200)
+    p.add_argument('-o', '--output', default='samples.csv')
+    p.set_defaults(func=cmd_record)
+
+    p = sub.add_parser('train', help='train centroids and write glove_model.h')
+    p.add_argument('samples', nargs='+', help='sample CSV files')
+    p.add_argument('--per-class', type=int, default=2, help='centroids per digit')
+    p.add_argument('--margin', type=float, default=1.25, help='reject distance margin')
+    p.add_argument('--seed', type=int, default=0)
+    p.add_argument('-o', '--output', default='glove_model.h')
+    p.set_defaults(func=cmd_train)
+
+    p = sub.add_parser('init', help='write an empty model')
+    p.add_argument('-o', '--output', default='glove_model.h')
+    p.set_defaults(func=cmd_init)
+
+    args = parser.parse_args()
+    try:
+        args.func(args)
+    except (ValueError, RuntimeError, OSError) as e:
+        print(e, file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+推理服务压测：多个客户端进程同时请求 inference_server.py，统计吞吐量和 p50/p99 延时
+每个客户端是闭环的：收到上一条结果后等待 think 时间再发下一条，模拟一桌游戏的摄像头循环
+
+使用方法（在仓库根目录运行）:
+    # 对比不合批和动态合批，每种配置自动启动一个服务进程
+    python scripts/inference_server/bench_inference_server.py --random-weights --max-batch 1,16 --clients 1,2,4,8,16
+    # 压测已经在运行的服务
+    python scripts/inference_server/bench_inference_server.py --socket /tmp/uhand_gesture.sock --clients 1,4,16
+"""
+
+import argparse
+import multiprocessing as mp
+import os
+import subprocess
+import sys
+import time
+
+import numpy as np
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', '..'))
+sys.path.insert(0, ROOT)
+
+from inference_server import InferenceClient  # noqa: E402
+
+
+def client_proc(socket_path, size, seconds, think_ms, start_at, out_queue, seed):
+    """单个客户端：在 start_at 之后的 seconds 秒内不断请求，返回每条请求的延时和所在批大小。"""
+    rng = np.random.default_rng(seed)
+    image = rng.integers(0, 256, (size, size, 3), dtype=np.uint8)
+    latencies, batches = [], []
+    with InferenceClient(socket_path) as client:
+        client.get_top_k_predictions(image, 3)  # 建立连接后先预热一次
+        while time.time() < start_at:
+            time.sleep(0.001)
+        end = start_at + seconds
+        while time.time() < end:
+            t0 = time.perf_counter()
+            client.get_top_k_predictions(image, 3)
+            latencies.append((time.perf_counter() - t0) * 1000.0)
+            batches.append(client.last_batch)
+            if think_ms > 0:
+                time.sleep(think_ms / 1000.0)
+    out_queue.put((latencies, batches))
+
+
+def run_level(socket_path, clients, size, seconds, think_ms):
+    """以 clients 个并发客户端压测一轮，返回 (吞吐 req/s, p50, p99, 平均批大小)。"""
+    out_queue = mp.Queue()
+    start_at = time.time() + 0.5 + 0.05 * clients
+    procs = [mp.Process(target=client_proc, args=(socket_path, size, seconds, think_ms, start_at, out_queue, i))
+             for i in range(clients)]
+    for p in procs:
+        p.start()
+    latencies, batches = [], []
+    for _ in procs:
+        lat, bat = out_queue.get()
+        latencies.extend(lat)
+        batches.extend(bat)
+    for p in procs:
+        p.join()
+    if not latencies:
+        return 0.0, 0.0, 0.0, 0.0
+    lat = np.array(latencies)
+    return len(lat) / seconds, np.percentile(lat, 50), np.percentile(lat, 99), float(np.mean(batches))
+
+
+def wait_socket(path, proc, timeout=60.0):
+    """等待服务进程创建 socket。"""
+    end = time.time() + timeout
+    while time.time() < end:
+        if proc.poll() is not None:
+            raise RuntimeError('inference server exited during startup')
+        if os.path.exists(path):
+            try:
+                InferenceClient(path).close()
+                return
+            except OSError:
+                pass
+        time.sleep(0.1)
+    raise TimeoutError('inference server did not start')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='推理服务压测')
+    parser.add_argument('--socket', help='压测已运行的服务；不指定时按 --max-batch 逐个启动服务')
+    parser.add_argument('--model', help='启动服务时使用的模型文件')
+    parser.add_argument('--random-weights', action='store_true', help='启动服务时使用未训练的权重')
+    parser.add_argument('--max-batch', default='1,16', help='启动服务时的最大批大小列表，1 即不合批')
+    parser.add_argument('--max-wait-ms', type=float, default=5.0, help='启动服务时的合批等待上限')
+    parser.add_argument('--threads', type=int, default=0, help='服务的 torch 线程数')
+    parser.add_argument('--clients', default='1,2,4,8,16', help='并发客户端数列表')
+    parser.add_argument('--seconds', type=float, default=5.0, help='每轮压测时长')
+    parser.add_argument('--think-ms', type=float, default=0.0, help='客户端两次请求之间的间隔')
+    parser.add_argument('--size', type=int, default=240, help='请求图像边长（原始 RGB）')
+    args = parser.parse_args()
+
+    levels = [int(c) for c in args.clients.split(',')]
+    if args.socket:
+        configs = [(None, args.socket)]
+    else:
+        if not args.model and not args.random_weights:
+            parser.error('启动服务需要 --model 或 --random-weights')
+        configs = [(int(b), f'/tmp/uhand_bench_{os.getpid()}_{b}.sock') for b in args.max_batch.split(',')]
+
+    print(f"{'max_batch':>9} {'clients':>7} {'req/s':>8} {'p50 ms':>8} {'p99 ms':>8} {'avg batch':>9}")
+    for max_batch, path in configs:
+        server = None
+        if max_batch is not None:
+            cmd = [sys.executable, os.path.join(ROOT, 'inference_server.py'), '--socket', path,
+                   '--max-batch', str(max_batch), '--max-wait-ms', str(args.max_wait_ms),
+                   '--threads', str(args.threads)]
+            cmd += ['--model', args.model] if args.model else ['--random-weights']
+            server = subprocess.Popen(cmd, cwd=ROOT, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+            wait_socket(path, server)
+        try:
+            for clients in levels:
+                rps, p50, p99, avg_batch = run_level(path, clients, args.size, args.seconds, args.think_ms)
+                label = '-' if max_batch is None else str(max_batch)
+                print(f"{label:>9} {clients:>7} {rps:>8.1f} {p50:>8.2f} {p99:>8.2f} {avg_batch:>9.2f}", flush=True)
+        finally:
+            if server is not None:
+                server.terminate()
+                server.wait()
+                if os.path.exists(path):
+                    os.unlink(path)
+
+
+if __name__ == '__main__':
+    main()
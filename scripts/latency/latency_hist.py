@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+摄像头到舵机的端到端延时统计
+examples/uhand_colors_trace_esp32cam 在串口收到 "E1$" 后，每个新帧第一次驱动舵机时输出一行:
+    E,帧序号,采集->开始检测,检测耗时,检测完成->Arduino读取,读取->舵机执行   (单位 ms)
+本工具统计各阶段及总延时的分布，并根据帧序号的间隔统计没有被读取到的帧
+
+使用方法:
+    python latency_hist.py --port /dev/ttyUSB0 --seconds 30 --save run1.log
+    python latency_hist.py --log run1.log
+"""
+
+import argparse
+import os
+import sys
+import time
+
+import numpy as np
+
+STAGES = ['capture->detect', 'detect', 'detect->read', 'read->servo']
+
+
+def parse_lines(lines):
+    """解析 E 记录，返回 (N x 4 的各阶段耗时, 帧序号列表)。"""
+    rows, seqs = [], []
+    for line in lines:
+        parts = line.strip().split(',')
+        if len(parts) != 6 or parts[0] != 'E':
+            continue
+        try:
+            values = [int(v) for v in parts[1:]]
+        except ValueError:
+            continue
+        seqs.append(values[0])
+        rows.append(values[1:])
+    return np.array(rows, dtype=np.float64).reshape(-1, len(STAGES)), seqs
+
+
+def capture(port, baud, seconds):
+    """打开串口，开启延时记录并读取 seconds 秒。"""
+    sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'uhand_link'))
+    from negotiate import SerialPort
+
+    serial = SerialPort(port, baud)
+    time.sleep(2.0)                       # 打开串口会让板子复位
+    serial.flush_input()
+    serial.send('E1')
+    lines = []
+    deadline = time.monotonic() + seconds
+    while time.monotonic() < deadline:
+        line = serial.wait_for('E,', timeout=1.0)
+        if line:
+            lines.append(line)
+    serial.send('E0')
+    serial.close()
+    return lines
+
+
+def histogram(values, width=40, bins=12):
+    """ASCII 直方图。"""
+    lo, hi = float(values.min()), float(values.max())
+    edges = np.linspace(lo, max(hi, lo + 1.0), bins + 1)
+    counts, _ = np.histogram(values, edges)
+    peak = max(counts.max(), 1)
+    out = []
+    for i, c in enumerate(counts):
+        bar = '#' * int(round(c * width / peak))
+        out.append(f"  {edges[i]:6.1f}-{edges[i + 1]:6.1f} ms |{bar:<{width}}| {c}")
+    return out
+
+
+def seq_gaps(seqs):
+    """帧序号的间隔，大于1说明中间的帧没有被读取（序号为16位，跳过0回绕）。"""
+    gaps = []
+    for a, b in zip(seqs, seqs[1:]):
+        d = (b - a) % 0x10000
+        if b < a:
+            d -= 1
+        gaps.append(d)
+    return np.array(gaps)
+
+
+def report(data, seqs, show_hist):
+    if len(data) == 0:
+        print("no E records, is the latency log enabled (E1$)?")
+        return 1
+    total = data.sum(axis=1)
+    print(f"{len(data)} frames")
+    print(f"{'stage':<16}{'mean':>8}{'p50':>8}{'p90':>8}{'p99':>8}{'max':>8}")
+    for name, col in list(zip(STAGES, data.T)) + [('total', total)]:
+        p50, p90, p99 = np.percentile(col, [50, 90, 99])
+        print(f"{name:<16}{col.mean():8.1f}{p50:8.1f}{p90:8.1f}{p99:8.1f}{col.max():8.1f}")
+    gaps = seq_gaps(seqs)
+    if len(gaps):
+        skipped = int(np.sum(np.maximum(gaps - 1, 0)))
+        print(f"\nframes per used frame: {gaps.mean():.2f}  "
+              f"(skipped {skipped} of {skipped + len(seqs)} captured frames)")
+    if show_hist:
+        for name, col in list(zip(STAGES, data.T)) + [('total', total)]:
+            print(f"\n{name}")
+            print('\n'.join(histogram(col)))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Camera-to-servo latency histograms')
+    parser.add_argument('--port', help='serial device of the uHand running the trace sketch')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--seconds', type=float, default=30.0)
+    parser.add_argument('--log', help='read E records from a saved log instead of the port')
+    parser.add_argument('--save', help='save the raw records to this file')
+    parser.add_argument('--no-hist', action='store_true', help='only print the summary table')
+    args = parser.parse_args()
+
+    if args.log:
+        with open(args.log) as f:
+            lines = f.readlines()
+    elif args.port:
+        lines = capture(args.port, args.baud, args.seconds)
+    else:
+        parser.error('--port or --log is required')
+
+    if args.save:
+        with open(args.save, 'w') as f:
+            f.writelines(line.strip() + '\n' for line in lines)
+    data, seqs = parse_lines(lines)
+    sys.exit(report(data, seqs, not args.no_hist))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+旋律文本 -> PROGMEM 头文件转换工具
+生成的头文件配合 examples/uhand/melody.h 中的 HW_Melody 播放
+
+记谱格式（每行一个旋律，# 开头为注释）:
+    名称: 音符/时长 音符/时长 ...
+
+    音符   C D E F G A B，可加 # 或 b 升降半音，后接八度，例如 C5、F#4、Bb3
+    R      休止
+    时长   毫秒，按 10ms 取整；0 表示一直保持到 stop() 或被其他旋律打断
+
+示例:
+    win: C5/120 E5/120 G5/120 C6/360
+
+使用方法:
+    python melody2progmem.py melodies.txt -o ../../examples/uhand/melodies.h
+"""
+
+import argparse
+import re
+import sys
+
+NOTE_OFFSETS = {'C': 0, 'D': 2, 'E': 4, 'F': 5, 'G': 7, 'A': 9, 'B': 11}
+TOKEN_RE = re.compile(r'^(?:(R)|([A-G])([#b]?)(-?\d))/(\d+)$')
+MELODY_REST = 0x00
+MELODY_END = 0xFF
+MAX_UNITS = 255  # 单个音符最长 2550ms，更长的自动拆分
+
+
+def parse_token(token, line_no):
+    """把一个 音符/时长 解析为 (MIDI音符号, 时长ms)。"""
+    m = TOKEN_RE.match(token)
+    if not m:
+        raise ValueError(f"line {line_no}: bad note '{token}'")
+    rest, name, accidental, octave, duration = m.groups()
+    duration = int(duration)
+    if rest:
+        return MELODY_REST, duration
+    midi = (int(octave) + 1) * 12 + NOTE_OFFSETS[name]
+    midi += {'#': 1, 'b': -1}.get(accidental, 0)
+    # 蜂鸣器频率按 C9~B9 右移计算，低于 C0 没有意义
+    if not 12 <= midi <= 131:
+        raise ValueError(f"line {line_no}: note '{token}' out of range")
+    return midi, duration
+
+
+def encode(notes):
+    """编码为 {音符, 时长(10ms)} 字节对，以 MELODY_END 结尾。"""
+    data = []
+    for midi, duration in notes:
+        units = (duration + 5) // 10
+        if duration > 0 and units == 0:
+            units = 1
+        if units == 0:
+            data += [midi, 0]
+            continue
+        while units > 0:
+            chunk = min(units, MAX_UNITS)
+            data += [midi, chunk]
+            units -= chunk
+    data.append(MELODY_END)
+    return data
+
+
+def parse(text):
+    """解析记谱文本，返回 [(名称, 字节列表, 原始记谱)]。"""
+    melodies = []
+    names = set()
+    for line_no, line in enumerate(text.splitlines(), 1):
+        line = line.strip()
+        if not line or line.startswith('#'):
+            continue
+        if ':' not in line:
+            raise ValueError(f"line {line_no}: expected 'name: notes'")
+        name, body = (part.strip() for part in line.split(':', 1))
+        if not re.match(r'^[A-Za-z_][A-Za-z0-9_]*$', name):
+            raise ValueError(f"line {line_no}: bad melody name '{name}'")
+        if name.lower() in names:
+            raise ValueError(f"line {line_no}: duplicate melody '{name}'")
+        names.add(name.lower())
+        notes = [parse_token(tok, line_no) for tok in body.split()]
+        melodies.append((name, encode(notes), body))
+    return melodies
+
+
+def render(melodies, source):
+    """生成头文件内容。"""
+    out = [
+        '/*',
+        f' * 由 scripts/melody/melody2progmem.py 从 {source} 生成，请勿手动修改',
+        ' */',
+        '',
+        '#ifndef __MELODIES_H_',
+        '#define __MELODIES_H_',
+        '',
+        '#include <Arduino.h>',
+        '#include "melody.h"',
+        '',
+    ]
+    total = 0
+    for name, data, body in melodies:
+        total += len(data)
+        values = ', '.join(str(b) for b in data)
+        out.append(f'// {body}')
+        out.append(f'const uint8_t MELODY_{name.upper()}[] PROGMEM = {{ {values} }};')
+    out += ['', f'// total {total} bytes of flash', '', '#endif //__MELODIES_H_', '']
+    return '\r\n'.join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert melody text notation to a PROGMEM header')
+    parser.add_argument('input', help='melody text file')
+    parser.add_argument('-o', '--output', help='output header (default: stdout)')
+    args = parser.parse_args()
+
+    with open(args.input, 'r', encoding='utf-8') as f:
+        text = f.read()
+    try:
+        melodies = parse(text)
+    except ValueError as e:
+        print(f"{args.input}: {e}", file=sys.stderr)
+        sys.exit(1)
+
+    header = render(melodies, args.input.replace('\\', '/').split('/')[-1])
+    if args.output:
+        with open(args.output, 'w', encoding='utf-8', newline='') as f:
+            f.write(header)
+        print(f"{len(melodies)} melodies written to {args.output}")
+    else:
+        sys.stdout.write(header)
+
+
+if __name__ == '__main__':
+    main()
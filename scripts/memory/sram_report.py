@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+AVR 固件静态 SRAM 占用报告
+读取编译生成的 ELF，列出 .data/.bss/.noinit 中每个变量的大小，统计留给栈和堆的空间
+配合 examples/uhand/mem_stat.h 的运行时水位（串口 "M$"）一起看，判断复位是否由栈溢出引起
+
+获取 ELF:
+    arduino-cli compile -b arduino:avr:nano --output-dir build examples/uhand
+    或 Arduino IDE 打开"编译时显示详细输出"，在临时目录中找到 uhand.ino.elf
+
+使用方法:
+    python sram_report.py build/uhand.ino.elf
+    python sram_report.py build/uhand.ino.elf --top 20 --min-stack 384
+"""
+
+import argparse
+import shutil
+import subprocess
+import sys
+
+RAM_SIZE = 2048  # ATmega328P
+SECTIONS = ('.data', '.bss', '.noinit')
+# nm 符号类型 -> 段
+NM_TYPES = {'d': '.data', 'b': '.bss'}
+
+
+def find_tool(name, prefix):
+    """优先使用 avr- 前缀的工具，没有时退回系统 binutils（同样能解析 AVR 的 ELF）。"""
+    for candidate in (prefix + name, name):
+        if shutil.which(candidate):
+            return candidate
+    raise FileNotFoundError(f"{prefix}{name} not found, install binutils-avr")
+
+
+def section_sizes(elf, prefix):
+    """读取各段大小，返回 {段名: 字节数}。"""
+    out = subprocess.run([find_tool('size', prefix), '-A', elf],
+                         capture_output=True, text=True, check=True).stdout
+    sizes = {}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) >= 2 and parts[0] in SECTIONS:
+            sizes[parts[0]] = int(parts[1])
+    return sizes
+
+
+def ram_symbols(elf, prefix):
+    """读取位于 RAM 中的符号，返回 [(段名, 大小, 名称)]，按大小降序。"""
+    out = subprocess.run([find_tool('nm', prefix), '-S', '-C', '--size-sort', elf],
+                         capture_output=True, text=True, check=True).stdout
+    symbols = []
+    for line in out.splitlines():
+        parts = line.split(None, 3)
+        if len(parts) < 4:
+            continue
+        _, size, kind, name = parts
+        section = NM_TYPES.get(kind.lower())
+        if section is None:
+            continue
+        symbols.append((section, int(size, 16), name))
+    symbols.sort(key=lambda s: s[1], reverse=True)
+    return symbols
+
+
+def report(elf, prefix, top, ram_size, min_stack):
+    sizes = section_sizes(elf, prefix)
+    symbols = ram_symbols(elf, prefix)
+    static = sum(sizes.values())
+    remain = ram_size - static
+
+    print(f"{elf}")
+    print(f"{'section':<10}{'bytes':>8}")
+    for name in SECTIONS:
+        if name in sizes:
+            print(f"{name:<10}{sizes[name]:>8}")
+    print(f"{'static':<10}{static:>8}  ({static * 100 / ram_size:.1f}% of {ram_size})")
+    print(f"{'stack+heap':<10}{remain:>8}")
+    print()
+
+    shown = symbols if top <= 0 else symbols[:top]
+    print(f"{'bytes':>6}  {'section':<8}symbol")
+    for section, size, name in shown:
+        print(f"{size:>6}  {section:<8}{name}")
+    if len(shown) < len(symbols):
+        rest = sum(s[1] for s in symbols[len(shown):])
+        print(f"{rest:>6}  {'':<8}({len(symbols) - len(shown)} more symbols)")
+
+    if remain < min_stack:
+        print(f"\nWARNING: only {remain} bytes left for stack and heap (< {min_stack})",
+              file=sys.stderr)
+        return 1
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Static SRAM breakdown of an AVR ELF')
+    parser.add_argument('elf', help='firmware ELF file')
+    parser.add_argument('--top', type=int, default=15, help='number of symbols to list (0 = all)')
+    parser.add_argument('--ram', type=int, default=RAM_SIZE, help='SRAM size in bytes')
+    parser.add_argument('--min-stack', type=int, default=256,
+                        help='exit with 1 if less than this is left for stack and heap')
+    parser.add_argument('--prefix', default='avr-', help='binutils prefix')
+    args = parser.parse_args()
+
+    try:
+        code = report(args.elf, args.prefix, args.top, args.ram, args.min_stack)
+    except (FileNotFoundError, subprocess.CalledProcessError) as e:
+        print(e, file=sys.stderr)
+        sys.exit(2)
+    sys.exit(code)
+
+
+if __name__ == '__main__':
+    main()
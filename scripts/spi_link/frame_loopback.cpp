@@ -0,0 +1,174 @@
+/*
+ * ESP32Cam 结果帧（examples/ColorDetection/result_frame.h）的主机回环测试与链路带宽对比
+ * 回环：随机载荷组帧后经过模拟信道（位翻转、丢字节、帧错位），统计校验通过/拒收/漏检的帧和序号间隔
+ * 带宽：按总线时序估算 100kHz IIC 寄存器读取与 SPI 帧读取每秒能取得的完整结果数
+ *
+ * 编译:
+ *   g++ -std=c++11 -O2 -I ../../examples/ColorDetection frame_loopback.cpp -o frame_loopback
+ * 运行:
+ *   ./frame_loopback [--frames 100000] [--ber 1e-4] [--drop 1e-3] [--seed 1]
+ *                    [--i2c-hz 100000] [--spi-hz 2000000] [--avr-bit-cycles 8] [--avr-crc-cycles 70]
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "result_frame.h"
+
+struct Options
+{
+  long frames = 100000;
+  double ber = 1e-4;            // 每一位翻转的概率
+  double drop = 1e-3;           // 每帧丢失一个字节（帧错位）的概率
+  unsigned seed = 1;
+  double i2c_hz = 100000;
+  double spi_hz = 2000000;      // 从机可以接受的时钟；软件时序时由 avr_bit_cycles 限制
+  double avr_hz = 16000000;
+  double avr_bit_cycles = 8;    // 软件SPI每一位的指令周期
+  double avr_crc_cycles = 70;   // 逐位 CRC16 每字节的指令周期
+};
+
+static bool parse(int argc, char **argv, Options *o)
+{
+  for (int i = 1; i < argc; ++i) {
+    const char *a = argv[i];
+    const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+    if (!v) {
+      return false;
+    }
+    if (!strcmp(a, "--frames")) o->frames = atol(v);
+    else if (!strcmp(a, "--ber")) o->ber = atof(v);
+    else if (!strcmp(a, "--drop")) o->drop = atof(v);
+    else if (!strcmp(a, "--seed")) o->seed = atoi(v);
+    else if (!strcmp(a, "--i2c-hz")) o->i2c_hz = atof(v);
+    else if (!strcmp(a, "--spi-hz")) o->spi_hz = atof(v);
+    else if (!strcmp(a, "--avr-bit-cycles")) o->avr_bit_cycles = atof(v);
+    else if (!strcmp(a, "--avr-crc-cycles")) o->avr_crc_cycles = atof(v);
+    else return false;
+    ++i;
+  }
+  return true;
+}
+
+// 回环：发送端组帧 -> 信道 -> 接收端按 RESULT_FRAME_SIZE 切帧校验
+static int loopback(const Options &o)
+{
+  std::mt19937 rng(o.seed);
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::uniform_real_distribution<double> uni(0, 1);
+
+  long accepted = 0, rejected = 0, undetected = 0, gaps = 0, corrupted = 0;
+  long pending_rejects = 0, rejected_between = 0;  // 两个通过的帧之间被拒收的帧数，应与序号间隔一致
+  uint16_t last_seq = 0;
+  bool have_seq = false;
+  std::vector<uint8_t> frame(RESULT_FRAME_SIZE), sent(RESULT_FRAME_SIZE);
+
+  for (long n = 0; n < o.frames; ++n) {
+    uint16_t seq = (uint16_t)n;
+    memset(sent.data(), 0, RESULT_FRAME_SIZE);
+    for (int i = 0; i < RESULT_PAYLOAD_LEN; ++i) {
+      sent[RESULT_FRAME_HEAD + i] = byte(rng);
+    }
+    result_frame_seal(sent.data(), seq, RESULT_PAYLOAD_LEN, n % 7 == 0 ? RESULT_FLAG_UNCHANGED : 0);
+
+    // 每一帧都是一次独立的 CS 事务，丢字节只会让本帧错位并在末尾补 0xFF（MISO 上拉）
+    frame = sent;
+    bool damaged = false;
+    if (uni(rng) < o.drop) {
+      int at = byte(rng) % RESULT_FRAME_SIZE;
+      frame.erase(frame.begin() + at);
+      frame.push_back(0xFF);
+      damaged = true;
+    }
+    for (int i = 0; i < RESULT_FRAME_SIZE; ++i) {
+      for (int b = 0; b < 8; ++b) {
+        if (uni(rng) < o.ber) {
+          frame[i] ^= 1 << b;
+          damaged = true;
+        }
+      }
+    }
+    damaged = damaged && frame != sent;
+    corrupted += damaged;
+
+    int len = result_frame_check(frame.data());
+    if (len < 0) {
+      ++rejected;
+      ++pending_rejects;
+      continue;
+    }
+    ++accepted;
+    if (frame != sent) {
+      ++undetected;
+    }
+    uint16_t rseq = result_frame_seq(frame.data());
+    if (have_seq) {
+      gaps += (uint16_t)(rseq - last_seq) - 1;
+      rejected_between += pending_rejects;
+    }
+    pending_rejects = 0;
+    last_seq = rseq;
+    have_seq = true;
+  }
+
+  printf("loopback: %ld frames of %d bytes (payload %d), ber %.1e, drop %.1e\n",
+         o.frames, RESULT_FRAME_SIZE, RESULT_PAYLOAD_LEN, o.ber, o.drop);
+  printf("  corrupted in channel %ld, rejected %ld, accepted %ld, undetected errors %ld, frames missing by seq %ld\n",
+         corrupted, rejected, accepted, undetected, gaps);
+  if (undetected || rejected != corrupted || gaps != rejected_between) {
+    printf("  FAIL\n");
+    return 1;
+  }
+  printf("  ok\n");
+  return 0;
+}
+
+// IIC 读一个寄存器：写(地址+寄存器) 与 读(地址+len字节)，每字节9位，加起止位
+static double i2c_register_s(double hz, int len)
+{
+  double bits = (1 + 2 * 9 + 1) + (1 + (1 + len) * 9 + 1);
+  return bits / hz;
+}
+
+static void bandwidth(const Options &o)
+{
+  // 完整结果：5种颜色最大色块 + 5种颜色的跟踪块
+  double i2c_boxes = 5 * i2c_register_s(o.i2c_hz, 4);
+  double i2c_tracks = 5 * i2c_register_s(o.i2c_hz, 1 + RESULT_TRACK_K * 8);
+  double i2c_full = i2c_boxes + i2c_tracks;
+
+  double spi_bit_hz = o.spi_hz;
+  double avr_bit_hz = o.avr_hz / o.avr_bit_cycles;
+  if (avr_bit_hz < spi_bit_hz) {
+    spi_bit_hz = avr_bit_hz;
+  }
+  double spi_wire = RESULT_FRAME_SIZE * 8 / spi_bit_hz;
+  double spi_crc = RESULT_FRAME_SIZE * o.avr_crc_cycles / o.avr_hz;
+  double spi_full = spi_wire + spi_crc;
+
+  printf("\nbandwidth (bus time per complete result, one master)\n");
+  printf("  %-34s %9s %10s %12s\n", "link", "bytes", "time(ms)", "results/s");
+  printf("  %-34s %9d %10.2f %12.0f\n", "i2c reg 0x01 only (4B box)", 4,
+         i2c_register_s(o.i2c_hz, 4) * 1e3, 1 / i2c_register_s(o.i2c_hz, 4));
+  printf("  %-34s %9d %10.2f %12.0f\n", "i2c 5 boxes + 5 track blocks",
+         5 * 4 + 5 * (1 + RESULT_TRACK_K * 8), i2c_full * 1e3, 1 / i2c_full);
+  printf("  %-34s %9d %10.2f %12.0f\n", "spi frame (wire only)", RESULT_FRAME_SIZE, spi_wire * 1e3, 1 / spi_wire);
+  printf("  %-34s %9d %10.2f %12.0f\n", "spi frame + crc on avr", RESULT_FRAME_SIZE, spi_full * 1e3, 1 / spi_full);
+  printf("  spi clock %.2f MHz (%s), speedup for the complete result %.1fx\n",
+         spi_bit_hz / 1e6, spi_bit_hz < o.spi_hz ? "limited by avr bit-banging" : "slave limit",
+         i2c_full / spi_full);
+}
+
+int main(int argc, char **argv)
+{
+  Options o;
+  if (!parse(argc, argv, &o)) {
+    fprintf(stderr, "usage: %s [--frames N] [--ber P] [--drop P] [--seed S] [--i2c-hz HZ] [--spi-hz HZ] "
+                    "[--avr-bit-cycles C] [--avr-crc-cycles C]\n", argv[0]);
+    return 2;
+  }
+  int ret = loopback(o);
+  bandwidth(o);
+  return ret;
+}
@@ -0,0 +1,299 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+超参数搜索：多个 trial 并行训练，每个进程绑定互不重叠的 CPU 核
+数据集只解码一次，写成 uint8 的 .npy 缓存，所有 worker 以只读 memmap 打开，共享同一份页缓存
+每轮评估后做早停（patience）和中位数剪枝（最佳准确率低于同一轮已结束 trial 的中位数时停止），
+最后汇总成一张结果表（同时写 results.csv / results.json）
+
+搜索配置（JSON，示例见 example_sweep.json）:
+    method    "grid"（params 中所有列表的笛卡尔积）或 "random"（按 trials 个数随机采样）
+    trials    random 的 trial 数
+    epochs    每个 trial 的最大轮数
+    patience  测试准确率连续多少轮没有提升就早停，0 为不早停
+    prune_after  从第几轮开始剪枝，0 为不剪枝
+    base      所有 trial 共用的参数
+    params    搜索的参数，值为列表（grid/random 都可用）或 {"uniform": [a, b]} / {"log_uniform": [a, b]}（仅 random）
+可用参数: arch, dropout_rate, hidden_units（仅 cnn）, learning_rate, weight_decay, batch_size, fast, compile_model
+
+使用方法（在仓库根目录运行）:
+    python scripts/sweep/sweep.py --spec scripts/sweep/example_sweep.json --workers 4
+    python scripts/sweep/sweep.py --spec my_sweep.json --workers 8 --cores 0-31 --out experiments/sweep_lr
+"""
+
+import argparse
+import hashlib
+import itertools
+import json
+import multiprocessing as mp
+import os
+import queue
+import sys
+import time
+
+import numpy as np
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', '..'))
+sys.path.insert(0, ROOT)
+
+# 这里不 import torch/train：worker 用 spawn 启动，要先绑核、设好线程数再初始化 torch 的线程池
+
+MODEL_PARAMS = ('dropout_rate', 'hidden_units')
+DEFAULTS = {
+    'arch': 'cnn', 'dropout_rate': 0.5, 'learning_rate': 0.001, 'weight_decay': 1e-4,
+    'batch_size': 16, 'fast': True, 'compile_model': False,
+}
+
+
+def expand_spec(spec):
+    """把搜索配置展开成 trial 参数列表。"""
+    base = dict(DEFAULTS, **spec.get('base', {}))
+    params = spec.get('params', {})
+    if spec.get('method', 'grid') == 'grid':
+        names = list(params)
+        for name in names:
+            if not isinstance(params[name], list):
+                raise ValueError(f"grid 搜索的参数必须是列表: {name}")
+        return [dict(base, **dict(zip(names, values))) for values in itertools.product(*(params[n] for n in names))]
+
+    rng = np.random.default_rng(spec.get('seed', 0))
+    trials = []
+    for _ in range(spec.get('trials', 10)):
+        trial = dict(base)
+        for name, space in params.items():
+            if isinstance(space, list):
+                trial[name] = space[rng.integers(len(space))]
+            elif 'uniform' in space:
+                trial[name] = float(rng.uniform(*space['uniform']))
+            elif 'log_uniform' in space:
+                low, high = np.log(space['log_uniform'])
+                trial[name] = float(np.exp(rng.uniform(low, high)))
+            else:
+                raise ValueError(f"未知的取值范围: {name}: {space}")
+        trials.append(trial)
+    return trials
+
+
+def build_cache(data_dir, cache_dir):
+    """
+    解码数据集写成 images.npy（uint8, N x 3 x 64 x 64）和 labels.npy，前 n_train 个是训练集
+    文件列表不变时直接复用已有缓存
+    """
+    from train import GestureDataset, decode_dataset, load_dataset_from_folders
+
+    train_paths, test_paths, train_labels, test_labels = load_dataset_from_folders(data_dir)
+    digest = hashlib.sha1('\n'.join(train_paths + test_paths).encode('utf-8')).hexdigest()
+    meta_path = os.path.join(cache_dir, 'meta.json')
+    if os.path.exists(meta_path):
+        with open(meta_path, 'r', encoding='utf-8') as f:
+            meta = json.load(f)
+        if meta.get('files_sha1') == digest:
+            print(f"复用数据集缓存 {cache_dir}")
+            return meta
+
+    os.makedirs(cache_dir, exist_ok=True)
+    t0 = time.perf_counter()
+    train_images, train_y = decode_dataset(GestureDataset(train_paths, train_labels))
+    test_images, test_y = decode_dataset(GestureDataset(test_paths, test_labels))
+    images = np.lib.format.open_memmap(os.path.join(cache_dir, 'images.npy'), mode='w+', dtype=np.uint8,
+                                       shape=(len(train_y) + len(test_y),) + train_images.shape[1:])
+    images[:len(train_y)] = train_images
+    images[len(train_y):] = test_images
+    images.flush()
+    del images
+    np.save(os.path.join(cache_dir, 'labels.npy'), np.concatenate([train_y, test_y]).astype(np.int64))
+    meta = {'data_dir': data_dir, 'files_sha1': digest, 'n_train': len(train_y), 'n_test': len(test_y)}
+    with open(meta_path, 'w', encoding='utf-8') as f:
+        json.dump(meta, f, indent=2)
+    print(f"数据集缓存已写入 {cache_dir}（{len(train_y) + len(test_y)} 张，{time.perf_counter() - t0:.1f} s）")
+    return meta
+
+
+def parse_cores(text):
+    """'0-7,16-23' -> [0, ..., 7, 16, ..., 23]"""
+    cores = []
+    for part in text.split(','):
+        low, _, high = part.partition('-')
+        cores.extend(range(int(low), int(high or low) + 1))
+    return cores
+
+
+def split_cores(cores, workers):
+    """把核平均分成 workers 份，互不重叠。"""
+    if len(cores) < workers:
+        raise ValueError(f"{len(cores)} 个核不够分给 {workers} 个 worker")
+    return [[int(c) for c in chunk] for chunk in np.array_split(np.array(cores), workers)]
+
+
+class Stopper:
+    """每轮评估后调用：早停 + 中位数剪枝。curves 是所有已结束 trial 的逐轮测试准确率（进程间共享）。"""
+
+    def __init__(self, curves, patience, prune_after):
+        self.curves = curves
+        self.patience = patience
+        self.prune_after = prune_after
+        self.status = 'done'
+
+    def __call__(self, epoch, history):
+        acc = history['test_accuracy']
+        best = max(acc)
+        if self.patience and epoch - int(np.argmax(acc)) >= self.patience:
+            self.status = 'early-stopped'
+            return True
+        if self.prune_after and epoch + 1 >= self.prune_after:
+            # 已结束的 trial 在这一轮的最佳准确率；提前结束的 trial 保持最后的最佳值
+            others = [max(c[:epoch + 1]) for c in list(self.curves)]
+            if len(others) >= 2 and best < float(np.median(others)):
+                self.status = 'pruned'
+                return True
+        return False
+
+
+def worker(index, cores, cache_dir, meta, task_queue, result_queue, curves, spec):
+    """worker 进程：绑核后依次领取 trial 训练，直到领到 None。"""
+    if hasattr(os, 'sched_setaffinity'):
+        os.sched_setaffinity(0, cores)
+    os.environ['OMP_NUM_THREADS'] = str(len(cores))
+
+    import logging
+    import torch
+
+    torch.set_num_threads(len(cores))
+    torch.set_num_interop_threads(1)
+    logging.getLogger('train').setLevel(logging.WARNING)
+    from train import GestureTrainer, InMemoryLoader, build_model
+
+    images = np.load(os.path.join(cache_dir, 'images.npy'), mmap_mode='r')
+    labels = np.load(os.path.join(cache_dir, 'labels.npy'), mmap_mode='r')
+    n_train = meta['n_train']
+    train_set = (images[:n_train], labels[:n_train])
+    test_set = (images[n_train:], labels[n_train:])
+
+    while True:
+        task = task_queue.get()
+        if task is None:
+            return
+        trial_id, params = task
+        t0 = time.perf_counter()
+        result = {'trial': trial_id, **params, 'worker': index, 'cores': f"{cores[0]}-{cores[-1]}"}
+        try:
+            torch.manual_seed(spec.get('seed', 0) + trial_id)
+            fast = bool(params['fast'])
+            kwargs = {k: params[k] for k in MODEL_PARAMS if k in params}
+            model = build_model(params['arch'], num_classes=11, **kwargs)
+            trainer = GestureTrainer(model, 'cpu', fast=fast, compile_model=bool(params['compile_model']),
+                                     progress=False)
+            train_loader = InMemoryLoader(train_set, int(params['batch_size']), shuffle=True, drop_last=fast,
+                                          channels_last=fast)
+            test_loader = InMemoryLoader(test_set, int(params['batch_size']), channels_last=fast)
+            stopper = Stopper(curves, spec.get('patience', 0), spec.get('prune_after', 0))
+            history = trainer.train(train_loader, test_loader, num_epochs=spec.get('epochs', 50),
+                                    learning_rate=float(params['learning_rate']),
+                                    weight_decay=float(params['weight_decay']), epoch_callback=stopper)
+            acc = history['test_accuracy']
+            if stopper.status != 'pruned':
+                # 被剪枝的曲线不参与之后的中位数，否则中位数会被越拉越低
+                curves.append(acc)
+            result.update(status=stopper.status, epochs=len(acc), best_accuracy=max(acc),
+                          best_epoch=int(np.argmax(acc)) + 1, final_accuracy=acc[-1])
+        except Exception as e:
+            result.update(status='failed', error=str(e))
+        result['seconds'] = time.perf_counter() - t0
+        result_queue.put(result)
+
+
+def print_table(results, names):
+    """按最佳准确率排序打印结果表。"""
+    columns = ['trial'] + names + ['status', 'epochs', 'best_accuracy', 'best_epoch', 'seconds']
+    rows = sorted(results, key=lambda r: -r.get('best_accuracy', -1.0))
+
+    def fmt(value):
+        if isinstance(value, float):
+            return f"{value:.4g}"
+        return str(value)
+
+    cells = [[fmt(r.get(c, '')) for c in columns] for r in rows]
+    widths = [max(len(c), *(len(row[i]) for row in cells)) for i, c in enumerate(columns)]
+    print('  '.join(c.rjust(w) for c, w in zip(columns, widths)))
+    for row in cells:
+        print('  '.join(v.rjust(w) for v, w in zip(row, widths)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='并行超参数搜索')
+    parser.add_argument('--spec', required=True, help='搜索配置 JSON')
+    parser.add_argument('--data-dir', default=os.path.join('datasets', 'resized_img_split'), help='数据集目录')
+    parser.add_argument('--cache', default=os.path.join('datasets', 'sweep_cache'), help='数据集缓存目录')
+    parser.add_argument('--workers', type=int, default=2, help='并行的 trial 数')
+    parser.add_argument('--cores', help="参与搜索的核，如 '0-15'，默认为当前进程可用的全部核")
+    parser.add_argument('--out', default=os.path.join('experiments', 'sweep'), help='结果目录')
+    args = parser.parse_args()
+
+    with open(args.spec, 'r', encoding='utf-8') as f:
+        spec = json.load(f)
+    trials = expand_spec(spec)
+    if args.cores:
+        cores = parse_cores(args.cores)
+    elif hasattr(os, 'sched_getaffinity'):
+        cores = sorted(os.sched_getaffinity(0))
+    else:
+        cores = list(range(os.cpu_count() or 1))
+    workers = min(args.workers, len(trials))
+    if workers > len(cores):
+        print(f"只有 {len(cores)} 个核，worker 数从 {workers} 减为 {len(cores)}")
+        workers = len(cores)
+    core_sets = split_cores(cores, workers)
+
+    meta = build_cache(args.data_dir, args.cache)
+    print(f"{len(trials)} 个 trial，{workers} 个 worker，每个 {len(core_sets[0])}~{len(core_sets[-1])} 个核")
+
+    ctx = mp.get_context('spawn')
+    manager = ctx.Manager()
+    curves = manager.list()
+    task_queue, result_queue = ctx.Queue(), ctx.Queue()
+    for trial_id, params in enumerate(trials):
+        task_queue.put((trial_id, params))
+    for _ in range(workers):
+        task_queue.put(None)
+    procs = [ctx.Process(target=worker, args=(i, core_sets[i], args.cache, meta, task_queue, result_queue, curves, spec))
+             for i in range(workers)]
+    for p in procs:
+        p.start()
+
+    t0 = time.perf_counter()
+    results = []
+    while len(results) < len(trials):
+        try:
+            r = result_queue.get(timeout=5.0)
+        except queue.Empty:
+            if not any(p.is_alive() for p in procs):
+                print('worker 已全部退出，部分 trial 没有结果')
+                break
+            continue
+        results.append(r)
+        print(f"[{len(results)}/{len(trials)}] trial {r['trial']} {r['status']} "
+              f"{r.get('best_accuracy', float('nan')):.2f}% ({r['seconds']:.0f} s, cores {r['cores']})"
+              + (f" {r['error']}" if 'error' in r else ''))
+    for p in procs:
+        p.join()
+    manager.shutdown()
+
+    names = sorted({k for t in trials for k in t}, key=lambda k: (k not in spec.get('params', {}), k))
+    print(f"\n用时 {time.perf_counter() - t0:.0f} s")
+    print_table(results, names)
+
+    os.makedirs(args.out, exist_ok=True)
+    with open(os.path.join(args.out, 'results.json'), 'w', encoding='utf-8') as f:
+        json.dump({'spec': spec, 'results': results}, f, ensure_ascii=False, indent=2)
+    import csv
+    columns = ['trial'] + names + ['status', 'epochs', 'best_accuracy', 'best_epoch', 'final_accuracy',
+                                   'seconds', 'worker', 'cores', 'error']
+    with open(os.path.join(args.out, 'results.csv'), 'w', encoding='utf-8', newline='') as f:
+        writer = csv.DictWriter(f, fieldnames=columns, extrasaction='ignore')
+        writer.writeheader()
+        writer.writerows(sorted(results, key=lambda r: r['trial']))
+    print(f"结果已写入 {args.out}")
+
+
+if __name__ == '__main__':
+    main()
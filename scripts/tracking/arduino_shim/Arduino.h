@@ -0,0 +1,15 @@
+/*
+ * 在电脑上编译Arduino例程模块时使用的最小Arduino.h
+ * 只提供例程模块实际用到的类型和宏
+ */
+#ifndef __ARDUINO_SHIM_H_
+#define __ARDUINO_SHIM_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#endif //__ARDUINO_SHIM_H_
@@ -0,0 +1,150 @@
+/*
+ * 色块跟踪控制器的电脑端仿真
+ * 用例程中的 blob_tracker.cpp 回放录制的色块轨迹，与原来的 map + 0.15 一阶滤波方案对比跟踪误差
+ *
+ * 编译:
+ *   g++ -O2 -I arduino_shim -I ../../examples/uhand_colors_trace_esp32cam \
+ *       tracker_sim.cpp ../../examples/uhand_colors_trace_esp32cam/blob_tracker.cpp -o tracker_sim
+ *
+ * 录制轨迹: 串口发送 "T1$" 后，例程每次读取相机都会输出 "B,<ms>,<x>"（未识别到时 x=-1），保存为文本文件
+ *
+ * 使用:
+ *   ./tracker_sim                 使用内置的合成轨迹
+ *   ./tracker_sim track.log       回放录制的轨迹
+ *   ./tracker_sim track.log 80    指定相机延时(ms)，默认80
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include "blob_tracker.h"
+
+struct Sample
+{
+  uint32_t ms;
+  int x;
+};
+
+static const uint32_t CAM_PERIOD_MS = 75;   // espcam_task 周期
+static const float SERVO_TAU_MS = 40.0f;    // 舵机一阶响应时间常数
+
+static std::vector<Sample> load_log(const char *path)
+{
+  std::vector<Sample> track;
+  FILE *fp = fopen(path, "r");
+  if (!fp) {
+    perror(path);
+    exit(1);
+  }
+  char line[128];
+  while (fgets(line, sizeof(line), fp)) {
+    unsigned long ms;
+    int x;
+    if (sscanf(line, "B,%lu,%d", &ms, &x) == 2) {
+      track.push_back({(uint32_t)ms, x});
+    }
+  }
+  fclose(fp);
+  return track;
+}
+
+// 合成轨迹：来回摆动并带有停顿和测量噪声
+static std::vector<Sample> synth_track(void)
+{
+  std::vector<Sample> track;
+  srand(1);
+  for (uint32_t ms = 0; ms < 20000; ms += CAM_PERIOD_MS) {
+    float t = ms / 1000.0f;
+    float x = 160 + 120 * sinf(2 * (float)M_PI * t / 2.5f);
+    if ((int)t % 5 == 4) {
+      x = 160;
+    }
+    x += (rand() % 7) - 3;
+    track.push_back({ms, (int)x});
+  }
+  return track;
+}
+
+// 目标真实位置：测量值反映的是 cam_latency 之前的画面
+static bool truth_at(const std::vector<Sample> &track, uint32_t ms, uint32_t cam_latency, float *x)
+{
+  uint32_t t = ms + cam_latency;
+  for (size_t i = 1; i < track.size(); ++i) {
+    if (track[i].ms >= t) {
+      const Sample &a = track[i - 1], &b = track[i];
+      if (a.x < 0 || b.x < 0) {
+        return false;
+      }
+      *x = a.x + (b.x - a.x) * (float)(t - a.ms) / (float)(b.ms - a.ms);
+      return true;
+    }
+  }
+  return false;
+}
+
+static float x_to_angle(float x)
+{
+  return 60 + x * 60 / 320;
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<Sample> track = argc > 1 ? load_log(argv[1]) : synth_track();
+  uint32_t cam_latency = argc > 2 ? atoi(argv[2]) : 80;
+  if (track.size() < 2) {
+    fprintf(stderr, "track too short\n");
+    return 1;
+  }
+
+  HW_BlobTracker tracker;
+  tracker.begin(90);
+
+  float old_target = 90, old_cmd = 90, old_servo = 90;
+  float new_cmd = 90, new_servo = 90;
+  double old_err2 = 0, new_err2 = 0, old_max = 0, new_max = 0;
+  size_t n = 0, next = 0;
+  uint32_t t0 = track.front().ms, t1 = track.back().ms;
+
+  for (uint32_t ms = t0; ms <= t1; ++ms) {
+    // 相机测量
+    while (next < track.size() && track[next].ms <= ms) {
+      if (track[next].x >= 0) {
+        tracker.measure(track[next].x, track[next].ms);
+        old_target = x_to_angle(track[next].x);
+      }
+      next++;
+    }
+    // 原方案：40ms 一次 0.15 一阶滤波
+    if ((ms - t0) % 40 == 0) {
+      old_cmd = old_cmd * 0.85f + old_target * 0.15f;
+    }
+    // 新方案：20ms 一次跟踪控制
+    if ((ms - t0) % 20 == 0) {
+      new_cmd = tracker.update(ms) / 256.0f;
+    }
+    // 舵机响应
+    old_servo += (old_cmd - old_servo) / SERVO_TAU_MS;
+    new_servo += (new_cmd - new_servo) / SERVO_TAU_MS;
+
+    float x;
+    if (truth_at(track, ms, cam_latency, &x)) {
+      float ref = x_to_angle(x);
+      double eo = fabs(old_servo - ref), en = fabs(new_servo - ref);
+      old_err2 += eo * eo;
+      new_err2 += en * en;
+      old_max = eo > old_max ? eo : old_max;
+      new_max = en > new_max ? en : new_max;
+      n++;
+    }
+  }
+
+  if (n == 0) {
+    fprintf(stderr, "no valid samples\n");
+    return 1;
+  }
+  printf("samples: %zu  camera latency: %u ms\n", n, cam_latency);
+  printf("             rms(deg)  max(deg)\n");
+  printf("ema 0.15     %8.2f  %8.2f\n", sqrt(old_err2 / n), old_max);
+  printf("tracker      %8.2f  %8.2f\n", sqrt(new_err2 / n), new_max);
+  return 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * uHand 客户端吞吐量与往返时间测试
+ * 可以连接真实的板子，也可以启动 scripts/uhand_link 下的模拟设备（伪终端 + 固件的命令解析）
+ *
+ * 编译:
+ *   g++ -std=c++17 -O2 -pthread uhand_bench.cpp uhand_client.cpp -o uhand_bench
+ *   g++ -O2 -I ../../examples/uhand ../uhand_link/mock_uhand.cpp ../../examples/uhand/uhand_protocol.cpp -o mock_uhand
+ * 运行:
+ *   ./uhand_bench --mock ./mock_uhand [--realtime] [--poses 500] [--max-baud 115200]
+ *   ./uhand_bench --port /dev/ttyUSB0
+ */
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "uhand_client.h"
+
+// 启动模拟设备，读取它打印的伪终端路径
+static pid_t start_mock(const char *exe, bool realtime, std::string *path)
+{
+  int pipefd[2];
+  if (pipe(pipefd) != 0) {
+    return -1;
+  }
+  pid_t pid = fork();
+  if (pid == 0) {
+    dup2(pipefd[1], STDOUT_FILENO);
+    freopen("/dev/null", "w", stderr);
+    close(pipefd[0]);
+    if (realtime) {
+      execl(exe, exe, "--realtime", (char *)NULL);
+    } else {
+      execl(exe, exe, (char *)NULL);
+    }
+    _exit(127);
+  }
+  close(pipefd[1]);
+  char buf[128];
+  ssize_t n = read(pipefd[0], buf, sizeof(buf) - 1);
+  close(pipefd[0]);
+  if (n <= 0) {
+    return -1;
+  }
+  buf[n] = '\0';
+  *path = std::string(buf, strcspn(buf, "\r\n"));
+  return pid;
+}
+
+static double now_ms(void)
+{
+  return std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool run(const std::string &path, const UhandOptions &opts, int poses)
+{
+  UhandClient hand;
+  if (!hand.open(path, opts)) {
+    return false;
+  }
+
+  // 流式发送姿态，窗口内的命令不等应答连续发出
+  double start = now_ms();
+  int failed = 0;
+  std::vector<std::future<bool>> results;
+  results.reserve(poses);
+  for (int i = 0; i < poses; ++i) {
+    uint8_t a = 30 + (i * 7) % 120;
+    results.push_back(hand.setPose({ a, a, a, a, a, a }));
+  }
+  for (auto &r : results) {
+    failed += !r.get();
+  }
+  double stream_ms = now_ms() - start;
+  UhandStats s = hand.stats();
+
+  // 遥测往返时间
+  const int rounds = 50;
+  start = now_ms();
+  int valid = 0;
+  for (int i = 0; i < rounds; ++i) {
+    valid += hand.telemetry().get().valid;
+  }
+  double telemetry_ms = (now_ms() - start) / rounds;
+
+  printf("baud %7u window %2zu: %7.1f poses/s  ack rtt avg %6.2f ms max %6.2f ms  "
+         "failed %d  telemetry %.2f ms (%d/%d)\n",
+         hand.baud(), opts.window, poses * 1000.0 / stream_ms, s.rtt_avg_ms, s.rtt_max_ms,
+         failed, telemetry_ms, valid, rounds);
+  hand.close();
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  const char *mock = NULL;
+  std::string path;
+  bool realtime = false;
+  int poses = 300;
+  UhandOptions opts;
+  opts.handshake_wait_ms = 3000;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--mock") && i + 1 < argc) {
+      mock = argv[++i];
+    } else if (!strcmp(argv[i], "--port") && i + 1 < argc) {
+      path = argv[++i];
+    } else if (!strcmp(argv[i], "--realtime")) {
+      realtime = true;
+    } else if (!strcmp(argv[i], "--poses") && i + 1 < argc) {
+      poses = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--max-baud") && i + 1 < argc) {
+      opts.max_baud = strtoul(argv[++i], NULL, 10);
+    } else {
+      fprintf(stderr, "usage: %s (--mock mock_uhand [--realtime] | --port dev) [--poses n] [--max-baud b]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  pid_t pid = -1;
+  if (mock) {
+    pid = start_mock(mock, realtime, &path);
+    if (pid < 0) {
+      fprintf(stderr, "failed to start %s\n", mock);
+      return 1;
+    }
+    printf("mock device on %s%s\n", path.c_str(), realtime ? " (realtime)" : "");
+  } else if (path.empty()) {
+    fprintf(stderr, "--mock or --port is required\n");
+    return 1;
+  }
+
+  int ret = 0;
+  // 默认 9600 不流水线，与原来的逐条发送对比
+  UhandOptions base = opts;
+  base.negotiate = false;
+  base.window = 1;
+  if (!run(path, base, poses / 10)) {
+    ret = 1;
+  }
+  for (size_t window : { 1, 4, 8 }) {
+    opts.window = window;
+    if (!run(path, opts, poses)) {
+      ret = 1;
+      break;
+    }
+  }
+
+  if (pid > 0) {
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+  }
+  return ret;
+}
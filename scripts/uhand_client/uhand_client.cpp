@@ -0,0 +1,465 @@
+/*
+ * uHand 上位机客户端（Linux C++17）
+ */
+#include "uhand_client.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <termios.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static const struct { uint32_t baud; speed_t speed; } speed_table[] = {
+  { 9600, B9600 }, { 19200, B19200 }, { 38400, B38400 }, { 57600, B57600 },
+  { 115200, B115200 }, { 230400, B230400 }, { 460800, B460800 }, { 500000, B500000 },
+  { 921600, B921600 }, { 1000000, B1000000 }, { 2000000, B2000000 },
+};
+
+static bool host_speed(uint32_t baud, speed_t *speed)
+{
+  for (const auto &s : speed_table) {
+    if (s.baud == baud) {
+      *speed = s.speed;
+      return true;
+    }
+  }
+  return false;
+}
+
+static double elapsed_ms(Clock::time_point from, Clock::time_point to)
+{
+  return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+UhandClient::~UhandClient()
+{
+  close();
+}
+
+/* ---------------- 打开与握手（后台线程启动前，同步执行） ---------------- */
+
+bool UhandClient::set_baud(uint32_t baud)
+{
+  speed_t speed;
+  struct termios tio;
+  if (!host_speed(baud, &speed) || tcgetattr(fd, &tio) != 0) {
+    return false;
+  }
+  cfmakeraw(&tio);
+  tio.c_cflag |= CLOCAL | CREAD;
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 0;
+  cfsetspeed(&tio, speed);
+  tcdrain(fd);
+  if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+    return false;
+  }
+  cur_baud = baud;
+  return true;
+}
+
+bool UhandClient::write_all(const std::string &data)
+{
+  size_t off = 0;
+  while (off < data.size()) {
+    ssize_t n = ::write(fd, data.data() + off, data.size() - off);
+    if (n < 0) {
+      if (errno != EAGAIN) {
+        return false;
+      }
+      struct pollfd pfd = { fd, POLLOUT, 0 };
+      poll(&pfd, 1, 100);
+      continue;
+    }
+    off += n;
+  }
+  tcdrain(fd);
+  return true;
+}
+
+bool UhandClient::wait_line(const std::string &prefix, int timeout_ms, std::string *line)
+{
+  Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeout_ms);
+  while (true) {
+    size_t eol;
+    while ((eol = rx_buf.find('\n')) != std::string::npos) {
+      std::string l = rx_buf.substr(0, eol);
+      rx_buf.erase(0, eol + 1);
+      if (!l.empty() && l.back() == '\r') {
+        l.pop_back();
+      }
+      if (l.compare(0, prefix.size(), prefix) == 0) {
+        if (line) {
+          *line = l;
+        }
+        return true;
+      }
+    }
+    int remain = (int)elapsed_ms(Clock::now(), deadline);
+    if (remain <= 0) {
+      return false;
+    }
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    if (poll(&pfd, 1, remain) > 0) {
+      char buf[256];
+      ssize_t n = ::read(fd, buf, sizeof(buf));
+      if (n > 0) {
+        rx_buf.append(buf, n);
+      }
+    }
+  }
+}
+
+bool UhandClient::handshake(void)
+{
+  // 板子上电默认 9600；上一个程序协商过而板子没有复位时，则在其他波特率上
+  std::vector<uint32_t> bauds = { 9600 };
+  for (int i = sizeof(speed_table) / sizeof(speed_table[0]) - 1; i >= 0; --i) {
+    if (speed_table[i].baud != 9600) {
+      bauds.push_back(speed_table[i].baud);
+    }
+  }
+  Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(opts.handshake_wait_ms);
+  do {
+    for (uint32_t baud : bauds) {
+      set_baud(baud);
+      tcflush(fd, TCIFLUSH);
+      rx_buf.clear();
+      if (write_all("?$") && wait_line("@ID", 300, &fw_info)) {
+        return true;
+      }
+    }
+  } while (Clock::now() < deadline);
+  return false;
+}
+
+bool UhandClient::switch_baud(uint32_t baud)
+{
+  uint32_t old = cur_baud;
+  std::string cmd = "~" + std::to_string(baud) + "$";
+  rx_buf.clear();
+  if (!write_all(cmd) || !wait_line("~OK " + std::to_string(baud), 300, NULL)) {
+    return false;
+  }
+  set_baud(baud);
+  usleep(20000);  // 等设备发送完 OK 并切换
+  tcflush(fd, TCIFLUSH);
+  rx_buf.clear();
+  if (write_all(cmd) && wait_line("~ACK " + std::to_string(baud), 300, NULL)) {
+    return true;
+  }
+  // 设备等待确认超时(1s)后退回原波特率
+  set_baud(old);
+  usleep(1100000);
+  tcflush(fd, TCIFLUSH);
+  rx_buf.clear();
+  return write_all("?$") && wait_line("@ID", 300, NULL);
+}
+
+bool UhandClient::open(const std::string &path, const UhandOptions &options)
+{
+  close();
+  opts = options;
+  if (opts.window == 0) {
+    opts.window = 1;
+  }
+  fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (fd < 0) {
+    perror(path.c_str());
+    return false;
+  }
+  if (!set_baud(9600) || !handshake()) {
+    fprintf(stderr, "%s: no handshake reply\n", path.c_str());
+    ::close(fd);
+    fd = -1;
+    return false;
+  }
+  if (opts.negotiate) {
+    // 解析 bauds=9600,57600,... 从高到低尝试
+    std::vector<uint32_t> bauds;
+    size_t pos = fw_info.find("bauds=");
+    if (pos != std::string::npos) {
+      std::stringstream ss(fw_info.substr(pos + 6));
+      std::string item;
+      while (std::getline(ss, item, ',')) {
+        bauds.insert(bauds.begin(), strtoul(item.c_str(), NULL, 10));
+      }
+    }
+    speed_t speed;
+    for (uint32_t baud : bauds) {
+      if (baud > opts.max_baud || !host_speed(baud, &speed)) {
+        continue;
+      }
+      if (baud == cur_baud || switch_baud(baud)) {
+        break;
+      }
+    }
+  }
+  rx_buf.clear();
+  counters = {};
+  rtt_sum_ms = 0;
+  stopping = false;
+  wake_fd = eventfd(0, EFD_NONBLOCK);
+  worker = std::thread(&UhandClient::run, this);
+  return true;
+}
+
+void UhandClient::close(void)
+{
+  if (fd < 0) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+  uint64_t one = 1;
+  (void)::write(wake_fd, &one, sizeof(one));
+  if (worker.joinable()) {
+    worker.join();
+  }
+  ::close(wake_fd);
+  ::close(fd);
+  wake_fd = fd = -1;
+}
+
+/* ---------------- 提交命令 ---------------- */
+
+std::future<bool> UhandClient::submit(const std::string *cmds, int n)
+{
+  auto batch = std::make_shared<Batch>();
+  batch->remaining = n;
+  std::future<bool> result = batch->promise.get_future();
+  if (fd < 0) {
+    batch->promise.set_value(false);
+    return result;
+  }
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    for (int i = 0; i < n; ++i) {
+      pending.push_back(Frame{ cmds[i], batch, Clock::time_point() });
+    }
+  }
+  uint64_t one = 1;
+  (void)::write(wake_fd, &one, sizeof(one));
+  return result;
+}
+
+std::future<bool> UhandClient::send(const std::string &cmd)
+{
+  return submit(&cmd, 1);
+}
+
+std::future<bool> UhandClient::setJoint(int joint, uint8_t angle)
+{
+  std::string cmd = std::string(1, 'A' + joint) + std::to_string(angle > 180 ? 180 : angle);
+  return submit(&cmd, 1);
+}
+
+std::future<bool> UhandClient::setPose(const std::array<uint8_t, 6> &angles)
+{
+  std::string cmds[6];
+  for (int i = 0; i < 6; ++i) {
+    cmds[i] = std::string(1, 'A' + i) + std::to_string(angles[i] > 180 ? 180 : angles[i]);
+  }
+  return submit(cmds, 6);
+}
+
+std::future<bool> UhandClient::playGroup(GroupMode mode)
+{
+  return send("P" + std::to_string((int)mode));
+}
+
+std::future<UhandTelemetry> UhandClient::telemetry(void)
+{
+  std::promise<UhandTelemetry> promise;
+  std::future<UhandTelemetry> result = promise.get_future();
+  if (fd < 0) {
+    promise.set_value(UhandTelemetry{});
+    return result;
+  }
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    telemetry_waiters.push_back(std::move(promise));
+  }
+  send("T");
+  return result;
+}
+
+void UhandClient::onTelemetry(std::function<void(const UhandTelemetry &)> cb)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  telemetry_cb = cb;
+}
+
+void UhandClient::flush(void)
+{
+  std::unique_lock<std::mutex> guard(lock);
+  idle_cv.wait(guard, [this] { return fd < 0 || (pending.empty() && inflight.empty()); });
+}
+
+UhandStats UhandClient::stats(void)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  UhandStats s = counters;
+  s.rtt_avg_ms = counters.acked ? rtt_sum_ms / counters.acked : 0;
+  return s;
+}
+
+/* ---------------- 后台线程 ---------------- */
+
+void UhandClient::complete(Frame &frame, bool ok)
+{
+  if (!ok) {
+    counters.timeouts++;
+    if (frame.text == "T" && !telemetry_waiters.empty()) {
+      telemetry_waiters.front().set_value(UhandTelemetry{});
+      telemetry_waiters.pop_front();
+    }
+  }
+  frame.batch->ok = frame.batch->ok && ok;
+  if (--frame.batch->remaining == 0) {
+    frame.batch->promise.set_value(frame.batch->ok);
+  }
+}
+
+void UhandClient::fill_tx(void)
+{
+  Clock::time_point now = Clock::now();
+  while (!pending.empty() && inflight.size() < opts.window) {
+    Frame frame = std::move(pending.front());
+    pending.pop_front();
+    frame.sent_at = now;
+    tx_buf += frame.text;
+    tx_buf += '$';
+    inflight.push_back(std::move(frame));
+    counters.sent++;
+  }
+}
+
+void UhandClient::handle_line(const std::string &line)
+{
+  if (line.compare(0, 2, "#T") == 0) {
+    UhandTelemetry t = {};
+    int v[8];
+    if (sscanf(line.c_str() + 2, "%d %d %d %d %d %d %d %d",
+               &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7]) == 8) {
+      t.valid = true;
+      for (int i = 0; i < 6; ++i) {
+        t.angles[i] = v[i];
+      }
+      t.mode = v[6];
+      t.group_step = v[7];
+    }
+    if (!telemetry_waiters.empty()) {
+      telemetry_waiters.front().set_value(t);
+      telemetry_waiters.pop_front();
+    }
+    if (telemetry_cb && t.valid) {
+      telemetry_events.push_back(t);
+    }
+    return;
+  }
+  // 回显按发送顺序到达；前面没有回显的命令视为丢失
+  for (size_t k = 0; k < inflight.size(); ++k) {
+    if (inflight[k].text != line) {
+      continue;
+    }
+    for (size_t i = 0; i < k; ++i) {
+      complete(inflight.front(), false);
+      inflight.pop_front();
+    }
+    Frame &frame = inflight.front();
+    double rtt = elapsed_ms(frame.sent_at, Clock::now());
+    rtt_sum_ms += rtt;
+    counters.rtt_max_ms = rtt > counters.rtt_max_ms ? rtt : counters.rtt_max_ms;
+    counters.acked++;
+    complete(frame, true);
+    inflight.pop_front();
+    return;
+  }
+  // 其他输出（启动信息、内存统计等）忽略
+}
+
+void UhandClient::expire(void)
+{
+  Clock::time_point now = Clock::now();
+  while (!inflight.empty() && elapsed_ms(inflight.front().sent_at, now) > opts.ack_timeout_ms) {
+    complete(inflight.front(), false);
+    inflight.pop_front();
+  }
+}
+
+void UhandClient::run(void)
+{
+  while (true) {
+    bool want_write;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      fill_tx();
+      if (pending.empty() && inflight.empty()) {
+        idle_cv.notify_all();
+        if (stopping) {
+          break;
+        }
+      }
+      want_write = !tx_buf.empty();
+    }
+
+    struct pollfd pfds[2] = {
+      { fd, (short)(POLLIN | (want_write ? POLLOUT : 0)), 0 },
+      { wake_fd, POLLIN, 0 },
+    };
+    poll(pfds, 2, 10);
+    if (pfds[1].revents & POLLIN) {
+      uint64_t count;
+      (void)::read(wake_fd, &count, sizeof(count));
+    }
+
+    if (want_write && (pfds[0].revents & POLLOUT)) {
+      std::lock_guard<std::mutex> guard(lock);
+      ssize_t n = ::write(fd, tx_buf.data(), tx_buf.size());
+      if (n > 0) {
+        tx_buf.erase(0, n);
+      }
+    }
+
+    if (pfds[0].revents & POLLIN) {
+      char buf[512];
+      ssize_t n = ::read(fd, buf, sizeof(buf));
+      if (n > 0) {
+        rx_buf.append(buf, n);
+      }
+    }
+
+    std::vector<UhandTelemetry> events;
+    std::function<void(const UhandTelemetry &)> cb;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      size_t eol;
+      while ((eol = rx_buf.find('\n')) != std::string::npos) {
+        std::string line = rx_buf.substr(0, eol);
+        rx_buf.erase(0, eol + 1);
+        if (!line.empty() && line.back() == '\r') {
+          line.pop_back();
+        }
+        handle_line(line);
+      }
+      expire();
+      events.swap(telemetry_events);
+      cb = telemetry_cb;
+    }
+    // 回调在锁外执行，回调中可以继续提交命令
+    for (const UhandTelemetry &t : events) {
+      cb(t);
+    }
+  }
+}
@@ -0,0 +1,138 @@
+/*
+ * uHand 上位机客户端（Linux C++17）
+ * 非阻塞打开串口，握手并协商波特率（协议见 examples/uhand/uhand_protocol.h），
+ * 后台线程把命令流水线式发出：固件对每条命令回显一行作为应答，
+ * 未应答的命令数不超过 window，避免冲掉板子 64 字节的串口接收缓冲
+ *
+ * 用法:
+ *   UhandClient hand;
+ *   if (!hand.open("/dev/ttyUSB0")) ...
+ *   hand.setPose({ 90, 90, 90, 90, 90, 90 });              // 返回 std::future<bool>
+ *   hand.playGroup(UhandClient::GROUP_ONCE).get();
+ *   UhandTelemetry t = hand.telemetry().get();
+ */
+
+#ifndef __UHAND_CLIENT_H_
+#define __UHAND_CLIENT_H_
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef struct
+{
+  bool valid;
+  uint8_t angles[6];  // 舵机当前角度
+  uint8_t mode;       // 0旋钮 1APP 2动作组 3二次开发
+  uint8_t group_step; // 动作组运行步骤，0为停止
+} UhandTelemetry;
+
+typedef struct
+{
+  uint64_t sent;       // 已发送的命令数
+  uint64_t acked;      // 收到应答的命令数
+  uint64_t timeouts;   // 超时未应答的命令数
+  double rtt_avg_ms;   // 发送到应答的平均时间
+  double rtt_max_ms;
+} UhandStats;
+
+struct UhandOptions
+{
+  size_t window = 8;             // 最多未应答的命令数
+  int ack_timeout_ms = 500;      // 应答超时
+  bool negotiate = true;         // 是否协商更高的波特率
+  uint32_t max_baud = 1000000;
+  int handshake_wait_ms = 10000; // 打开串口后板子复位，等待握手的时间
+};
+
+class UhandClient{
+  public:
+    enum GroupMode { GROUP_STOP = 0, GROUP_ONCE = 1, GROUP_LOOP = 2 };
+
+    UhandClient() = default;
+    ~UhandClient();
+    UhandClient(const UhandClient &) = delete;
+    UhandClient &operator=(const UhandClient &) = delete;
+
+    //打开串口、握手并启动后台线程
+    bool open(const std::string &path, const UhandOptions &options = UhandOptions());
+    //等待已提交的命令发送完毕后关闭
+    void close(void);
+    bool is_open(void) const { return fd >= 0; }
+
+    //发送一条原始命令（不含'$'），应答后 future 为 true，超时为 false
+    std::future<bool> send(const std::string &cmd);
+    //设置一个关节角度
+    std::future<bool> setJoint(int joint, uint8_t angle);
+    //设置六个关节角度，全部应答后 future 为 true
+    std::future<bool> setPose(const std::array<uint8_t, 6> &angles);
+    //运行/停止板载动作组
+    std::future<bool> playGroup(GroupMode mode);
+    //读取遥测，失败时 valid 为 false
+    std::future<UhandTelemetry> telemetry(void);
+    //每收到一条遥测都调用，在后台线程中执行
+    void onTelemetry(std::function<void(const UhandTelemetry &)> cb);
+
+    //等待所有已提交的命令应答或超时
+    void flush(void);
+    uint32_t baud(void) const { return cur_baud; }
+    const std::string &firmware(void) const { return fw_info; }
+    UhandStats stats(void);
+
+  private:
+    struct Batch
+    {
+      std::promise<bool> promise;
+      int remaining;
+      bool ok = true;
+    };
+    struct Frame
+    {
+      std::string text;   // 命令文本，也是期望的回显
+      std::shared_ptr<Batch> batch;
+      std::chrono::steady_clock::time_point sent_at;
+    };
+
+    int fd = -1;
+    int wake_fd = -1;
+    UhandOptions opts;
+    uint32_t cur_baud = 9600;
+    std::string fw_info;
+
+    std::thread worker;
+    std::mutex lock;
+    std::condition_variable idle_cv;
+    bool stopping = false;
+    std::deque<Frame> pending;    // 等待发送
+    std::deque<Frame> inflight;   // 已发送等待应答
+    std::deque<std::promise<UhandTelemetry>> telemetry_waiters;
+    std::function<void(const UhandTelemetry &)> telemetry_cb;
+    std::vector<UhandTelemetry> telemetry_events;  // 待回调的遥测
+    std::string tx_buf;
+    std::string rx_buf;
+    UhandStats counters = {};
+    double rtt_sum_ms = 0;
+
+    bool set_baud(uint32_t baud);
+    bool write_all(const std::string &data);
+    bool wait_line(const std::string &prefix, int timeout_ms, std::string *line);
+    bool handshake(void);
+    bool switch_baud(uint32_t baud);
+
+    std::future<bool> submit(const std::string *cmds, int n);
+    void run(void);
+    void fill_tx(void);
+    void handle_line(const std::string &line);
+    void complete(Frame &frame, bool ok);
+    void expire(void);
+};
+
+#endif //__UHAND_CLIENT_H_
@@ -0,0 +1,170 @@
+/*
+ * uHand 模拟设备
+ * 在伪终端上运行固件的 uhand_protocol.cpp，用于在电脑上测试握手和波特率协商
+ * 主机在伪终端另一端用 termios 设置的波特率与模拟设备当前波特率不一致时，
+ * 收到的字节被丢弃、发出的字节变成乱码，和真实串口的表现一致
+ *
+ * 编译:
+ *   g++ -O2 -I ../../examples/uhand mock_uhand.cpp ../../examples/uhand/uhand_protocol.cpp -o mock_uhand
+ * 运行:
+ *   ./mock_uhand [--fail-above 波特率] [--realtime]
+ *   启动后在标准输出打印伪终端路径（例如 /dev/pts/5），主机程序打开该路径即可
+ *   --fail-above  高于该波特率时链路不可靠（模拟线缆或USB转串口芯片的上限）
+ *   --realtime    按当前波特率模拟发送耗时
+ */
+#define _XOPEN_SOURCE 600
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "uhand_protocol.h"
+
+static int master_fd = -1;
+static uint32_t fail_above = 0;
+static bool realtime = false;
+static HW_UhandProtocol protocol;
+static int angles[6] = { 90, 90, 90, 90, 90, 90 };
+static int mode = 0;       // 与 uhand.ino 的 UhandMode 一致
+static int group_step = 0; // 动作组步骤
+
+static uint32_t millis(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000u + ts.tv_nsec / 1000000u;
+}
+
+static uint32_t speed_to_baud(speed_t speed)
+{
+  static const struct { speed_t speed; uint32_t baud; } table[] = {
+    { B9600, 9600 }, { B19200, 19200 }, { B38400, 38400 }, { B57600, 57600 },
+    { B115200, 115200 }, { B230400, 230400 }, { B460800, 460800 }, { B500000, 500000 },
+    { B921600, 921600 }, { B1000000, 1000000 }, { B2000000, 2000000 },
+  };
+  for (size_t i = 0; i < sizeof(table) / sizeof(table[0]); ++i) {
+    if (table[i].speed == speed) {
+      return table[i].baud;
+    }
+  }
+  return 0;
+}
+
+// 主机端与模拟设备的波特率一致，且链路在该波特率下可靠
+static bool link_ok(void)
+{
+  struct termios tio;
+  if (tcgetattr(master_fd, &tio) != 0) {
+    return false;
+  }
+  uint32_t host = speed_to_baud(cfgetospeed(&tio));
+  if (host != protocol.baud()) {
+    return false;
+  }
+  return fail_above == 0 || host <= fail_above;
+}
+
+static void dev_write(const char *str)
+{
+  size_t n = strlen(str);
+  char out[128];
+  if (n > sizeof(out)) {
+    n = sizeof(out);
+  }
+  memcpy(out, str, n);
+  if (!link_ok()) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] ^= 0x5A;
+    }
+  }
+  if (realtime) {
+    usleep(n * 10 * 1000000ull / protocol.baud());
+  }
+  if (write(master_fd, out, n) < 0) {
+    perror("write");
+  }
+}
+
+static void dev_baud(uint32_t baud)
+{
+  fprintf(stderr, "mock: uart %u\n", baud);
+}
+
+static void dev_command(char cmd, const char *arg)
+{
+  // 和固件一样回显命令
+  char line[64];
+  snprintf(line, sizeof(line), "%c%s\r\n", cmd, arg);
+  dev_write(line);
+  switch (cmd) {
+    case 'A': case 'B': case 'C': case 'D': case 'E': case 'F':
+      angles[cmd - 'A'] = atoi(arg);
+      mode = 1;
+      break;
+    case 'P':
+      group_step = atoi(arg);
+      mode = group_step ? 2 : mode;
+      break;
+    case 'T':
+      snprintf(line, sizeof(line), "#T %d %d %d %d %d %d %d %d\r\n",
+               angles[0], angles[1], angles[2], angles[3], angles[4], angles[5], mode, group_step);
+      dev_write(line);
+      break;
+    default:
+      break;
+  }
+  fprintf(stderr, "mock: cmd %c%s\n", cmd, arg);
+}
+
+int main(int argc, char **argv)
+{
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--fail-above") == 0 && i + 1 < argc) {
+      fail_above = strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--realtime") == 0) {
+      realtime = true;
+    } else {
+      fprintf(stderr, "usage: %s [--fail-above baud] [--realtime]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master_fd < 0 || grantpt(master_fd) != 0 || unlockpt(master_fd) != 0) {
+    perror("posix_openpt");
+    return 1;
+  }
+  // 伪终端两端共用一份 termios，这里设为原始模式和默认波特率，主机端之后自行修改
+  struct termios tio;
+  tcgetattr(master_fd, &tio);
+  cfmakeraw(&tio);
+  cfsetspeed(&tio, B9600);
+  tcsetattr(master_fd, TCSANOW, &tio);
+
+  protocol.begin("ABCDEFGHIJLMPRTYZ", dev_command, dev_write, dev_baud);
+  printf("%s\n", ptsname(master_fd));
+  fflush(stdout);
+
+  struct pollfd pfd = { master_fd, POLLIN, 0 };
+  while (true) {
+    int ret = poll(&pfd, 1, 10);
+    if (ret > 0 && (pfd.revents & POLLIN)) {
+      uint8_t buf[256];
+      ssize_t n = read(master_fd, buf, sizeof(buf));
+      if (n > 0 && link_ok()) {
+        for (ssize_t i = 0; i < n; ++i) {
+          protocol.feed(buf[i], millis());
+        }
+      }
+    }
+    if (ret > 0 && (pfd.revents & POLLHUP)) {
+      // 主机端尚未打开或已关闭
+      usleep(10000);
+    }
+    protocol.update(millis());
+  }
+  return 0;
+}
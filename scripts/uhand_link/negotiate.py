@@ -0,0 +1,267 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+uHand 串口握手与波特率协商工具（Linux）
+协议见 examples/uhand/uhand_protocol.h:
+    "?$"         -> "@ID fw=uhand proto=2 cmds=... bauds=9600,..."
+    "~<baud>$"   -> "~OK <baud>"，双方切换后主机再发一次 "~<baud>$" -> "~ACK <baud>"
+                    设备在 1s 内收不到确认会退回原波特率，主机确认失败后同样退回，再尝试更低的波特率
+
+使用方法:
+    python negotiate.py --port /dev/ttyUSB0                 # 协商到双方支持的最高波特率
+    python negotiate.py --port /dev/ttyUSB0 --max-baud 115200 --bench
+    python negotiate.py --mock                              # 在伪终端上与模拟设备协商
+    python negotiate.py --mock --mock-fail-above 115200     # 模拟高波特率下链路不可靠
+    python negotiate.py --selftest                          # 跑一遍伪终端测试场景
+"""
+
+import argparse
+import os
+import select
+import subprocess
+import sys
+import tempfile
+import termios
+import time
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+FIRMWARE_DIR = os.path.join(SCRIPT_DIR, '..', '..', 'examples', 'uhand')
+
+DEFAULT_BAUD = 9600
+CONFIRM_MS = 1000        # 与 PROTO_CONFIRM_MS 一致
+REPLY_TIMEOUT = 0.3
+SPEEDS = {b: getattr(termios, f'B{b}') for b in
+          (9600, 19200, 38400, 57600, 115200, 230400, 460800, 500000, 921600, 1000000, 2000000)
+          if hasattr(termios, f'B{b}')}
+
+
+class SerialPort:
+    """基于 termios 的最小串口封装，原始模式、非阻塞读。"""
+
+    def __init__(self, path, baud=DEFAULT_BAUD):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        self.buf = b''
+        self.baud = None
+        self.set_baud(baud)
+
+    def set_baud(self, baud):
+        if baud not in SPEEDS:
+            raise ValueError(f"baud {baud} not supported by host termios")
+        attr = termios.tcgetattr(self.fd)
+        attr[0] = 0                                     # iflag
+        attr[1] = 0                                     # oflag
+        attr[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        attr[3] = 0                                     # lflag
+        attr[4] = attr[5] = SPEEDS[baud]
+        attr[6][termios.VMIN] = 0
+        attr[6][termios.VTIME] = 0
+        termios.tcdrain(self.fd)
+        termios.tcsetattr(self.fd, termios.TCSANOW, attr)
+        self.baud = baud
+
+    def write(self, data):
+        os.write(self.fd, data)
+        termios.tcdrain(self.fd)
+
+    def send(self, cmd):
+        self.write(cmd.encode('ascii') + b'$')
+
+    def flush_input(self):
+        termios.tcflush(self.fd, termios.TCIFLUSH)
+        self.buf = b''
+
+    def read_line(self, timeout):
+        """读取一行（去掉行尾），超时返回 None。"""
+        deadline = time.monotonic() + timeout
+        while b'\n' not in self.buf:
+            remain = deadline - time.monotonic()
+            if remain <= 0:
+                return None
+            ready, _, _ = select.select([self.fd], [], [], remain)
+            if ready:
+                self.buf += os.read(self.fd, 256)
+        line, self.buf = self.buf.split(b'\n', 1)
+        return line.rstrip(b'\r').decode('ascii', errors='replace')
+
+    def wait_for(self, prefix, timeout=REPLY_TIMEOUT):
+        """等待以 prefix 开头的行，忽略回显和乱码。"""
+        deadline = time.monotonic() + timeout
+        while True:
+            line = self.read_line(max(0.0, deadline - time.monotonic()))
+            if line is None:
+                return None
+            if line.startswith(prefix):
+                return line
+
+    def close(self):
+        os.close(self.fd)
+
+
+def parse_id(line):
+    """解析 "@ID k=v ..." 为字典。"""
+    info = {}
+    for item in line.split()[1:]:
+        key, _, value = item.partition('=')
+        info[key] = value
+    info['proto'] = int(info.get('proto', 1))
+    info['bauds'] = [int(b) for b in info.get('bauds', str(DEFAULT_BAUD)).split(',') if b]
+    return info
+
+
+def probe(port, bauds):
+    """依次在各波特率下发送 "?$"，返回 (波特率, 固件信息)，都没有回复时返回 (None, None)。"""
+    for baud in bauds:
+        port.set_baud(baud)
+        port.flush_input()
+        port.send('?')
+        line = port.wait_for('@ID')
+        if line:
+            return baud, parse_id(line)
+    return None, None
+
+
+def switch(port, baud):
+    """请求设备切换到 baud 并确认，失败时退回原波特率，返回是否成功。"""
+    old = port.baud
+    port.flush_input()
+    port.send(f'~{baud}')
+    if port.wait_for(f'~OK {baud}') is None:
+        return False
+    port.set_baud(baud)
+    time.sleep(0.02)                    # 等设备发送完 OK 并切换
+    port.flush_input()
+    port.send(f'~{baud}')
+    if port.wait_for(f'~ACK {baud}') is not None:
+        return True
+    # 确认失败：设备超时后会自己退回，主机也退回并确认设备还在
+    port.set_baud(old)
+    time.sleep(CONFIRM_MS / 1000 + 0.1)
+    port.flush_input()
+    port.send('?')
+    if port.wait_for('@ID') is None:
+        raise RuntimeError(f"device lost after failed switch to {baud}")
+    return False
+
+
+def negotiate(port, max_baud, wait=0.0):
+    """握手并协商到双方支持的最高波特率，返回 (波特率, 固件信息)。
+    打开串口会让板子复位，上电后还要等中位任务结束，wait 秒内持续重试握手。"""
+    candidates = [DEFAULT_BAUD] + sorted((b for b in SPEEDS if b != DEFAULT_BAUD), reverse=True)
+    deadline = time.monotonic() + wait
+    baud, info = probe(port, candidates)
+    while info is None and time.monotonic() < deadline:
+        baud, info = probe(port, candidates)
+    if info is None:
+        raise RuntimeError("no handshake reply, is this a protocol 2 firmware?")
+    print(f"handshake at {baud}: fw={info.get('fw')} proto={info['proto']} "
+          f"cmds={info.get('cmds')} bauds={info['bauds']}")
+    for target in sorted(info['bauds'], reverse=True):
+        if target > max_baud or target not in SPEEDS:
+            continue
+        if target == port.baud:
+            break
+        print(f"trying {target} ...", end=' ', flush=True)
+        if switch(port, target):
+            print("ok")
+            break
+        print("failed, fallback")
+    return port.baud, info
+
+
+def bench(port, rounds=20):
+    """测量一次六个关节角度更新（含回显）的往返时间。"""
+    frame = ''.join(f'{c}90$' for c in 'ABCDEF').encode('ascii')
+    port.flush_input()
+    total = 0.0
+    for _ in range(rounds):
+        start = time.monotonic()
+        port.write(frame)
+        for c in 'ABCDEF':
+            if port.wait_for(c, timeout=1.0) is None:
+                raise RuntimeError("missing echo during bench")
+        total += time.monotonic() - start
+    print(f"six-angle update at {port.baud}: {total / rounds * 1000:.1f} ms")
+
+
+def start_mock(fail_above=None, realtime=False):
+    """编译并启动模拟设备，返回 (进程, 伪终端路径)。"""
+    exe = os.path.join(tempfile.gettempdir(), 'uhand_mock_device')
+    sources = [os.path.join(SCRIPT_DIR, 'mock_uhand.cpp'),
+               os.path.join(FIRMWARE_DIR, 'uhand_protocol.cpp')]
+    if not os.path.exists(exe) or any(os.path.getmtime(s) > os.path.getmtime(exe) for s in sources):
+        subprocess.run(['g++', '-O2', '-I', FIRMWARE_DIR, *sources, '-o', exe], check=True)
+    cmd = [exe]
+    if fail_above:
+        cmd += ['--fail-above', str(fail_above)]
+    if realtime:
+        cmd.append('--realtime')
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True)
+    return proc, proc.stdout.readline().strip()
+
+
+def selftest():
+    """伪终端测试：正常协商、高波特率失败后的回退、切换后原有命令仍可用。"""
+    cases = [(None, 1000000), (115200, 115200), (9600, 9600)]
+    failed = 0
+    for fail_above, expect in cases:
+        proc, path = start_mock(fail_above)
+        try:
+            port = SerialPort(path)
+            baud, _ = negotiate(port, max(SPEEDS))
+            port.flush_input()
+            port.send('A45')
+            echo_ok = port.wait_for('A45') is not None
+            port.close()
+        finally:
+            proc.kill()
+        ok = baud == expect and echo_ok
+        failed += not ok
+        print(f"[{'PASS' if ok else 'FAIL'}] fail_above={fail_above}: negotiated {baud}, "
+              f"expected {expect}, echo {'ok' if echo_ok else 'missing'}\n")
+    return failed
+
+
+def main():
+    parser = argparse.ArgumentParser(description='uHand serial handshake and baud negotiation')
+    parser.add_argument('--port', help='serial device, e.g. /dev/ttyUSB0')
+    parser.add_argument('--max-baud', type=int, default=1000000, help='highest baud rate to try')
+    parser.add_argument('--wait', type=float, default=10.0,
+                        help='keep retrying the handshake this many seconds while the board boots')
+    parser.add_argument('--bench', action='store_true', help='time a six-angle update before and after')
+    parser.add_argument('--mock', action='store_true', help='negotiate with the pty mock device')
+    parser.add_argument('--mock-fail-above', type=int, help='mock link is unreliable above this baud')
+    parser.add_argument('--selftest', action='store_true', help='run the pty negotiation scenarios')
+    args = parser.parse_args()
+
+    if args.selftest:
+        sys.exit(1 if selftest() else 0)
+
+    proc = None
+    if args.mock:
+        proc, path = start_mock(args.mock_fail_above, realtime=args.bench)
+        print(f"mock device on {path}")
+    elif args.port:
+        path = args.port
+    else:
+        parser.error('--port or --mock is required')
+
+    try:
+        port = SerialPort(path)
+        if args.bench:
+            probe(port, [DEFAULT_BAUD])
+            bench(port)
+        baud, _ = negotiate(port, args.max_baud, args.wait)
+        print(f"link running at {baud} baud")
+        if args.bench:
+            bench(port)
+        port.close()
+    except RuntimeError as e:
+        print(e, file=sys.stderr)
+        sys.exit(1)
+    finally:
+        if proc:
+            proc.kill()
+
+
+if __name__ == '__main__':
+    main()
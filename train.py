@@ -16,7 +16,8 @@ import matplotlib.pyplot as plt
 import time
 import os
 import glob
-from typing import Tuple, Dict, List
+import re
+from typing import Callable, Tuple, Dict, List, Optional, Union
 import logging
 from tqdm import tqdm
 
@@ -74,6 +75,82 @@ class GestureDataset(Dataset):
         return image_tensor, label.squeeze()
 
 
+class InMemoryLoader:
+    """
+    DataLoader replacement for the fast training mode. The dataset is decoded once into a uint8 array
+    and every step only indexes a shuffled batch out of it, so no per-step image decode, collate or worker IPC.
+    Datasets with a transform keep using DataLoader, the transform would be frozen here.
+    """
+    
+    def __init__(self, dataset: Union[GestureDataset, Tuple[np.ndarray, np.ndarray]], batch_size: int,
+                 shuffle: bool = False, drop_last: bool = False, channels_last: bool = False):
+        """
+        Args:
+            dataset: Dataset to decode (images in [0, 1], as returned by GestureDataset), or already decoded
+                     (images, labels) arrays: uint8 (N, C, H, W) and int64 (N,), e.g. read-only memmaps
+            batch_size: Batch size
+            shuffle: Reshuffle every epoch
+            drop_last: Drop the last partial batch, keeps batch shapes static for torch.compile
+            channels_last: Yield batches in channels_last memory format
+        """
+        if isinstance(dataset, tuple):
+            self.images, self.labels = dataset
+        else:
+            self.images, self.labels = decode_dataset(dataset)
+        self.batch_size = batch_size
+        self.shuffle = shuffle
+        self.drop_last = drop_last
+        self.memory_format = torch.channels_last if channels_last else torch.contiguous_format
+    
+    def __len__(self) -> int:
+        n = len(self.labels)
+        return n // self.batch_size if self.drop_last else (n + self.batch_size - 1) // self.batch_size
+    
+    def __iter__(self):
+        n = len(self.labels)
+        order = torch.randperm(n).numpy() if self.shuffle else np.arange(n)
+        for i in range(0, len(self) * self.batch_size, self.batch_size):
+            # Sorted rows read a memmap front to back, the order inside a batch does not matter
+            idx = np.sort(order[i:i + self.batch_size])
+            images = torch.from_numpy(self.images[idx]).to(memory_format=self.memory_format).float().div_(255.0)
+            yield images, torch.from_numpy(np.asarray(self.labels[idx], dtype=np.int64))
+
+
+def decode_dataset(dataset: GestureDataset) -> Tuple[np.ndarray, np.ndarray]:
+    """
+    Decode a whole dataset once. Returns uint8 images (N, C, H, W) and int64 labels (N,);
+    the images come from 8-bit files, so uint8 storage is lossless and 4x smaller than float32.
+    """
+    images, labels = zip(*(dataset[i] for i in range(len(dataset))))
+    images = torch.stack(images).mul_(255).round_().to(torch.uint8).numpy()
+    return images, torch.stack(labels).numpy()
+
+
+def cpu_supports_bf16() -> bool:
+    """
+    True when the CPU has native bfloat16 arithmetic (AVX512-BF16/AMX on x86, BF16 on Arm).
+    Without it autocast to bfloat16 is emulated and slower than float32.
+    """
+    try:
+        with open('/proc/cpuinfo', 'r') as f:
+            flags = f.read()
+    except OSError:
+        return False
+    return re.search(r'\b(avx512_bf16|amx_bf16|bf16)\b', flags) is not None
+
+
+class _ModelWithLoss(nn.Module):
+    """Forward pass and loss in one module, so torch.compile fuses the loss into the model graph."""
+    
+    def __init__(self, model: nn.Module, criterion: nn.Module):
+        super(_ModelWithLoss, self).__init__()
+        self.model = model
+        self.criterion = criterion
+    
+    def forward(self, x: torch.Tensor, target: torch.Tensor) -> torch.Tensor:
+        return self.criterion(self.model(x), target)
+
+
 class CNNGestureRecognizer(nn.Module):
     """
     CNN model for Chinese number gesture recognition.
@@ -85,13 +162,14 @@ class CNNGestureRecognizer(nn.Module):
     - Fully Connected(200->11) + Softmax
     """
     
-    def __init__(self, num_classes: int = 11, dropout_rate: float = 0.5):
+    def __init__(self, num_classes: int = 11, dropout_rate: float = 0.5, hidden_units: int = 200):
         """
         Initialize the CNN model.
         
         Args:
             num_classes: Number of gesture classes (0-10)
             dropout_rate: Dropout rate for regularization
+            hidden_units: Width of fc1 (200, the original TF checkpoints also use 100)
         """
         super(CNNGestureRecognizer, self).__init__()
         
@@ -103,8 +181,8 @@ class CNNGestureRecognizer(nn.Module):
         self.pool = nn.MaxPool2d(kernel_size=2, stride=2)
         
         # Fully connected layers
-        self.fc1 = nn.Linear(16 * 16 * 64, 200)
-        self.fc2 = nn.Linear(200, num_classes)
+        self.fc1 = nn.Linear(16 * 16 * 64, hidden_units)
+        self.fc2 = nn.Linear(hidden_units, num_classes)
         
         # Dropout for regularization
         self.dropout = nn.Dropout(dropout_rate)
@@ -133,6 +211,10 @@ class CNNGestureRecognizer(nn.Module):
         Returns:
             Output logits of shape (batch_size, num_classes)
         """
+        return self.classify(self.features(x))
+    
+    def features(self, x: torch.Tensor) -> torch.Tensor:
+        """Output of the convolutional backbone, flattened to (batch_size, 16384); cached by finetune.py."""
         # First convolutional block
         x = self.pool(F.relu(self.conv1(x)))  # (batch_size, 32, 32, 32)
         
@@ -140,8 +222,10 @@ class CNNGestureRecognizer(nn.Module):
         x = self.pool(F.relu(self.conv2(x)))  # (batch_size, 64, 16, 16)
         
         # Flatten for fully connected layers
-        x = x.view(-1, 16 * 16 * 64)  # (batch_size, 16384)
-        
+        return x.reshape(-1, 16 * 16 * 64)  # (batch_size, 16384), reshape: channels_last input in fast mode
+    
+    def classify(self, x: torch.Tensor) -> torch.Tensor:
+        """Fully connected head on backbone features, the only part finetune.py retrains."""
         # First fully connected layer with dropout
         x = self.dropout(F.relu(self.fc1(x)))  # (batch_size, 200)
         
@@ -151,16 +235,76 @@ class CNNGestureRecognizer(nn.Module):
         return x
 
 
+class TinyGestureRecognizer(nn.Module):
+    """
+    Small first-stage model for the inference cascade, about 30x fewer MACs than CNNGestureRecognizer.
+    Same input (3, 64, 64) and preprocessing, so both stages share one preprocessed tensor.
+    
+    Architecture:
+    - Conv2D(3->8, 3x3) + ReLU + MaxPool
+    - Conv2D(8->16, 3x3) + ReLU + MaxPool
+    - Fully Connected(16*16*16->11)
+    """
+    
+    def __init__(self, num_classes: int = 11, dropout_rate: float = 0.2):
+        """
+        Initialize the tiny model.
+        
+        Args:
+            num_classes: Number of gesture classes (0-10)
+            dropout_rate: Dropout rate before the classifier
+        """
+        super(TinyGestureRecognizer, self).__init__()
+        self.conv1 = nn.Conv2d(3, 8, kernel_size=3, padding=1)
+        self.conv2 = nn.Conv2d(8, 16, kernel_size=3, padding=1)
+        self.pool = nn.MaxPool2d(kernel_size=2, stride=2)
+        self.fc = nn.Linear(16 * 16 * 16, num_classes)
+        self.dropout = nn.Dropout(dropout_rate)
+    
+    def forward(self, x: torch.Tensor) -> torch.Tensor:
+        x = self.pool(F.relu(self.conv1(x)))  # (batch_size, 8, 32, 32)
+        x = self.pool(F.relu(self.conv2(x)))  # (batch_size, 16, 16, 16)
+        x = x.reshape(x.size(0), -1)
+        return self.fc(self.dropout(x))
+
+
+# Architectures by command line name; checkpoints record the class name in 'model_architecture'
+MODEL_ARCHITECTURES = {
+    'cnn': CNNGestureRecognizer,
+    'tiny': TinyGestureRecognizer,
+}
+
+
+def build_model(architecture: str = 'cnn', **kwargs) -> nn.Module:
+    """
+    Create a model by command line name ('cnn', 'tiny') or class name ('CNNGestureRecognizer', ...).
+    
+    Args:
+        architecture: Architecture name
+        **kwargs: Constructor arguments (num_classes, dropout_rate, ...)
+    """
+    for name, cls in MODEL_ARCHITECTURES.items():
+        if architecture in (name, cls.__name__):
+            return cls(**kwargs)
+    raise ValueError(f"Unknown architecture: {architecture}")
+
+
 class GestureTrainer:
     """Trainer class for the gesture recognition model."""
     
-    def __init__(self, model: nn.Module, device: str = 'auto'):
+    def __init__(self, model: nn.Module, device: str = 'auto', fast: bool = False,
+                 bf16: Optional[bool] = None, compile_model: bool = True, progress: bool = True):
         """
         Initialize the trainer.
         
         Args:
             model: The CNN model to train
             device: Device to use ('auto', 'cpu', 'cuda')
+            fast: Fast mode: channels_last, bfloat16 autocast, torch.compile of model and loss,
+                  fused Adam and no per-step host synchronization (pair it with InMemoryLoader)
+            bf16: Autocast to bfloat16 in fast mode, None enables it when the hardware supports it
+            compile_model: Compile the model and loss in fast mode
+            progress: Show tqdm progress bars (off for sweep workers sharing one terminal)
         """
         if device == 'auto':
             self.device = torch.device('cuda' if torch.cuda.is_available() else 'cpu')
@@ -168,7 +312,63 @@ class GestureTrainer:
             self.device = torch.device(device)
             
         self.model = model.to(self.device)
+        self.fast = fast
+        if bf16 is None:
+            bf16 = torch.cuda.is_bf16_supported() if self.device.type == 'cuda' else cpu_supports_bf16()
+        self.bf16 = fast and bf16
+        self.compile_model = fast and compile_model
+        self._loss_fn = None
+        self.progress = progress
         logger.info(f"Using device: {self.device}")
+        if fast:
+            logger.info(f"Fast mode: bf16 autocast {'on' if self.bf16 else 'off'}, "
+                        f"torch.compile {'on' if self.compile_model else 'off'}")
+    
+    def _make_optimizer(self, learning_rate: float, weight_decay: float) -> optim.Optimizer:
+        """Adam, fused into one kernel per step in fast mode when this PyTorch supports it on the device."""
+        params = list(self.model.parameters())
+        if self.fast:
+            for impl in ({'fused': True}, {'foreach': True}):
+                try:
+                    return optim.Adam(params, lr=learning_rate, weight_decay=weight_decay, **impl)
+                except (RuntimeError, TypeError) as e:
+                    logger.info(f"Adam {impl} not available: {str(e)}")
+        return optim.Adam(params, lr=learning_rate, weight_decay=weight_decay)
+    
+    def _forward_loss(self, data: torch.Tensor, target: torch.Tensor) -> torch.Tensor:
+        """Loss of one batch through the compiled graph, falling back to eager if compilation fails."""
+        try:
+            return self._loss_fn(data, target)
+        except Exception as e:
+            if not self.compile_model:
+                raise
+            logger.warning(f"torch.compile failed, continuing in eager mode: {str(e)}")
+            self.compile_model = False
+            self._loss_fn = self._loss_fn._orig_mod if hasattr(self._loss_fn, '_orig_mod') else self._loss_fn
+            return self._loss_fn(data, target)
+    
+    def train_epoch_fast(self, train_loader, optimizer: optim.Optimizer) -> float:
+        """
+        Train one epoch in fast mode. The loss is accumulated on the device and read once per epoch,
+        so the host never waits for a step to finish.
+        """
+        self.model.train()
+        total_loss = torch.zeros((), device=self.device)
+        steps = 0
+        for data, target in train_loader:
+            data = data.to(self.device, non_blocking=True, memory_format=torch.channels_last)
+            target = target.to(self.device, non_blocking=True)
+            
+            optimizer.zero_grad(set_to_none=True)
+            with torch.autocast(self.device.type, dtype=torch.bfloat16, enabled=self.bf16):
+                loss = self._forward_loss(data, target)
+            loss.backward()
+            optimizer.step()
+            
+            total_loss += loss.detach().float()
+            steps += 1
+        
+        return total_loss.item() / max(1, steps)
     
     def train_epoch(self, train_loader: DataLoader, optimizer: optim.Optimizer, 
                    criterion: nn.Module) -> float:
@@ -177,7 +377,7 @@ class GestureTrainer:
         total_loss = 0.0
         
         # Create progress bar for batches
-        pbar = tqdm(train_loader, desc="Training", leave=False)
+        pbar = tqdm(train_loader, desc="Training", leave=False, disable=not self.progress)
         for batch_idx, (data, target) in enumerate(pbar):
             data, target = data.to(self.device), target.to(self.device)
             
@@ -196,6 +396,8 @@ class GestureTrainer:
     
     def evaluate(self, test_loader: DataLoader, criterion: nn.Module) -> Tuple[float, float]:
         """Evaluate the model on test data."""
+        if self.fast:
+            return self.evaluate_fast(test_loader, criterion)
         self.model.eval()
         total_loss = 0.0
         correct = 0
@@ -203,7 +405,7 @@ class GestureTrainer:
         
         with torch.no_grad():
             # Create progress bar for evaluation
-            pbar = tqdm(test_loader, desc="Evaluating", leave=False)
+            pbar = tqdm(test_loader, desc="Evaluating", leave=False, disable=not self.progress)
             for data, target in pbar:
                 data, target = data.to(self.device), target.to(self.device)
                 output = self.model(data)
@@ -223,9 +425,30 @@ class GestureTrainer:
         
         return avg_loss, accuracy
     
+    def evaluate_fast(self, test_loader, criterion: nn.Module) -> Tuple[float, float]:
+        """Evaluate in fast mode: eager model under autocast, counters stay on the device until the end."""
+        self.model.eval()
+        total_loss = torch.zeros((), device=self.device)
+        correct = torch.zeros((), dtype=torch.long, device=self.device)
+        total = 0
+        batches = 0
+        
+        with torch.inference_mode(), torch.autocast(self.device.type, dtype=torch.bfloat16, enabled=self.bf16):
+            for data, target in test_loader:
+                data = data.to(self.device, non_blocking=True, memory_format=torch.channels_last)
+                target = target.to(self.device, non_blocking=True)
+                output = self.model(data)
+                total_loss += criterion(output, target).float()
+                correct += (output.argmax(dim=1) == target).sum()
+                total += target.size(0)
+                batches += 1
+        
+        return total_loss.item() / max(1, batches), 100 * correct.item() / max(1, total)
+    
     def train(self, train_loader: DataLoader, test_loader: DataLoader,
               num_epochs: int = 100, learning_rate: float = 0.001,
-              weight_decay: float = 1e-4) -> Dict:
+              weight_decay: float = 1e-4,
+              epoch_callback: Optional[Callable[[int, Dict], bool]] = None) -> Dict:
         """
         Train the model.
         
@@ -235,13 +458,19 @@ class GestureTrainer:
             num_epochs: Number of training epochs
             learning_rate: Learning rate for optimizer
             weight_decay: L2 regularization weight
+            epoch_callback: Called as epoch_callback(epoch, history) after every epoch,
+                            returning True stops training (early stopping, sweep pruning)
             
         Returns:
             Dictionary containing training history
         """
         criterion = nn.CrossEntropyLoss()
-        optimizer = optim.Adam(self.model.parameters(), lr=learning_rate, 
-                              weight_decay=weight_decay)
+        if self.fast:
+            self.model.to(memory_format=torch.channels_last)
+            self._loss_fn = _ModelWithLoss(self.model, criterion)
+            if self.compile_model:
+                self._loss_fn = torch.compile(self._loss_fn)
+        optimizer = self._make_optimizer(learning_rate, weight_decay)
         
         history = {
             'train_loss': [],
@@ -253,11 +482,14 @@ class GestureTrainer:
         start_time = time.time()
         
         # Create progress bar for epochs
-        epoch_pbar = tqdm(range(num_epochs), desc="Epochs")
+        epoch_pbar = tqdm(range(num_epochs), desc="Epochs", disable=not self.progress)
         
         for epoch in epoch_pbar:
             # Train for one epoch
-            train_loss = self.train_epoch(train_loader, optimizer, criterion)
+            if self.fast:
+                train_loss = self.train_epoch_fast(train_loader, optimizer)
+            else:
+                train_loss = self.train_epoch(train_loader, optimizer, criterion)
             
             # Evaluate on test set
             test_loss, test_accuracy = self.evaluate(test_loader, criterion)
@@ -280,20 +512,69 @@ class GestureTrainer:
                            f"Train Loss: {train_loss:.4f}, "
                            f"Test Loss: {test_loss:.4f}, "
                            f"Test Accuracy: {test_accuracy:.2f}%")
+            
+            if epoch_callback is not None and epoch_callback(epoch, history):
+                logger.info(f"Stopped after epoch {epoch+1}")
+                break
         
         training_time = time.time() - start_time
         logger.info(f"Training completed in {training_time:.2f} seconds")
+        if self.fast:
+            # Back to the default layout so checkpoints and exports look the same as from the plain loop
+            self.model.to(memory_format=torch.contiguous_format)
         
         return history
     
-    def save_model(self, save_path: str):
-        """Save the trained model."""
+    def save_model(self, save_path: str, export: bool = True):
+        """Save the trained model, and by default the inference artifacts next to it."""
         os.makedirs(os.path.dirname(save_path), exist_ok=True)
         torch.save({
             'model_state_dict': self.model.state_dict(),
             'model_architecture': type(self.model).__name__
         }, save_path)
         logger.info(f"Model saved to {save_path}")
+        if export:
+            self.export_artifacts(save_path)
+    
+    def export_artifacts(self, save_path: str, input_size: Tuple[int, int, int] = (3, 64, 64)):
+        """
+        Export the model for the GesturePredictor backends, next to the checkpoint:
+        <name>.torchscript.pt (torchscript), <name>.onnx (onnxruntime), <name>.uhm (native and mapped torch).
+        A failed export is logged and skipped, the checkpoint is already saved.
+        """
+        stem = os.path.splitext(save_path)[0]
+        was_training = self.model.training
+        self.model.eval()
+        example = torch.zeros(1, *input_size, device=self.device)
+        
+        try:
+            with torch.no_grad():
+                traced = torch.jit.trace(self.model, example)
+            traced.save(stem + '.torchscript.pt')
+            logger.info(f"TorchScript model saved to {stem}.torchscript.pt")
+        except Exception as e:
+            logger.warning(f"TorchScript export failed: {str(e)}")
+        
+        try:
+            torch.onnx.export(self.model, example, stem + '.onnx',
+                              input_names=['input'], output_names=['logits'],
+                              dynamic_axes={'input': {0: 'batch'}, 'logits': {0: 'batch'}},
+                              opset_version=17)
+            logger.info(f"ONNX model saved to {stem}.onnx")
+        except Exception as e:
+            logger.warning(f"ONNX export failed: {str(e)}")
+        
+        try:
+            from flat_model import save_flat_model
+            tensors = {name: tensor.detach().cpu().numpy() for name, tensor in self.model.state_dict().items()}
+            meta = {'source': os.path.basename(save_path)}
+            if hasattr(self.model, 'fc1'):
+                meta['hidden_units'] = self.model.fc1.out_features
+            save_flat_model(stem + '.uhm', tensors, type(self.model).__name__, input_size, meta=meta)
+        except Exception as e:
+            logger.warning(f"Flat model export failed: {str(e)}")
+        
+        self.model.train(was_training)
     
     def load_model(self, load_path: str):
         """Load a trained model."""
@@ -398,15 +679,33 @@ def plot_training_history(history: Dict, save_path: str = None):
 
 def main():
     """Main training function."""
+    import argparse
+    
+    parser = argparse.ArgumentParser(description='Train the gesture recognition model')
+    parser.add_argument('--arch', choices=list(MODEL_ARCHITECTURES), default='cnn',
+                        help="'cnn' for the full model, 'tiny' for the first stage of the inference cascade")
+    parser.add_argument('--data-dir', type=str, default=r'datasets\resized_img_split',
+                        help='Directory containing the class folders')
+    parser.add_argument('--save', type=str,
+                        help='Checkpoint path, default models/<arch>_gesture.pth')
+    parser.add_argument('--fast', action='store_true',
+                        help='Fast CPU training: in-memory batches, channels_last, bf16 autocast, torch.compile, fused Adam')
+    parser.add_argument('--no-compile', action='store_true',
+                        help='Skip torch.compile in fast mode (no C++ compiler, or short runs)')
+    args = parser.parse_args()
+    
     # Configuration
     config = {
-        'data_dir': r'datasets\resized_img_split',
+        'architecture': args.arch,
+        'data_dir': args.data_dir,
         'batch_size': 16,
         'num_epochs': 50,
         'learning_rate': 0.001,
         'weight_decay': 1e-4,
-        'dropout_rate': 0.5,
-        'model_save_path': 'models/cnn_gesture.pth'
+        'dropout_rate': 0.5 if args.arch == 'cnn' else 0.2,
+        'fast': args.fast,
+        'compile_model': not args.no_compile,
+        'model_save_path': args.save or f'models/{args.arch}_gesture.pth'
     }
     
     # Create directories if they don't exist
@@ -419,14 +718,20 @@ def main():
     train_dataset = GestureDataset(train_paths, train_labels)
     test_dataset = GestureDataset(test_paths, test_labels)
     
-    train_loader = DataLoader(train_dataset, batch_size=config['batch_size'], 
-                             shuffle=True, num_workers=0)  # Set num_workers=0 for Windows compatibility
-    test_loader = DataLoader(test_dataset, batch_size=config['batch_size'], 
-                            shuffle=False, num_workers=0)
+    if config['fast']:
+        # Static batch shapes for torch.compile, the dropped remainder changes with every shuffle
+        train_loader = InMemoryLoader(train_dataset, config['batch_size'], shuffle=True, drop_last=True,
+                                      channels_last=True)
+        test_loader = InMemoryLoader(test_dataset, config['batch_size'], channels_last=True)
+    else:
+        train_loader = DataLoader(train_dataset, batch_size=config['batch_size'], 
+                                 shuffle=True, num_workers=0)  # Set num_workers=0 for Windows compatibility
+        test_loader = DataLoader(test_dataset, batch_size=config['batch_size'], 
+                                shuffle=False, num_workers=0)
     
     # Create model and trainer
-    model = CNNGestureRecognizer(num_classes=11, dropout_rate=config['dropout_rate'])
-    trainer = GestureTrainer(model)
+    model = build_model(config['architecture'], num_classes=11, dropout_rate=config['dropout_rate'])
+    trainer = GestureTrainer(model, fast=config['fast'], compile_model=config['compile_model'])
     
     # Print model summary
     logger.info(f"Model architecture:\n{model}")
@@ -446,7 +751,8 @@ def main():
     trainer.save_model(config['model_save_path'])
     
     # Plot training history
-    plot_training_history(history, 'models/training_history.png')
+    plot_training_history(history, 'models/training_history.png' if config['architecture'] == 'cnn'
+                          else f"models/{config['architecture']}_training_history.png")
     
     # Final evaluation
     final_loss, final_accuracy = trainer.evaluate(test_loader, nn.CrossEntropyLoss())